@@ -0,0 +1,85 @@
+#include <overeditor/utility/transform_batch.h>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <vector>
+
+/**
+ * Compares composeMatrices with the scalar kernel and with composing every matrix through glm, the way instances
+ * were written before, on a map-sized set of transforms.
+ */
+#define BENCHMARK_TRANSFORM_COUNT 100000
+#define BENCHMARK_REPETITIONS 50
+
+typedef std::chrono::steady_clock Clock;
+
+using namespace overeditor::utility;
+
+/**
+ * Fastest of the repetitions, in nanoseconds per matrix
+ */
+static double measure(const std::function<void()> &run) {
+    double best = INFINITY;
+    for (int i = 0; i < BENCHMARK_REPETITIONS; ++i) {
+        auto start = Clock::now();
+        run();
+        double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        best = std::min(best, elapsed / BENCHMARK_TRANSFORM_COUNT);
+    }
+    return best;
+}
+
+static float maxDifference(const std::vector<float> &a, const std::vector<float> &b) {
+    float difference = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        difference = std::max(difference, std::abs(a[i] - b[i]));
+    }
+    return difference;
+}
+
+int main() {
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> position(-4096, 4096), unit(-1, 1), scale(0.25F, 4);
+    std::vector<glm::vec3> positions(BENCHMARK_TRANSFORM_COUNT), scales(BENCHMARK_TRANSFORM_COUNT);
+    std::vector<glm::quat> rotations(BENCHMARK_TRANSFORM_COUNT);
+    for (size_t i = 0; i < BENCHMARK_TRANSFORM_COUNT; ++i) {
+        positions[i] = glm::vec3(position(random), position(random), position(random));
+        rotations[i] = glm::normalize(glm::quat(unit(random), unit(random), unit(random), unit(random)));
+        scales[i] = glm::vec3(scale(random), scale(random), scale(random));
+    }
+    std::printf("%d transforms, composeMatrices built with %s\n", BENCHMARK_TRANSFORM_COUNT,
+                getComposeImplementation());
+    for (MatrixLayout layout : {eMatrix4x4, eMatrix4x3}) {
+        std::vector<float> expected(BENCHMARK_TRANSFORM_COUNT * layout), scalar(expected.size()),
+                batched(expected.size());
+        double glmTime = measure([&] {
+            for (size_t i = 0; i < BENCHMARK_TRANSFORM_COUNT; ++i) {
+                glm::mat4 matrix = glm::translate(glm::mat4(1), positions[i]) * glm::mat4_cast(rotations[i]) *
+                                   glm::scale(glm::mat4(1), scales[i]);
+                storeMatrix(matrix, expected.data() + i * layout, layout);
+            }
+        });
+        double scalarTime = measure([&] {
+            composeMatricesScalar(
+                    positions.data(), rotations.data(), scales.data(), BENCHMARK_TRANSFORM_COUNT, scalar.data(), layout
+            );
+        });
+        double batchedTime = measure([&] {
+            composeMatrices(
+                    positions.data(), rotations.data(), scales.data(), BENCHMARK_TRANSFORM_COUNT, batched.data(), layout
+            );
+        });
+        std::printf("%s:\n", layout == eMatrix4x4 ? "4x4" : "4x3");
+        std::printf("    glm:             %7.2f ns/matrix\n", glmTime);
+        std::printf("    scalar kernel:   %7.2f ns/matrix (%.2fx), max difference %g\n",
+                    scalarTime, glmTime / scalarTime, maxDifference(expected, scalar));
+        std::printf("    composeMatrices: %7.2f ns/matrix (%.2fx), max difference %g\n",
+                    batchedTime, glmTime / batchedTime, maxDifference(expected, batched));
+    }
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include <overeditor/graphics/vertex_kd_tree.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+/**
+ * Compares VertexKdTree queries with a linear scan over every vertex, on vertex sets the size of a whole map
+ */
+#define BENCHMARK_QUERY_COUNT 1000
+#define BENCHMARK_NEAREST_K 8
+#define BENCHMARK_MAP_EXTENT 4096.0F
+
+typedef std::chrono::steady_clock Clock;
+
+using namespace overeditor::graphics;
+
+/**
+ * The k nearest vertices within maxDistance, nearest first, the way the editor found them before the kd-tree
+ */
+static void scanNearest(
+        const MeshData &mesh,
+        const glm::vec3 &point,
+        size_t k,
+        float maxDistance,
+        std::vector<VertexHit> &result
+) {
+    result.clear();
+    for (uint32_t i = 0; i < mesh.positions.size(); ++i) {
+        glm::vec3 delta = mesh.positions[i] - point;
+        float distance = glm::dot(delta, delta);
+        if (distance <= maxDistance * maxDistance) {
+            result.push_back(VertexHit{i, distance, mesh.positions[i]});
+        }
+    }
+    auto nearer = [](const VertexHit &a, const VertexHit &b) {
+        return a.distance < b.distance;
+    };
+    size_t kept = std::min(k, result.size());
+    std::partial_sort(result.begin(), result.begin() + (ptrdiff_t) kept, result.end(), nearer);
+    result.resize(kept);
+    for (VertexHit &hit : result) {
+        hit.distance = std::sqrt(hit.distance);
+    }
+}
+
+template<typename F>
+static double measure(const std::vector<glm::vec3> &queries, F &&query) {
+    auto start = Clock::now();
+    for (const glm::vec3 &point : queries) {
+        query(point);
+    }
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / queries.size();
+}
+
+int main() {
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> coordinate(0, BENCHMARK_MAP_EXTENT), height(0, 256);
+    std::vector<glm::vec3> queries(BENCHMARK_QUERY_COUNT);
+    for (glm::vec3 &query : queries) {
+        query = glm::vec3(coordinate(random), height(random), coordinate(random));
+    }
+    std::printf("%d queries, k = %d\n", BENCHMARK_QUERY_COUNT, BENCHMARK_NEAREST_K);
+    for (size_t vertexCount : {10000, 100000, 1000000}) {
+        MeshData mesh;
+        mesh.positions.resize(vertexCount);
+        for (glm::vec3 &position : mesh.positions) {
+            position = glm::vec3(coordinate(random), height(random), coordinate(random));
+        }
+        auto start = Clock::now();
+        VertexKdTree tree(mesh);
+        double buildTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        std::vector<VertexHit> expected, found;
+        size_t mismatches = 0;
+        for (size_t k : {(size_t) 1, (size_t) BENCHMARK_NEAREST_K}) {
+            double scanTime = measure(queries, [&](const glm::vec3 &point) {
+                scanNearest(mesh, point, k, BENCHMARK_MAP_EXTENT, expected);
+            });
+            double treeTime = measure(queries, [&](const glm::vec3 &point) {
+                tree.nearest(point, k, BENCHMARK_MAP_EXTENT, found);
+            });
+            // A tenth of the queries is enough to catch a wrong result and keeps the largest set quick
+            for (size_t q = 0; q < queries.size(); q += 10) {
+                const glm::vec3 &point = queries[q];
+                scanNearest(mesh, point, k, BENCHMARK_MAP_EXTENT, expected);
+                tree.nearest(point, k, BENCHMARK_MAP_EXTENT, found);
+                if (found.size() != expected.size()) {
+                    mismatches++;
+                    continue;
+                }
+                for (size_t i = 0; i < found.size(); ++i) {
+                    // Equally distant vertices may come in either order
+                    if (found[i].distance != expected[i].distance) {
+                        mismatches++;
+                        break;
+                    }
+                }
+            }
+            std::printf("%zu vertices, k = %zu: scan %9.2f us, kd-tree %7.2f us (%.0fx), built in %.1f ms\n",
+                        vertexCount, k, scanTime, treeTime, scanTime / treeTime, buildTime);
+        }
+        if (mismatches > 0) {
+            std::printf("    %zu checked queries differ from the scan\n", mismatches);
+        }
+    }
+    return 0;
+}
@@ -5,7 +5,25 @@
 #include <overeditor/utility/success_status.h>
 #include <overeditor/graphics/swapchain_context.h>
 #include <overeditor/graphics/device_context.h>
+#include <overeditor/graphics/mesh_bvh.h>
+#include <overeditor/graphics/vertex_kd_tree.h>
+#include <overeditor/graphics/pipeline_cache.h>
+#include <overeditor/graphics/resource_registry.h>
+#include <overeditor/graphics/shaders/shader.h>
+#include <overeditor/graphics/textures/texture_streamer.h>
+#include <overeditor/ecs/scheduler.h>
+#include <overeditor/ecs/storage/chunk_storage.h>
 #include <overeditor/ecs/systems/rendering.h>
+#include <overeditor/ecs/systems/spatial_index.h>
+#include <overeditor/ecs/systems/transform_hierarchy.h>
+#include <overeditor/ecs/systems/world_partition.h>
+#include <overeditor/editing/journal.h>
+#include <overeditor/scene/autosave.h>
+#include <overeditor/scene/scene_format.h>
+#include <overeditor/utility/event_bus.h>
+#include <overeditor/utility/memory_tracker.h>
+#include <overeditor/utility/phase_profiler.h>
+#include <overeditor/utility/thread_pool.h>
 #include <entityx/entityx.h>
 #include <GLFW/glfw3.h>
 /**
@@ -21,17 +39,39 @@ namespace overeditor {
 
     class Application : public entityx::EntityX {
     private:
+        // Created first so the startup phases are relative to the start of the application
+        utility::PhaseProfiler startupProfiler;
+        // Outlives the device and every cache that reports to it
+        utility::MemoryTracker memoryTracker;
         // Vulkan members
         vk::Instance instance;
         vk::SurfaceKHR surface;
         // Graphics layer members
         graphics::DeviceContext *deviceContext;
+        graphics::ResourceRegistry *resourceRegistry;
+        graphics::textures::TextureStreamer *textureStreamer;
         // Engine layer members
         bool running;
         utility::StepFunction<float> sceneTick;
         utility::SuccessStatus instanceSuitable;
         GLFWwindow *window;
+        utility::ThreadPool threadPool;
+        utility::EventBus eventBus;
+        ecs::Scheduler scheduler;
+        std::shared_ptr<storage::ChunkStorage> chunkStorage;
+        std::shared_ptr<systems::transforms::TransformHierarchy> transformHierarchy;
+        std::shared_ptr<systems::spatial::SpatialIndex> spatialIndex;
         std::shared_ptr<overeditor::systems::graphics::RenderingSystem> renderingSystem;
+        std::shared_ptr<systems::world::WorldPartition> worldPartition;
+        graphics::PipelineCache pipelineCache;
+        graphics::MeshBvhCache meshBvhCache;
+        graphics::VertexKdTreeCache vertexKdTreeCache;
+        graphics::shaders::ShaderLibrary shaderLibrary;
+        bool firstFrame;
+        // Scene members
+        scene::SceneFormat sceneFormat;
+        scene::Autosave *autosave;
+        editing::Journal journal;
     public:
         Application();
 
@@ -41,7 +81,72 @@ namespace overeditor {
 
         graphics::DeviceContext *getDeviceContext() const;
 
+        /**
+         * Where GPU resources are released to, instead of being destroyed while frames may still use them
+         */
+        graphics::ResourceRegistry *getResourceRegistry() const;
+
+        graphics::textures::TextureStreamer *getTextureStreamer() const;
+
         const std::shared_ptr<systems::graphics::RenderingSystem> &getRenderingSystem() const;
+
+        const std::shared_ptr<storage::ChunkStorage> &getChunkStorage() const;
+
+        const std::shared_ptr<systems::transforms::TransformHierarchy> &getTransformHierarchy() const;
+
+        /**
+         * Streams the cells of the map around its focus, once it was given a source
+         */
+        const std::shared_ptr<systems::world::WorldPartition> &getWorldPartition() const;
+
+        /**
+         * World bounds of every entity with a Transform, for picking and region queries
+         */
+        const std::shared_ptr<systems::spatial::SpatialIndex> &getSpatialIndex() const;
+
+        /**
+         * Triangle hierarchies of the meshes, for placing props exactly on surfaces
+         */
+        graphics::MeshBvhCache &getMeshBvhCache();
+
+        /**
+         * Vertices of the meshes, for vertex snapping
+         */
+        graphics::VertexKdTreeCache &getVertexKdTreeCache();
+
+        utility::ThreadPool &getThreadPool();
+
+        /**
+         * Memory used per category and the budget of every heap, updated every frame
+         */
+        const utility::MemoryTracker &getMemoryTracker() const;
+
+        const graphics::PipelineCache &getPipelineCache() const;
+
+        /**
+         * Every shader of the resource directory, loaded during startup
+         */
+        const graphics::shaders::ShaderLibrary &getShaderLibrary() const;
+
+        /**
+         * Timings of the startup phases, complete once the first frame ran
+         */
+        const utility::PhaseProfiler &getStartupProfiler() const;
+
+        utility::EventBus &getEventBus();
+
+        ecs::Scheduler &getScheduler();
+
+        const scene::SceneFormat &getSceneFormat() const;
+
+        /**
+         * Starts saving the scene to the given path every interval seconds, in the background.
+         */
+        void enableAutosave(const std::filesystem::path &path, float interval);
+
+        scene::Autosave *getAutosave() const;
+
+        editing::Journal &getJournal();
     };
 }
 
@@ -1,11 +1,17 @@
 #ifndef OVEREDITOR_COMMON_H
 #define OVEREDITOR_COMMON_H
 
+#include <entityx/entityx.h>
 #include <glm/glm.hpp>
 #include <glm/gtx/quaternion.hpp>
 #include <vulkan/vulkan.hpp>
 #include <overeditor/graphics/buffers/vertices.h>
 
+/**
+ * Drawable::texture of drawables that sample no streamed texture
+ */
+#define DRAWABLE_NO_TEXTURE UINT32_MAX
+
 struct Transform {
     explicit Transform(
             const glm::vec3 &position = glm::vec3(),
@@ -20,54 +26,78 @@ struct Transform {
     glm::vec3 scale;
 };
 
+/**
+ * Published on the event bus, keyed by entity id, after the Transform of an entity was modified in place
+ */
+struct TransformChangedEvent {
+    explicit TransformChangedEvent(entityx::Entity entity) : entity(entity) {}
+
+    entityx::Entity entity;
+};
+
+/**
+ * Published on the event bus, keyed by entity id, after the Drawable of an entity was modified in place
+ */
+struct DrawableChangedEvent {
+    explicit DrawableChangedEvent(entityx::Entity entity) : entity(entity) {}
+
+    entityx::Entity entity;
+};
+
+/**
+ * What an entity is drawn with. The RenderingSystem sorts the draws by this state and records them itself, binding
+ * a pipeline only when it differs from the previous draw's. Pipelines are referred to by their handle in the resource
+ * registry, a draw whose pipeline was released is skipped.
+ */
 struct Drawable {
-public:
-    vk::CommandBuffer buf;
+    overeditor::graphics::PipelineHandle pipeline;
+    /**
+     * Pipeline of the depth prepass subpass, null if the drawable has no prepass
+     */
+    overeditor::graphics::PipelineHandle depthPipeline;
+    const overeditor::graphics::GeometryBuffer *geometry;
+    uint32_t material;
+    /**
+     * TextureStreamer handle of the texture the fragment stage samples, DRAWABLE_NO_TEXTURE for none.
+     * The RenderingSystem records how finely the visible ones are sampled and binds their resident mips.
+     */
+    uint32_t texture;
+    /**
+     * Drawn after every lower layer, whatever their state. From 0 to 15, higher layers are drawn as layer 15.
+     */
+    uint8_t layer;
 
     static Drawable forGeometry(
-            const overeditor::graphics::DeviceContext &deviceContext,
-            const vk::Pipeline &pipeline,
-            const vk::CommandPool &pool,
-            const vk::RenderPass &renderPass,
-            uint32_t subpass,
-            const overeditor::graphics::GeometryBuffer &buffer
+            const overeditor::graphics::PipelineHandle &pipeline,
+            const overeditor::graphics::GeometryBuffer &buffer,
+            uint32_t material = 0,
+            uint32_t texture = DRAWABLE_NO_TEXTURE
     ) {
-        auto &device = deviceContext.getDevice();
-        vk::CommandBuffer buf;
-        auto info = vk::CommandBufferAllocateInfo(
-                pool,
-                vk::CommandBufferLevel::eSecondary,
-                1
-
-        );
-        device.allocateCommandBuffers(
-                &info,
-                &buf
-        );
-
-        auto inh = vk::CommandBufferInheritanceInfo(
-                renderPass, subpass
-        );
-        buf.begin(
-                vk::CommandBufferBeginInfo(
-                        (vk::CommandBufferUsageFlags) vk::CommandBufferUsageFlagBits::eSimultaneousUse |
-                        vk::CommandBufferUsageFlagBits::eRenderPassContinue,
-                        &inh
-                )
-        );
-        buf.bindPipeline(
-                vk::PipelineBindPoint::eGraphics,
-                pipeline
-        );
-        buf.draw(3, 1, 0, 0);
-        buf.end();
-        return Drawable(
-                buf
-        );
+        return Drawable(pipeline, overeditor::graphics::PipelineHandle(), &buffer, material, texture);
+    }
 
+    /**
+     * Draws the geometry with depthPipeline in the prepass subpass 0 and pipeline in the color subpass 1
+     */
+    static Drawable forGeometryWithPrepass(
+            const overeditor::graphics::PipelineHandle &depthPipeline,
+            const overeditor::graphics::PipelineHandle &pipeline,
+            const overeditor::graphics::GeometryBuffer &buffer,
+            uint32_t material = 0,
+            uint32_t texture = DRAWABLE_NO_TEXTURE
+    ) {
+        return Drawable(pipeline, depthPipeline, &buffer, material, texture);
     }
 
-    explicit Drawable(const vk::CommandBuffer &buf = nullptr) : buf(buf) {
+    explicit Drawable(
+            const overeditor::graphics::PipelineHandle &pipeline = overeditor::graphics::PipelineHandle(),
+            const overeditor::graphics::PipelineHandle &depthPipeline = overeditor::graphics::PipelineHandle(),
+            const overeditor::graphics::GeometryBuffer *geometry = nullptr,
+            uint32_t material = 0,
+            uint32_t texture = DRAWABLE_NO_TEXTURE,
+            uint8_t layer = 0
+    ) : pipeline(pipeline), depthPipeline(depthPipeline), geometry(geometry), material(material), texture(texture),
+        layer(layer) {
 
     }
 };
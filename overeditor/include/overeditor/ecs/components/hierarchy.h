@@ -0,0 +1,17 @@
+#ifndef OVEREDITOR_HIERARCHY_H
+#define OVEREDITOR_HIERARCHY_H
+
+#include <entityx/entityx.h>
+
+/**
+ * Makes the Transform of an entity relative to the one of another entity.
+ * To re-parent an entity remove the component and assign a new one, assigning over it doesn't emit the events the
+ * hierarchy is rebuilt from.
+ */
+struct Parent {
+    explicit Parent(entityx::Entity entity = entityx::Entity()) : entity(entity) {}
+
+    entityx::Entity entity;
+};
+
+#endif
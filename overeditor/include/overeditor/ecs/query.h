@@ -0,0 +1,115 @@
+#ifndef OVEREDITOR_QUERY_H
+#define OVEREDITOR_QUERY_H
+
+#include <cstdint>
+#include <vector>
+#include <entityx/entityx.h>
+
+namespace overeditor::ecs {
+
+    /**
+     * A persistent list of the entities that have all of the given components.
+     *
+     * The list is built once and then maintained from the component added/removed events, so reading it costs nothing
+     * when no entity gained or lost one of the components. Entities are kept densely packed; removing one moves the
+     * last entity into its place, so the order is unspecified.
+     */
+    template<typename... Components>
+    class Query : public entityx::Receiver<Query<Components...>> {
+    private:
+        std::vector<entityx::Entity> matches;
+        // Position in matches plus one, by entity index. Zero when the entity doesn't match
+        std::vector<uint32_t> slots;
+        uint64_t version;
+
+        uint32_t &slot(entityx::Entity::Id id) {
+            uint32_t index = id.index();
+            if (index >= slots.size()) {
+                slots.resize(index + 1, 0);
+            }
+            return slots[index];
+        }
+
+        void insert(entityx::Entity entity) {
+            uint32_t &position = slot(entity.id());
+            if (position != 0) {
+                return;
+            }
+            matches.push_back(entity);
+            position = (uint32_t) matches.size();
+            version++;
+        }
+
+        void erase(entityx::Entity::Id id) {
+            uint32_t &position = slot(id);
+            if (position == 0) {
+                return;
+            }
+            entityx::Entity last = matches.back();
+            matches[position - 1] = last;
+            slot(last.id()) = position;
+            matches.pop_back();
+            position = 0;
+            version++;
+        }
+
+    public:
+        Query(entityx::EntityManager &entities, entityx::EventManager &events) : matches(), slots(), version(0) {
+            (events.template subscribe<entityx::ComponentAddedEvent<Components>>(*this), ...);
+            (events.template subscribe<entityx::ComponentRemovedEvent<Components>>(*this), ...);
+            events.template subscribe<entityx::EntityDestroyedEvent>(*this);
+            for (entityx::Entity entity : entities.template entities_with_components<Components...>()) {
+                insert(entity);
+            }
+        }
+
+        Query(const Query &) = delete;
+
+        Query &operator=(const Query &) = delete;
+
+        template<typename C>
+        void receive(const entityx::ComponentAddedEvent<C> &event) {
+            // The added component is already assigned, check the others
+            if ((event.entity.template has_component<Components>() && ...)) {
+                insert(event.entity);
+            }
+        }
+
+        template<typename C>
+        void receive(const entityx::ComponentRemovedEvent<C> &event) {
+            erase(event.entity.id());
+        }
+
+        void receive(const entityx::EntityDestroyedEvent &event) {
+            erase(event.entity.id());
+        }
+
+        typename std::vector<entityx::Entity>::const_iterator begin() const {
+            return matches.begin();
+        }
+
+        typename std::vector<entityx::Entity>::const_iterator end() const {
+            return matches.end();
+        }
+
+        const std::vector<entityx::Entity> &getEntities() const {
+            return matches;
+        }
+
+        size_t size() const {
+            return matches.size();
+        }
+
+        bool empty() const {
+            return matches.empty();
+        }
+
+        /**
+         * Incremented whenever an entity starts or stops matching. Component values changing don't affect it.
+         */
+        uint64_t getVersion() const {
+            return version;
+        }
+    };
+}
+#endif
@@ -0,0 +1,119 @@
+#ifndef OVEREDITOR_SCHEDULER_H
+#define OVEREDITOR_SCHEDULER_H
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <entityx/entityx.h>
+#include <overeditor/utility/thread_pool.h>
+
+namespace overeditor::ecs {
+
+    /**
+     * The components a system reads and writes during its update.
+     * Exclusive systems run alone: they are required for systems that create or destroy entities, add or remove
+     * components, or emit events, since entityx's managers aren't thread safe.
+     */
+    class SystemAccess {
+    private:
+        entityx::ComponentMask reads;
+        entityx::ComponentMask writes;
+        std::vector<std::string> predecessors;
+        bool exclusive;
+    public:
+        SystemAccess();
+
+        template<typename... Components>
+        SystemAccess &read() {
+            (reads.set(entityx::EntityManager::component_family<Components>()), ...);
+            return *this;
+        }
+
+        template<typename... Components>
+        SystemAccess &write() {
+            (writes.set(entityx::EntityManager::component_family<Components>()), ...);
+            return *this;
+        }
+
+        SystemAccess &setExclusive();
+
+        /**
+         * Runs the system after the one added under the given name, which must have been added before it. For data
+         * that isn't a component, like the world matrices of the TransformHierarchy.
+         */
+        SystemAccess &after(const std::string &name);
+
+        bool isExclusive() const;
+
+        bool runsAfter(const std::string &name) const;
+
+        /**
+         * Whether the two systems can't run at the same time
+         */
+        bool conflicts(const SystemAccess &other) const;
+    };
+
+    struct SystemTiming {
+        std::string name;
+        double milliseconds;
+    };
+
+    /**
+     * Runs entityx systems on a thread pool, concurrently whenever their declared accesses allow it.
+     *
+     * A system depends on every system added before it that it conflicts with or runs after, so conflicting systems
+     * always run in the order they were added, which entityx's update_all doesn't guarantee. Systems may split their
+     * own iteration with ThreadPool::parallelFor on the scheduler's pool.
+     */
+    class Scheduler {
+    private:
+        struct Node {
+            std::string name;
+            std::shared_ptr<entityx::BaseSystem> system;
+            SystemAccess access;
+            std::vector<size_t> dependents;
+            size_t dependencyCount;
+            double milliseconds;
+        };
+
+        entityx::EntityManager *entities;
+        entityx::EventManager *events;
+        utility::ThreadPool *pool;
+        std::vector<Node> nodes;
+        std::unique_ptr<std::atomic<size_t>[]> remaining;
+        bool graphDirty;
+        double frameMilliseconds;
+
+        void buildGraph();
+
+        void run(utility::TaskGroup &group, size_t node, entityx::TimeDelta dt);
+
+    public:
+        Scheduler(entityx::EntityManager &entities, entityx::EventManager &events, utility::ThreadPool &pool);
+
+        /**
+         * Registers a system that was already added to (and configured by) the entityx SystemManager.
+         */
+        void add(
+                const std::string &name,
+                const std::shared_ptr<entityx::BaseSystem> &system,
+                const SystemAccess &access
+        );
+
+        /**
+         * Updates every system once and returns when all of them finished.
+         */
+        void update(entityx::TimeDelta dt);
+
+        std::vector<SystemTiming> getTimings() const;
+
+        /**
+         * Wall time of the last update, from the first system starting to the last one finishing
+         */
+        double getFrameMilliseconds() const;
+
+        utility::ThreadPool &getThreadPool() const;
+    };
+}
+#endif
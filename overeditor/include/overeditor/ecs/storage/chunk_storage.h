@@ -0,0 +1,208 @@
+#ifndef OVEREDITOR_CHUNK_STORAGE_H
+#define OVEREDITOR_CHUNK_STORAGE_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <entityx/entityx.h>
+#include <glm/glm.hpp>
+#include <glm/gtx/quaternion.hpp>
+#include <vulkan/vulkan.hpp>
+#include <overeditor/ecs/components/common.h>
+#include <overeditor/utility/event_bus.h>
+#include <overeditor/utility/memory_tracker.h>
+
+/**
+ * Size in bytes of a single chunk, and the alignment of every array inside it
+ */
+#define STORAGE_CHUNK_SIZE (16 * 1024)
+#define STORAGE_CHUNK_ALIGNMENT 64
+#define STORAGE_ARCHETYPE_COUNT 4
+
+namespace overeditor::storage {
+
+    /**
+     * Hot components that are mirrored into chunks. An archetype is a combination of these bits.
+     */
+    enum StorageComponent : uint8_t {
+        eStorageTransform = 1,
+        eStorageDrawable = 2
+    };
+
+    /**
+     * A fixed-size block holding the hot components of entities sharing the same archetype.
+     * Every field is stored in its own contiguous array (structure of arrays), so systems can scan positions,
+     * rotations or scales linearly. Arrays of components missing from the archetype are null.
+     */
+    class StorageChunk {
+    private:
+        std::unique_ptr<uint8_t[]> memory;
+        uint32_t capacity;
+        uint32_t count;
+        uint64_t version;
+        entityx::Entity::Id *entities;
+        glm::vec3 *positions;
+        glm::quat *rotations;
+        glm::vec3 *scales;
+        Drawable *drawables;
+    public:
+        explicit StorageChunk(uint8_t archetype);
+
+        static uint32_t computeCapacity(uint8_t archetype);
+
+        uint32_t getCapacity() const;
+
+        uint32_t getCount() const;
+
+        bool isFull() const;
+
+        /**
+         * Version of the storage when a row of the chunk was last added, removed or changed value.
+         */
+        uint64_t getVersion() const;
+
+        void setVersion(uint64_t version);
+
+        const entityx::Entity::Id *getEntities() const;
+
+        glm::vec3 *getPositions() const;
+
+        glm::quat *getRotations() const;
+
+        glm::vec3 *getScales() const;
+
+        Drawable *getDrawables() const;
+
+        /**
+         * Appends a row for the entity and returns its index. The fields of the row are left uninitialized.
+         */
+        uint32_t push(entityx::Entity::Id entity);
+
+        /**
+         * Removes a row by moving the last row into it.
+         * Returns the entity whose row moved, or the removed entity itself if it was the last row.
+         */
+        entityx::Entity::Id swapRemove(uint32_t row);
+    };
+
+    class Archetype {
+    private:
+        uint8_t mask;
+        std::vector<std::unique_ptr<StorageChunk>> chunks;
+        // Chunks that have at least one free row
+        std::vector<uint32_t> available;
+    public:
+        explicit Archetype(uint8_t mask = 0);
+
+        uint8_t getMask() const;
+
+        const std::vector<std::unique_ptr<StorageChunk>> &getChunks() const;
+
+        /**
+         * Finds, or creates, a chunk with a free row.
+         */
+        uint32_t acquireChunk();
+
+        /**
+         * Must be called after a row was removed from the chunk.
+         */
+        void releaseRow(uint32_t chunk);
+    };
+
+    /**
+     * Mirrors Transform and Drawable components into archetype chunks so per-frame loops are linear scans instead of
+     * per-entity component lookups.
+     *
+     * Membership follows the entityx component added/removed events. The entityx components remain the authoritative
+     * copy: code that modifies a Transform or a Drawable in place must publish a TransformChangedEvent or a
+     * DrawableChangedEvent on the event bus, and the changed values are copied into the chunks when this system
+     * updates, at the start of the frame.
+     */
+    class ChunkStorage : public entityx::System<ChunkStorage>, public entityx::Receiver<ChunkStorage> {
+    private:
+        struct Location {
+            uint8_t archetype;
+            // StorageComponent bits of the fields changed since the last update
+            uint8_t dirty;
+            uint32_t chunk;
+            uint32_t row;
+        };
+
+        Archetype archetypes[STORAGE_ARCHETYPE_COUNT];
+        std::vector<Location> locations;
+        std::vector<entityx::Entity::Id> dirty;
+        uint64_t version;
+        uint64_t drawableVersion;
+        utility::MemoryTracker *memoryTracker;
+
+        Location &locate(entityx::Entity::Id id);
+
+        void markDirty(entityx::Entity::Id id, StorageComponent component);
+
+        void move(entityx::Entity entity, uint8_t archetype, const Transform *transform, const Drawable *drawable);
+
+    public:
+        /**
+         * Chunks are reported to memoryTracker as ECS memory when it isn't null
+         */
+        explicit ChunkStorage(utility::EventBus &eventBus, utility::MemoryTracker *memoryTracker = nullptr);
+
+        void configure(entityx::EventManager &events) override;
+
+        void update(
+                entityx::EntityManager &entities,
+                entityx::EventManager &events,
+                entityx::TimeDelta dt
+        ) override;
+
+        void receive(const entityx::ComponentAddedEvent<Transform> &event);
+
+        void receive(const entityx::ComponentAddedEvent<Drawable> &event);
+
+        void receive(const entityx::ComponentRemovedEvent<Transform> &event);
+
+        void receive(const entityx::ComponentRemovedEvent<Drawable> &event);
+
+        void receive(const TransformChangedEvent &event);
+
+        void receive(const DrawableChangedEvent &event);
+
+        /**
+         * Calls callback(StorageChunk &) for every non-empty chunk whose archetype contains all the required
+         * components.
+         */
+        template<typename F>
+        void forEachChunk(uint8_t required, F &&callback) const {
+            for (uint8_t mask = 1; mask < STORAGE_ARCHETYPE_COUNT; ++mask) {
+                if ((mask & required) != required) {
+                    continue;
+                }
+                for (auto &chunk : archetypes[mask].getChunks()) {
+                    if (chunk->getCount() > 0) {
+                        callback(*chunk);
+                    }
+                }
+            }
+        }
+
+        /**
+         * Finds the chunk and row holding the entity, returns false if it isn't stored.
+         */
+        bool find(entityx::Entity::Id id, const StorageChunk *&chunk, uint32_t &row) const;
+
+        const Archetype &getArchetype(uint8_t mask) const;
+
+        /**
+         * Incremented whenever a row is added, removed or changes value. The chunks holding the row take the new
+         * version, so comparing the version of a chunk tells whether it changed since it was last looked at.
+         */
+        uint64_t getVersion() const;
+
+        /**
+         * Incremented whenever a row with a Drawable is added or removed, or its Drawable changes value. Unlike
+         * getVersion, moving entities around leaves it alone.
+         */
+        uint64_t getDrawableVersion() const;
+    };
+}
+#endif
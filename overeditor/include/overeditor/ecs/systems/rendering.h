@@ -3,92 +3,1153 @@
 
 #include <entityx/entityx.h>
 #include <overeditor/ecs/components/common.h>
+#include <overeditor/ecs/query.h>
+#include <overeditor/ecs/storage/chunk_storage.h>
+#include <overeditor/ecs/systems/transform_hierarchy.h>
+#include <overeditor/graphics/buffers/instance_buffer.h>
+#include <overeditor/graphics/buffers/uniform_ring.h>
+#include <overeditor/graphics/camera.h>
+#include <overeditor/graphics/compute_pass.h>
+#include <overeditor/graphics/depth_buffer.h>
+#include <overeditor/graphics/draw_keys.h>
+#include <overeditor/graphics/frustum.h>
+#include <overeditor/graphics/occlusion.h>
+#include <overeditor/graphics/render_graph.h>
+#include <overeditor/graphics/render_target.h>
+#include <overeditor/graphics/resource_registry.h>
+#include <overeditor/graphics/textures/texture_table.h>
+#include <overeditor/utility/thread_pool.h>
+#include <overeditor/utility/transform_batch.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+/**
+ * Drawables carry no bounds yet, each one is assumed to fit in a unit cube scaled by its transform
+ */
+#define RENDERING_UNIT_RADIUS 1.7320508F
+
+/**
+ * Timestamps written around every render pass: before it, after its depth prepass and after it
+ */
+#define RENDERING_TIMESTAMPS_PER_PASS 3
+
+/**
+ * Bytes of uniforms a frame can allocate from the ring, and how many a shader sees from an offset
+ */
+#define RENDERING_UNIFORMS_PER_FRAME (64 * 1024)
+#define RENDERING_UNIFORM_BINDING_RANGE 256
 
 namespace overeditor::systems::graphics {
+
+    /**
+     * How the depth buffer is filled, fixed when the RenderingSystem is created since drawables create their
+     * pipelines against its render pass
+     */
+    enum DepthMode : uint8_t {
+        /**
+         * Depth is tested and written while shading, in a single subpass
+         */
+        eDepthSinglePass,
+        /**
+         * A depth only subpass fills the depth buffer first, so the color subpass shades every pixel once.
+         * Drawables are recorded with Drawable::forGeometryWithPrepass.
+         */
+        eDepthPrepass
+    };
+
+    /**
+     * GPU time of the last frame, summed over every viewport. Zero if the graphics queue has no timestamps.
+     */
+    struct PassTimings {
+        double prepassMilliseconds = 0;
+        double colorMilliseconds = 0;
+    };
+
+    /**
+     * Uniforms of a pass, at set 0 binding 0 of the pipeline layout. Matches standart.vert.
+     * Passes without a camera get the identity, so clip space positions are drawn as is.
+     */
+    struct PassUniforms {
+        glm::mat4 viewProjection;
+        glm::vec4 cameraPosition;
+    };
+
+    /**
+     * Push constants of every draw, seen by the vertex and fragment stages. Matches standart.vert, which reads the
+     * model matrix of the draw from the instance buffer at set 1 binding 0, four columns of three floats each, and
+     * standart.frag, which samples the texture table at set 2 binding 0.
+     */
+    struct DrawConstants {
+        /**
+         * Index of the draw's matrix in the instance buffer
+         */
+        uint32_t instance;
+        uint32_t material;
+        /**
+         * Slot of the draw's texture in the texture table
+         */
+        uint32_t texture;
+    };
+
+    /**
+     * Pipeline, material and mesh changes between consecutive draws
+     */
+    struct DrawStateChanges {
+        size_t pipelines = 0;
+        size_t materials = 0;
+        size_t meshes = 0;
+    };
+
+    /**
+     * Draws of the last recorded frame summed over every pass, with the state changes they take in the order they
+     * are gathered in and once sorted by key
+     */
+    struct DrawStatistics {
+        size_t draws = 0;
+        DrawStateChanges unsorted;
+        DrawStateChanges sorted;
+    };
+
+    /**
+     * A view of the scene drawn into its own render target, then copied into a rectangle of the swapchain image
+     */
+    struct Viewport {
+        overeditor::graphics::Camera camera;
+        vk::Rect2D rect;
+        std::unique_ptr<overeditor::graphics::RenderTarget> target;
+    };
+
+    /**
+     * Draws every entity with a Transform and a Drawable.
+     *
+     * Without viewports the scene is drawn straight into the swapchain image. With viewports, the work that doesn't
+     * depend on the view (instance matrices, bounds, the gathered draw states) is done once per frame, and all
+     * views are culled in a single pass that shares the result between views with the same camera. What survives is
+     * tested against the occluders, rasterized on the CPU for every view. Each viewport then draws only the instances
+     * visible to it.
+     *
+     * Every pass sorts its draws by a 64 bit key of layer, pipeline, material, mesh and depth, and records them
+     * straight into the primary buffer, binding a pipeline only when it changes.
+     *
+     * Drawables with a texture sample its resident mips through the texture table, and every viewport tells the
+     * texture streamer how finely the visible ones are sampled, so it streams in the mips they need.
+     *
+     * The passes of a frame are declared to a RenderGraph, which places the barriers and layout transitions between
+     * them and lets the depth buffers of the viewports share memory.
+     */
     class RenderingSystem : public entityx::System<RenderingSystem> {
     private:
+        /**
+         * What a primary buffer was recorded from
+         */
+        struct RecordedVersions {
+            uint64_t drawables;
+            uint64_t visibility;
+            uint64_t buffers;
+            uint64_t pipelines;
+            uint64_t textures;
+
+            bool operator!=(const RecordedVersions &other) const {
+                return drawables != other.drawables || visibility != other.visibility || buffers != other.buffers ||
+                       pipelines != other.pipelines || textures != other.textures;
+            }
+        };
+
         const overeditor::graphics::DeviceContext *context;
-        vk::CommandBuffer primaryBuffer;
+        const overeditor::storage::ChunkStorage *storage;
+        const overeditor::systems::transforms::TransformHierarchy *hierarchy;
+        overeditor::utility::ThreadPool *threadPool;
+        // Told when frames are submitted and finished, so what was released during them is destroyed after
+        overeditor::graphics::ResourceRegistry *resources;
+        overeditor::ecs::Query<Transform, Drawable> drawables;
+        std::unique_ptr<overeditor::graphics::InstanceBuffer> instances;
+        std::unique_ptr<overeditor::graphics::UniformRing> uniforms;
+        std::unique_ptr<overeditor::graphics::textures::TextureTable> textureTable;
+        // Told how finely the visible textures are sampled, null if there is none
+        overeditor::graphics::textures::TextureStreamer *textureStreamer;
+        // Dynamic offset of every pass's uniforms, the same every frame of an image since they are pushed in order
+        std::vector<uint32_t> passUniformOffsets;
+        // The sets of the uniform ring, the instance buffer and the texture table, and the draw constants, shared by
+        // every drawable's pipeline
+        vk::PipelineLayout pipelineLayout;
+        // Storage and hierarchy versions each image's instance region was written at
+        std::vector<std::pair<uint64_t, uint64_t>> instanceVersions;
+        // One primary buffer per swapchain image, re-recorded only when the drawn entities or their visibility change,
+        // when buffers or pipelines come and go in the registry, since the buffers refer to them directly, or when the
+        // texture table is rewritten
+        std::vector<vk::CommandBuffer> primaryBuffers;
+        std::vector<RecordedVersions> recordedVersions;
+        DepthMode depthMode;
+        vk::Format depthFormat;
+        // Its depth buffers are shared by every swapchain image, frames never overlap since update waits for them
+        overeditor::graphics::RenderGraph graph;
+        // State of every drawn instance in draw order, and its key without the depth
+        std::vector<Drawable> drawStates;
+        std::vector<uint64_t> stateKeys;
+        // Dense ids of the pipelines and meshes packed into the keys
+        std::unordered_map<uint64_t, uint32_t> pipelineIds;
+        std::unordered_map<const overeditor::graphics::GeometryBuffer *, uint32_t> meshIds;
+        // The sorted draws of every pass of the frame being recorded
+        std::vector<std::vector<overeditor::graphics::DrawItem>> passDraws;
+        std::vector<overeditor::graphics::DrawItem> sortScratch;
+        DrawStatistics drawStatistics;
+        vk::ClearValue clearValues[2];
+        // RENDERING_TIMESTAMPS_PER_PASS for every pass each image can record, null if timestamps are unsupported
+        vk::QueryPool timestamps;
+        double timestampPeriod;
+        // Passes whose timestamps each image's primary buffer writes
+        std::vector<uint32_t> timedPasses;
+        PassTimings timings;
+        std::vector<Viewport> viewports;
+        // Bounding sphere of every instance in draw order, and the storage and hierarchy versions it was computed at
+        std::vector<glm::vec4> instanceSpheres;
+        std::pair<uint64_t, uint64_t> sphereVersions;
+        // Mask of the viewports every instance is visible in, in draw order
+        std::vector<uint32_t> visibility;
+        std::vector<uint32_t> culled;
+        uint64_t visibilityVersion;
+        overeditor::graphics::CullStatistics cullStatistics;
+        std::vector<overeditor::graphics::Occluder> occluders;
+        overeditor::graphics::OcclusionBuffer occlusionBuffer;
+        overeditor::graphics::OcclusionStatistics occlusionStatistics;
         vk::CommandPool pool;
+        // One per swapchain image when drawing straight into it
         std::vector<vk::Framebuffer> framebuffers;
         vk::Semaphore imageAvailableSemaphore, renderFinishedSemaphore;
-    public:
-        vk::RenderPass renderPass;
+        // Semaphores the next submission waits on besides the image being available
+        std::vector<vk::Semaphore> waitSemaphores;
+        std::vector<vk::PipelineStageFlags> waitStages;
+        // Handoffs the next submission acquires, recorded every frame into acquireBuffer ahead of the primary buffer.
+        // A single buffer is enough since update waits for the frame to finish.
+        std::vector<overeditor::graphics::BufferHandoff> acquires;
+        vk::CommandBuffer acquireBuffer;
 
-        explicit RenderingSystem(
-                const overeditor::graphics::DeviceContext &context
-        ) {
-            RenderingSystem::context = &context;
-            auto scContext = context.getSwapChainContext();
-            vk::AttachmentDescription colorAttachment(
-                    (vk::AttachmentDescriptionFlags) 0, // Flags
-                    scContext->getSwapchainFormat(), // Format
-                    vk::SampleCountFlagBits::e1,
-                    vk::AttachmentLoadOp::eClear,
-                    vk::AttachmentStoreOp::eStore,
-                    vk::AttachmentLoadOp::eDontCare,
-                    vk::AttachmentStoreOp::eDontCare,
-                    vk::ImageLayout::eUndefined,
-                    vk::ImageLayout::ePresentSrcKHR
-            );
+        /**
+         * Creates the render pass drawing into a color attachment and a depth attachment, in one or two subpasses
+         * depending on the depth mode. The color subpass is always the last one.
+         * Attachments stay in their attachment layout, the render graph transitions them around the pass.
+         */
+        vk::RenderPass createRenderPass() const {
+            vk::AttachmentDescription attachments[] = {
+                    vk::AttachmentDescription(
+                            (vk::AttachmentDescriptionFlags) 0, // Flags
+                            context->getSwapChainContext()->getSwapchainFormat(), // Format
+                            vk::SampleCountFlagBits::e1,
+                            vk::AttachmentLoadOp::eClear,
+                            vk::AttachmentStoreOp::eStore,
+                            vk::AttachmentLoadOp::eDontCare,
+                            vk::AttachmentStoreOp::eDontCare,
+                            vk::ImageLayout::eColorAttachmentOptimal,
+                            vk::ImageLayout::eColorAttachmentOptimal
+                    ),
+                    // Only needed within the pass, never stored
+                    vk::AttachmentDescription(
+                            (vk::AttachmentDescriptionFlags) 0,
+                            depthFormat,
+                            vk::SampleCountFlagBits::e1,
+                            vk::AttachmentLoadOp::eClear,
+                            vk::AttachmentStoreOp::eDontCare,
+                            vk::AttachmentLoadOp::eDontCare,
+                            vk::AttachmentStoreOp::eDontCare,
+                            vk::ImageLayout::eDepthStencilAttachmentOptimal,
+                            vk::ImageLayout::eDepthStencilAttachmentOptimal
+                    )
+            };
             vk::AttachmentReference colorAttachmentRef(
                     0,
                     vk::ImageLayout::eColorAttachmentOptimal
             );
-            vk::SubpassDescription subpass(
+            vk::AttachmentReference depthAttachmentRef(
+                    1,
+                    vk::ImageLayout::eDepthStencilAttachmentOptimal
+            );
+            std::vector<vk::SubpassDescription> subpasses;
+            std::vector<vk::SubpassDependency> dependencies;
+            if (depthMode == eDepthPrepass) {
+                subpasses.emplace_back(
+                        (vk::SubpassDescriptionFlags) 0,
+                        vk::PipelineBindPoint::eGraphics,
+                        0, nullptr,
+                        0, nullptr,
+                        nullptr, &depthAttachmentRef
+                );
+                // The color subpass tests against the depth the prepass wrote
+                dependencies.emplace_back(
+                        0, 1,
+                        vk::PipelineStageFlagBits::eLateFragmentTests,
+                        vk::PipelineStageFlagBits::eEarlyFragmentTests,
+                        vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+                        vk::AccessFlagBits::eDepthStencilAttachmentRead |
+                        vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+                        vk::DependencyFlagBits::eByRegion
+                );
+            }
+            subpasses.emplace_back(
                     (vk::SubpassDescriptionFlags) 0,
                     vk::PipelineBindPoint::eGraphics,
                     0, nullptr,
-                    1, &colorAttachmentRef
+                    1, &colorAttachmentRef,
+                    nullptr, &depthAttachmentRef
+            );
+            return context->getDevice().createRenderPass(
+                    vk::RenderPassCreateInfo(
+                            (vk::RenderPassCreateFlags) 0,
+                            2, attachments,
+                            (uint32_t) subpasses.size(), subpasses.data(),
+                            (uint32_t) dependencies.size(), dependencies.data()
+                    )
+            );
+        }
+
+        /**
+         * Declares the passes of a frame to the graph and compiles it, then creates the framebuffers over the depth
+         * buffers it made. Called again whenever a viewport is added.
+         */
+        void buildGraph() {
+            auto &device = context->getDevice();
+            // Nothing recorded against the previous graph may still be running
+            device.waitIdle();
+            graph.dispose();
+            for (const vk::Framebuffer &framebuffer : framebuffers) {
+                device.destroy(framebuffer);
+            }
+            framebuffers.clear();
+            auto scContext = context->getSwapChainContext();
+            auto &imgs = scContext->getSwapchainImages();
+            auto ex = scContext->getSwapchainExtent();
+            std::vector<vk::Image> images;
+            for (const auto &img : imgs) {
+                images.push_back(img.getImage());
+            }
+            uint32_t swapchain = graph.importImage(
+                    "Swapchain", images, scContext->getSwapchainFormat(),
+                    vk::ImageLayout::eUndefined, vk::ImageLayout::ePresentSrcKHR, imageAvailableSemaphore
+            );
+            if (viewports.empty()) {
+                uint32_t depth = graph.createImage("Depth", depthFormat, ex);
+                uint32_t scene = graph.addPass(
+                        "Scene",
+                        [this](const vk::CommandBuffer &primaryBuffer, uint32_t imageIndex) {
+                            recordPass(
+                                    primaryBuffer, framebuffers[imageIndex],
+                                    context->getSwapChainContext()->getSwapchainExtent(),
+                                    passDraws[0], passUniformOffsets[0], getInstanceOffset(imageIndex),
+                                    getFirstQuery(imageIndex)
+                            );
+                        }
+                );
+                graph.write(scene, swapchain, overeditor::graphics::eGraphColorAttachment);
+                graph.write(scene, depth, overeditor::graphics::eGraphDepthAttachment);
+                graph.compile();
+                framebuffers.reserve(imgs.size());
+                for (const auto &img : imgs) {
+                    vk::ImageView attachments[] = {img.getView(), graph.getView(depth)};
+                    framebuffers.emplace_back(
+                            device.createFramebuffer(
+                                    vk::FramebufferCreateInfo(
+                                            (vk::FramebufferCreateFlags) 0,
+                                            renderPass,
+                                            2, attachments,
+                                            ex.width, ex.height, 1
+                                    )
+                            )
+                    );
+                }
+                return;
+            }
+            // Whatever no viewport covers
+            uint32_t clear = graph.addPass(
+                    "Clear",
+                    [this](const vk::CommandBuffer &primaryBuffer, uint32_t imageIndex) {
+                        primaryBuffer.clearColorImage(
+                                context->getSwapChainContext()->getSwapchainImages()[imageIndex].getImage(),
+                                vk::ImageLayout::eTransferDstOptimal, clearValues[0].color,
+                                vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1)
+                        );
+                    }
             );
-            auto dep = vk::SubpassDependency(
-                    VK_SUBPASS_EXTERNAL, 0,
-                    vk::PipelineStageFlagBits::eColorAttachmentOutput,
-                    vk::PipelineStageFlagBits::eColorAttachmentOutput,
-                    (vk::AccessFlags) 0,
-                    vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite
+            graph.write(clear, swapchain, overeditor::graphics::eGraphTransferDestination);
+            std::vector<uint32_t> targets, depths;
+            for (uint32_t v = 0; v < viewports.size(); ++v) {
+                const Viewport &viewport = viewports[v];
+                targets.push_back(graph.importImage(
+                        "Viewport", {viewport.target->getImage()}, scContext->getSwapchainFormat(),
+                        vk::ImageLayout::eUndefined, vk::ImageLayout::eUndefined
+                ));
+                depths.push_back(graph.createImage("Viewport depth", depthFormat, viewport.rect.extent));
+                uint32_t pass = graph.addPass(
+                        "Viewport",
+                        [this, v](const vk::CommandBuffer &primaryBuffer, uint32_t imageIndex) {
+                            recordViewport(primaryBuffer, imageIndex, v);
+                        }
+                );
+                graph.write(pass, targets.back(), overeditor::graphics::eGraphColorAttachment);
+                graph.write(pass, depths.back(), overeditor::graphics::eGraphDepthAttachment);
+            }
+            uint32_t composite = graph.addPass(
+                    "Composite",
+                    [this](const vk::CommandBuffer &primaryBuffer, uint32_t imageIndex) {
+                        recordComposite(primaryBuffer, imageIndex);
+                    }
             );
+            for (uint32_t target : targets) {
+                graph.read(composite, target, overeditor::graphics::eGraphTransferSource);
+            }
+            // Copies only cover the viewports, the cleared background is kept
+            graph.read(composite, swapchain, overeditor::graphics::eGraphTransferDestination);
+            graph.write(composite, swapchain, overeditor::graphics::eGraphTransferDestination);
+            graph.compile();
+            for (uint32_t v = 0; v < viewports.size(); ++v) {
+                viewports[v].target->createFramebuffer(renderPass, graph.getView(depths[v]));
+            }
+        }
+
+    public:
+        vk::RenderPass renderPass;
+
+        RenderingSystem(
+                const overeditor::graphics::DeviceContext &context,
+                const overeditor::storage::ChunkStorage &storage,
+                const overeditor::systems::transforms::TransformHierarchy &hierarchy,
+                overeditor::utility::ThreadPool &threadPool,
+                overeditor::graphics::ResourceRegistry &resources,
+                entityx::EntityManager &entities,
+                entityx::EventManager &events,
+                DepthMode depthMode = eDepthSinglePass
+        ) : drawables(entities, events), textureStreamer(nullptr), depthMode(depthMode), graph(context), timestamps(),
+            timestampPeriod(0), sphereVersions(UINT64_MAX, UINT64_MAX), visibilityVersion(0) {
+            RenderingSystem::context = &context;
+            RenderingSystem::storage = &storage;
+            RenderingSystem::hierarchy = &hierarchy;
+            RenderingSystem::threadPool = &threadPool;
+            RenderingSystem::resources = &resources;
+            auto scContext = context.getSwapChainContext();
+            depthFormat = overeditor::graphics::DepthBuffer::selectFormat(context);
+            clearValues[0] = vk::ClearColorValue((std::array<float, 4>) {
+                    0.0F, 0.0F, 0.0F, 1.0F
+            });
+            clearValues[1] = vk::ClearDepthStencilValue(1.0F, 0);
             auto &device = context.getDevice();
+            uint32_t graphicsFamily = context.getQueueContext()->getFamilyIndices().getGraphics().get();
             pool = device.createCommandPool(
                     vk::CommandPoolCreateInfo(
                             (vk::CommandPoolCreateFlags) vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
-                            context.getQueueContext()->getFamilyIndices().getGraphics().get()
-                    )
-            );
-            renderPass = device.createRenderPass(
-                    vk::RenderPassCreateInfo(
-                            (vk::RenderPassCreateFlags) 0,
-                            1, &colorAttachment,
-                            1, &subpass,
-                            1, &dep
+                            graphicsFamily
                     )
             );
-            primaryBuffer = device.allocateCommandBuffers(
+            renderPass = createRenderPass();
+            auto &imgs = scContext->getSwapchainImages();
+            size_t count = imgs.size();
+            primaryBuffers = device.allocateCommandBuffers(
                     vk::CommandBufferAllocateInfo(
                             pool,
                             vk::CommandBufferLevel::ePrimary,
-                            1
+                            (uint32_t) count
                     )
+            );
+            acquireBuffer = device.allocateCommandBuffers(
+                    vk::CommandBufferAllocateInfo(pool, vk::CommandBufferLevel::ePrimary, 1)
             )[0];
-            auto &imgs = scContext->getSwapchainImages();
-            size_t count = imgs.size();
-            framebuffers.reserve(count);
-            auto ex = scContext->getSwapchainExtent();
-            for (size_t i = 0; i < count; i++) {
-                auto &view = imgs[i].getView();
-                framebuffers.emplace_back(
-                        device.createFramebuffer(
-                                vk::FramebufferCreateInfo(
-                                        (vk::FramebufferCreateFlags) 0,
-                                        renderPass,
-                                        1, &view,
-                                        ex.width, ex.height, 1
-                                )
+            recordedVersions.assign(
+                    count, RecordedVersions{UINT64_MAX, UINT64_MAX, UINT64_MAX, UINT64_MAX, UINT64_MAX}
+            );
+            instances.reset(
+                    new overeditor::graphics::InstanceBuffer(context, (uint32_t) count, overeditor::utility::eMatrix4x3)
+            );
+            instanceVersions.assign(count, std::make_pair(UINT64_MAX, UINT64_MAX));
+            uniforms.reset(new overeditor::graphics::UniformRing(
+                    context, (uint32_t) count, RENDERING_UNIFORMS_PER_FRAME, RENDERING_UNIFORM_BINDING_RANGE
+            ));
+            vk::PushConstantRange pushConstants(
+                    vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment, 0, sizeof(DrawConstants)
+            );
+            textureTable.reset(new overeditor::graphics::textures::TextureTable(context));
+            vk::DescriptorSetLayout setLayouts[] = {
+                    uniforms->getSetLayout(), instances->getSetLayout(), textureTable->getSetLayout()
+            };
+            pipelineLayout = device.createPipelineLayout(
+                    vk::PipelineLayoutCreateInfo(
+                            (vk::PipelineLayoutCreateFlags) 0,
+                            3, setLayouts,
+                            1, &pushConstants
+                    )
+            );
+            imageAvailableSemaphore = device.createSemaphore(vk::SemaphoreCreateInfo());
+            renderFinishedSemaphore = device.createSemaphore(vk::SemaphoreCreateInfo());
+            const auto &candidate = context.getCandidate();
+            if (candidate.getQueueFamilyProperties()[graphicsFamily].timestampValidBits > 0) {
+                timestampPeriod = candidate.getDeviceProperties().limits.timestampPeriod;
+                timestamps = device.createQueryPool(
+                        vk::QueryPoolCreateInfo(
+                                (vk::QueryPoolCreateFlags) 0,
+                                vk::QueryType::eTimestamp,
+                                (uint32_t) count * FRUSTUM_MAX_VIEWS * RENDERING_TIMESTAMPS_PER_PASS
                         )
                 );
             }
-            imageAvailableSemaphore = device.createSemaphore(vk::SemaphoreCreateInfo());
-            renderFinishedSemaphore = device.createSemaphore(vk::SemaphoreCreateInfo());
+            timedPasses.assign(count, 0);
+            buildGraph();
+        }
+
+        /**
+         * Calls patch(instance, worldMatrix) for every drawn entity with a parent.
+         * firstInstances maps every drawn chunk to the instance index of its first row.
+         */
+        template<typename F>
+        void forEachParented(
+                const std::unordered_map<const overeditor::storage::StorageChunk *, uint32_t> &firstInstances,
+                F patch
+        ) const {
+            const auto &order = hierarchy->getOrder();
+            const auto &parents = hierarchy->getParents();
+            const auto &worldMatrices = hierarchy->getWorldMatrices();
+            for (size_t i = 0; i < order.size(); ++i) {
+                const overeditor::storage::StorageChunk *chunk;
+                uint32_t row;
+                if (parents[i] == TRANSFORM_HIERARCHY_NO_PARENT || !storage->find(order[i], chunk, row)) {
+                    continue;
+                }
+                auto found = firstInstances.find(chunk);
+                if (found != firstInstances.end()) {
+                    patch(found->second + row, worldMatrices[i]);
+                }
+            }
+        }
+
+        /**
+         * Writes the model matrix of every drawn entity into the image's instance region, in draw order.
+         * Skipped when neither the transforms nor the hierarchy changed since the region was last written.
+         */
+        void writeInstances(uint32_t imageIndex) {
+            auto versions = std::make_pair(storage->getVersion(), hierarchy->getVersion());
+            if (instanceVersions[imageIndex] == versions) {
+                return;
+            }
+            uint32_t capacity = instances->getCapacity();
+            float *destination = instances->map(imageIndex, (uint32_t) drawables.size());
+            if (instances->getCapacity() != capacity) {
+                // The buffer was reallocated, every region has to be written again, and every primary buffer binding
+                // its descriptor set recorded again
+                std::fill(instanceVersions.begin(), instanceVersions.end(), std::make_pair(UINT64_MAX, UINT64_MAX));
+                std::fill(
+                        recordedVersions.begin(), recordedVersions.end(),
+                        RecordedVersions{UINT64_MAX, UINT64_MAX, UINT64_MAX, UINT64_MAX, UINT64_MAX}
+                );
+            }
+            auto layout = instances->getLayout();
+            std::unordered_map<const overeditor::storage::StorageChunk *, uint32_t> firstInstances;
+            uint32_t first = 0;
+            storage->forEachChunk(
+                    overeditor::storage::eStorageTransform | overeditor::storage::eStorageDrawable,
+                    [&](const overeditor::storage::StorageChunk &chunk) {
+                        firstInstances[&chunk] = first;
+                        overeditor::utility::composeMatrices(
+                                chunk.getPositions(), chunk.getRotations(), chunk.getScales(), chunk.getCount(),
+                                destination + (size_t) first * layout, layout
+                        );
+                        first += chunk.getCount();
+                    }
+            );
+            // Entities with a parent are drawn with their world matrix instead of their local transform
+            forEachParented(firstInstances, [&](uint32_t instance, const glm::mat4 &world) {
+                overeditor::utility::storeMatrix(world, destination + (size_t) instance * layout, layout);
+            });
+            instanceVersions[imageIndex] = versions;
+        }
+
+        /**
+         * Pushes the uniforms of every pass of the frame into the image's region of the ring, in pass order
+         */
+        void writeUniforms(uint32_t imageIndex) {
+            uniforms->begin(imageIndex);
+            passUniformOffsets.clear();
+            PassUniforms pass;
+            if (viewports.empty()) {
+                pass.viewProjection = glm::mat4(1.0F);
+                pass.cameraPosition = glm::vec4(0.0F, 0.0F, 0.0F, 1.0F);
+                passUniformOffsets.push_back(uniforms->push(pass));
+                return;
+            }
+            for (const Viewport &viewport : viewports) {
+                float aspect = (float) viewport.rect.extent.width / (float) viewport.rect.extent.height;
+                pass.viewProjection = viewport.camera.getViewProjection(aspect);
+                pass.cameraPosition = glm::vec4(viewport.camera.position, 1.0F);
+                passUniformOffsets.push_back(uniforms->push(pass));
+            }
+        }
+
+        /**
+         * Recomputes the world space bounding sphere of every instance, in the same order as the instance matrices.
+         * Skipped when neither the transforms nor the hierarchy changed.
+         */
+        void updateBounds() {
+            auto versions = std::make_pair(storage->getVersion(), hierarchy->getVersion());
+            if (sphereVersions == versions) {
+                return;
+            }
+            instanceSpheres.resize(drawables.size());
+            std::unordered_map<const overeditor::storage::StorageChunk *, uint32_t> firstInstances;
+            uint32_t first = 0;
+            storage->forEachChunk(
+                    overeditor::storage::eStorageTransform | overeditor::storage::eStorageDrawable,
+                    [&](const overeditor::storage::StorageChunk &chunk) {
+                        firstInstances[&chunk] = first;
+                        const glm::vec3 *positions = chunk.getPositions();
+                        const glm::vec3 *scales = chunk.getScales();
+                        for (uint32_t row = 0; row < chunk.getCount(); ++row) {
+                            const glm::vec3 &scale = scales[row];
+                            float largest = std::max(
+                                    std::fabs(scale.x), std::max(std::fabs(scale.y), std::fabs(scale.z))
+                            );
+                            instanceSpheres[first + row] = glm::vec4(positions[row], largest * RENDERING_UNIT_RADIUS);
+                        }
+                        first += chunk.getCount();
+                    }
+            );
+            forEachParented(firstInstances, [&](uint32_t instance, const glm::mat4 &world) {
+                float largest = std::sqrt(std::max(
+                        glm::dot(glm::vec3(world[0]), glm::vec3(world[0])),
+                        std::max(
+                                glm::dot(glm::vec3(world[1]), glm::vec3(world[1])),
+                                glm::dot(glm::vec3(world[2]), glm::vec3(world[2]))
+                        )
+                ));
+                instanceSpheres[instance] = glm::vec4(glm::vec3(world[3]), largest * RENDERING_UNIT_RADIUS);
+            });
+            sphereVersions = versions;
+        }
+
+        /**
+         * Clears the bits of the instances hidden behind the occluders, one view at a time.
+         * Views with the same matrix reuse the result of the first one.
+         */
+        void cullOccluded(const std::vector<glm::mat4> &viewProjections) {
+            for (uint32_t v = 0; v < viewProjections.size(); ++v) {
+                uint32_t same = v;
+                for (uint32_t u = 0; u < v; ++u) {
+                    if (std::memcmp(&viewProjections[u], &viewProjections[v], sizeof(glm::mat4)) == 0) {
+                        same = u;
+                        break;
+                    }
+                }
+                if (same != v) {
+                    for (uint32_t &mask : culled) {
+                        if (!(mask & (1U << same))) {
+                            mask &= ~(1U << v);
+                        }
+                    }
+                    continue;
+                }
+                occlusionStatistics += overeditor::graphics::cullOccluded(
+                        occlusionBuffer, occluders, viewProjections[v],
+                        instanceSpheres.data(), instanceSpheres.size(), culled.data(), 1U << v
+                );
+            }
+        }
+
+        /**
+         * Culls every instance against every viewport, bumping visibilityVersion if the result changed
+         */
+        void cull() {
+            std::vector<glm::mat4> viewProjections;
+            viewProjections.reserve(viewports.size());
+            for (const Viewport &viewport : viewports) {
+                float aspect = (float) viewport.rect.extent.width / (float) viewport.rect.extent.height;
+                viewProjections.push_back(viewport.camera.getViewProjection(aspect));
+            }
+            culled.resize(instanceSpheres.size());
+            cullStatistics = overeditor::graphics::cullSpheres(
+                    instanceSpheres.data(), instanceSpheres.size(), viewProjections, culled.data()
+            );
+            occlusionStatistics = overeditor::graphics::OcclusionStatistics();
+            if (!occluders.empty()) {
+                cullOccluded(viewProjections);
+            }
+            if (culled != visibility) {
+                visibility.swap(culled);
+                visibilityVersion++;
+            }
+        }
+
+        /**
+         * Tells the texture streamer how many texels of mip 0 every visible instance's texture spreads over a screen
+         * pixel, in every viewport it is visible in. The texture is assumed to span the instance's bounding sphere
+         * once. Must be called once the draw states were gathered for the current drawables.
+         */
+        void recordTexelDensities() const {
+            if (textureStreamer == nullptr || drawStates.size() != instanceSpheres.size()) {
+                return;
+            }
+            size_t textureCount = textureStreamer->getTextureCount();
+            for (uint32_t v = 0; v < viewports.size(); ++v) {
+                const overeditor::graphics::Camera &camera = viewports[v].camera;
+                bool perspective = camera.projection == overeditor::graphics::ePerspective;
+                glm::vec3 forward = camera.getForward();
+                // Pixels a world unit covers, one unit away from perspective cameras
+                float height = (float) viewports[v].rect.extent.height;
+                float pixelsPerUnit = perspective ? height / (2 * std::tan(camera.fieldOfView * 0.5F))
+                                                  : height / (2 * camera.orthographicSize);
+                for (uint32_t i = 0; i < drawStates.size(); ++i) {
+                    uint32_t texture = drawStates[i].texture;
+                    if (texture >= textureCount || !(visibility[i] & (1U << v))) {
+                        continue;
+                    }
+                    const glm::vec4 &sphere = instanceSpheres[i];
+                    float pixels = 2 * sphere.w * pixelsPerUnit;
+                    if (perspective) {
+                        float distance = glm::dot(glm::vec3(sphere) - camera.position, forward);
+                        pixels /= std::max(distance, camera.nearPlane);
+                    }
+                    const auto &description = textureStreamer->getDescription(texture);
+                    float texels = (float) std::max(description.getWidth(), description.getHeight());
+                    textureStreamer->recordTexelDensity(texture, texels / std::max(pixels, 1.0F));
+                }
+            }
+        }
+
+        template<typename K>
+        static uint32_t getId(std::unordered_map<K, uint32_t> &ids, const K &key) {
+            return ids.emplace(key, (uint32_t) ids.size()).first->second;
+        }
+
+        /**
+         * Copies the state of every drawn instance out of the chunks, in draw order, and packs its key
+         */
+        void gatherDraws() {
+            drawStates.clear();
+            storage->forEachChunk(
+                    overeditor::storage::eStorageTransform | overeditor::storage::eStorageDrawable,
+                    [&](const overeditor::storage::StorageChunk &chunk) {
+                        const Drawable *states = chunk.getDrawables();
+                        drawStates.insert(drawStates.end(), states, states + chunk.getCount());
+                    }
+            );
+            stateKeys.resize(drawStates.size());
+            for (size_t i = 0; i < drawStates.size(); ++i) {
+                const Drawable &drawable = drawStates[i];
+                stateKeys[i] = overeditor::graphics::makeDrawKey(
+                        drawable.layer,
+                        getId(pipelineIds, (uint64_t) drawable.pipeline.generation << 32 | drawable.pipeline.index),
+                        drawable.material,
+                        getId(meshIds, drawable.geometry),
+                        0
+                );
+            }
+        }
+
+        void countChanges(const std::vector<overeditor::graphics::DrawItem> &draws, DrawStateChanges &changes) const {
+            const Drawable *previous = nullptr;
+            for (const overeditor::graphics::DrawItem &draw : draws) {
+                const Drawable &drawable = drawStates[draw.instance];
+                if (previous == nullptr || drawable.pipeline != previous->pipeline) {
+                    changes.pipelines++;
+                }
+                if (previous == nullptr || drawable.material != previous->material) {
+                    changes.materials++;
+                }
+                if (previous == nullptr || drawable.geometry != previous->geometry) {
+                    changes.meshes++;
+                }
+                previous = &drawable;
+            }
+        }
+
+        /**
+         * Sorts the draws of a pass, the instances visible to the viewport or all of them without one.
+         * Depth is the distance along the viewport camera's forward as of this call, zero without a viewport.
+         */
+        void sortPass(uint32_t pass, const Viewport *viewport) {
+            std::vector<overeditor::graphics::DrawItem> &draws = passDraws[pass];
+            draws.clear();
+            glm::vec3 forward = viewport != nullptr ? viewport->camera.getForward() : glm::vec3();
+            for (uint32_t i = 0; i < drawStates.size(); ++i) {
+                if (drawStates[i].pipeline.isNull()) {
+                    continue;
+                }
+                uint32_t depth = 0;
+                if (viewport != nullptr) {
+                    if (!(visibility[i] & (1U << pass))) {
+                        continue;
+                    }
+                    const overeditor::graphics::Camera &camera = viewport->camera;
+                    float distance = glm::dot(glm::vec3(instanceSpheres[i]) - camera.position, forward);
+                    depth = overeditor::graphics::quantizeDepth(distance, camera.nearPlane, camera.farPlane);
+                }
+                draws.push_back(overeditor::graphics::DrawItem{stateKeys[i] | depth, i});
+            }
+            drawStatistics.draws += draws.size();
+            countChanges(draws, drawStatistics.unsorted);
+            overeditor::graphics::sortDraws(threadPool, draws, sortScratch);
+            countChanges(draws, drawStatistics.sorted);
+        }
+
+        /**
+         * Records the draws with the pipeline of the subpass, binding it only when it differs from the bound one.
+         * The vertices of the geometry are bound the same way, and drawn whole. Draws without a live pipeline for the
+         * subpass, or without live vertices, are skipped.
+         */
+        void recordDraws(
+                const vk::CommandBuffer &primaryBuffer,
+                const std::vector<overeditor::graphics::DrawItem> &draws,
+                bool prepass
+        ) const {
+            overeditor::graphics::PipelineHandle bound;
+            bool boundAlive = false;
+            const overeditor::graphics::GeometryBuffer *boundGeometry = nullptr;
+            bool verticesAlive = false;
+            for (const overeditor::graphics::DrawItem &draw : draws) {
+                const Drawable &drawable = drawStates[draw.instance];
+                const overeditor::graphics::PipelineHandle &pipeline = prepass ? drawable.depthPipeline
+                                                                               : drawable.pipeline;
+                if (pipeline.isNull()) {
+                    continue;
+                }
+                if (pipeline != bound) {
+                    overeditor::graphics::PipelineResource resolved;
+                    boundAlive = resources->get(pipeline, resolved);
+                    if (boundAlive) {
+                        primaryBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, resolved.pipeline);
+                    }
+                    bound = pipeline;
+                }
+                if (!boundAlive) {
+                    continue;
+                }
+                if (drawable.geometry == nullptr) {
+                    continue;
+                }
+                if (drawable.geometry != boundGeometry) {
+                    overeditor::graphics::BufferResource vertices;
+                    verticesAlive = resources->get(drawable.geometry->getBuffer(), vertices);
+                    if (verticesAlive) {
+                        vk::DeviceSize offset = 0;
+                        primaryBuffer.bindVertexBuffers(0, 1, &vertices.buffer, &offset);
+                    }
+                    boundGeometry = drawable.geometry;
+                }
+                if (!verticesAlive) {
+                    continue;
+                }
+                DrawConstants constants{
+                        draw.instance, drawable.material,
+                        overeditor::graphics::textures::TextureTable::getSlot(drawable.texture)
+                };
+                primaryBuffer.pushConstants(
+                        pipelineLayout, vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment,
+                        0, sizeof(DrawConstants), &constants
+                );
+                primaryBuffer.draw(drawable.geometry->getVertexCount(), 1, 0, 0);
+            }
+        }
+
+        /**
+         * Draws in one pass of renderPass, through the depth pipelines first when there is a prepass, with the pass
+         * uniforms at uniformOffset in the ring and the matrices at instanceOffset in the instance buffer, and writes
+         * the pass's timestamps from firstQuery on.
+         */
+        void recordPass(
+                const vk::CommandBuffer &primaryBuffer,
+                const vk::Framebuffer &framebuffer,
+                const vk::Extent2D &extent,
+                const std::vector<overeditor::graphics::DrawItem> &draws,
+                uint32_t uniformOffset,
+                uint32_t instanceOffset,
+                uint32_t firstQuery
+        ) const {
+            if (timestamps) {
+                primaryBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, timestamps, firstQuery);
+            }
+            primaryBuffer.beginRenderPass(
+                    vk::RenderPassBeginInfo(
+                            renderPass,
+                            framebuffer,
+                            vk::Rect2D(vk::Offset2D(), extent),
+                            2,
+                            clearValues
+                    ),
+                    vk::SubpassContents::eInline
+            );
+            // Dynamic in every pipeline, and kept across the subpasses
+            primaryBuffer.setViewport(0, vk::Viewport(0, 0, (float) extent.width, (float) extent.height, 0, 1));
+            primaryBuffer.setLineWidth(1.0F);
+            vk::DescriptorSet sets[] = {
+                    uniforms->getDescriptorSet(), instances->getDescriptorSet(), textureTable->getDescriptorSet()
+            };
+            // The texture table has no dynamic offset
+            uint32_t dynamicOffsets[] = {uniformOffset, instanceOffset};
+            primaryBuffer.bindDescriptorSets(
+                    vk::PipelineBindPoint::eGraphics, pipelineLayout, 0, 3, sets, 2, dynamicOffsets
+            );
+            if (depthMode == eDepthPrepass) {
+                recordDraws(primaryBuffer, draws, true);
+                if (timestamps) {
+                    primaryBuffer.writeTimestamp(
+                            vk::PipelineStageFlagBits::eBottomOfPipe, timestamps, firstQuery + 1
+                    );
+                }
+                primaryBuffer.nextSubpass(vk::SubpassContents::eInline);
+            } else if (timestamps) {
+                // No prepass, it took no time
+                primaryBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, timestamps, firstQuery + 1);
+            }
+            recordDraws(primaryBuffer, draws, false);
+            primaryBuffer.endRenderPass();
+            if (timestamps) {
+                primaryBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, timestamps, firstQuery + 2);
+            }
+        }
+
+        /**
+         * Dynamic offset of the image's region of the instance buffer
+         */
+        uint32_t getInstanceOffset(uint32_t imageIndex) const {
+            return (uint32_t) instances->getOffset(imageIndex);
+        }
+
+        /**
+         * First query of the image's timestamps
+         */
+        static uint32_t getFirstQuery(uint32_t imageIndex) {
+            return imageIndex * FRUSTUM_MAX_VIEWS * RENDERING_TIMESTAMPS_PER_PASS;
+        }
+
+        /**
+         * Sums the timestamps the image's last submission wrote into timings, must be called once it finished
+         */
+        void readTimings(uint32_t imageIndex) {
+            uint32_t passes = timedPasses[imageIndex];
+            if (!timestamps || passes == 0) {
+                return;
+            }
+            std::vector<uint64_t> values(passes * RENDERING_TIMESTAMPS_PER_PASS);
+            vk::Result result = context->getDevice().getQueryPoolResults(
+                    timestamps,
+                    getFirstQuery(imageIndex), (uint32_t) values.size(),
+                    values.size() * sizeof(uint64_t), values.data(), sizeof(uint64_t),
+                    vk::QueryResultFlagBits::e64
+            );
+            if (result != vk::Result::eSuccess) {
+                return;
+            }
+            // timestampPeriod is in nanoseconds per tick
+            double toMilliseconds = timestampPeriod / 1000000.0;
+            PassTimings sum;
+            for (uint32_t p = 0; p < passes; ++p) {
+                const uint64_t *pass = values.data() + p * RENDERING_TIMESTAMPS_PER_PASS;
+                sum.prepassMilliseconds += (double) (pass[1] - pass[0]) * toMilliseconds;
+                sum.colorMilliseconds += (double) (pass[2] - pass[1]) * toMilliseconds;
+            }
+            timings = sum;
+        }
+
+        /**
+         * Draws the instances visible to the viewport into its target
+         */
+        void recordViewport(const vk::CommandBuffer &primaryBuffer, uint32_t imageIndex, uint32_t v) const {
+            const Viewport &viewport = viewports[v];
+            recordPass(
+                    primaryBuffer, viewport.target->getFramebuffer(), viewport.target->getExtent(), passDraws[v],
+                    passUniformOffsets[v], getInstanceOffset(imageIndex),
+                    getFirstQuery(imageIndex) + v * RENDERING_TIMESTAMPS_PER_PASS
+            );
+        }
+
+        /**
+         * Copies every viewport's target into its rectangle of the swapchain image
+         */
+        void recordComposite(const vk::CommandBuffer &primaryBuffer, uint32_t imageIndex) const {
+            const vk::Image &image = context->getSwapChainContext()->getSwapchainImages()[imageIndex].getImage();
+            vk::ImageSubresourceLayers layers(vk::ImageAspectFlagBits::eColor, 0, 0, 1);
+            for (const Viewport &viewport : viewports) {
+                const vk::Extent2D &extent = viewport.target->getExtent();
+                vk::ImageCopy region(
+                        layers, vk::Offset3D(0, 0, 0),
+                        layers, vk::Offset3D(viewport.rect.offset.x, viewport.rect.offset.y, 0),
+                        vk::Extent3D(extent.width, extent.height, 1)
+                );
+                primaryBuffer.copyImage(
+                        viewport.target->getImage(), vk::ImageLayout::eTransferSrcOptimal,
+                        image, vk::ImageLayout::eTransferDstOptimal,
+                        region
+                );
+            }
+        }
+
+        void dispose() {
+            instances->dispose();
+            uniforms->dispose();
+            textureTable->dispose();
+            context->getDevice().destroy(pipelineLayout);
+            graph.dispose();
+            for (const vk::Framebuffer &framebuffer : framebuffers) {
+                context->getDevice().destroy(framebuffer);
+            }
+            if (timestamps) {
+                context->getDevice().destroy(timestamps);
+            }
+            for (Viewport &viewport : viewports) {
+                viewport.target->dispose();
+            }
+            // Frees the primary and acquire buffers along with it
+            context->getDevice().destroy(pool);
+        }
+
+        /**
+         * Adds a view drawn into rect of the window, returns its index.
+         */
+        size_t addViewport(const overeditor::graphics::Camera &camera, const vk::Rect2D &rect) {
+            auto scContext = context->getSwapChainContext();
+            const vk::Extent2D &extent = scContext->getSwapchainExtent();
+            if (viewports.size() >= FRUSTUM_MAX_VIEWS) {
+                throw std::runtime_error("Too many viewports");
+            }
+            if (!(scContext->getImageUsage() & vk::ImageUsageFlagBits::eTransferDst)) {
+                throw std::runtime_error("The swapchain doesn't support copying viewports into it");
+            }
+            if (rect.extent.width == 0 || rect.extent.height == 0 || rect.offset.x < 0 || rect.offset.y < 0
+                || rect.offset.x + rect.extent.width > extent.width
+                || rect.offset.y + rect.extent.height > extent.height) {
+                throw std::runtime_error("Viewport doesn't fit in the window");
+            }
+            Viewport viewport;
+            viewport.camera = camera;
+            viewport.rect = rect;
+            viewport.target.reset(new overeditor::graphics::RenderTarget(
+                    *context, scContext->getSwapchainFormat(), rect.extent
+            ));
+            viewports.push_back(std::move(viewport));
+            buildGraph();
+            // Every recorded primary buffer is missing the new viewport
+            visibilityVersion++;
+            return viewports.size() - 1;
+        }
+
+        overeditor::graphics::Camera &getCamera(size_t viewport) {
+            return viewports[viewport].camera;
+        }
+
+        size_t getViewportCount() const {
+            return viewports.size();
+        }
+
+        /**
+         * Mask of the viewports every drawn instance was visible in during the last frame, in draw order
+         */
+        const std::vector<uint32_t> &getVisibility() const {
+            return visibility;
+        }
+
+        const overeditor::graphics::CullStatistics &getCullStatistics() const {
+            return cullStatistics;
+        }
+
+        /**
+         * Replaces the meshes instances are tested against after frustum culling. Only viewports are occlusion
+         * culled, the meshes must outlive the system or the next call.
+         */
+        void setOccluders(const std::vector<overeditor::graphics::Occluder> &occluders) {
+            RenderingSystem::occluders = occluders;
+        }
+
+        /**
+         * Occluded instances and the CPU time spent rasterizing and testing during the last frame, summed over
+         * every viewport
+         */
+        const overeditor::graphics::OcclusionStatistics &getOcclusionStatistics() const {
+            return occlusionStatistics;
+        }
+
+        DepthMode getDepthMode() const {
+            return depthMode;
+        }
+
+        /**
+         * Index of the subpass of renderPass drawables create their color pipeline for, the prepass is subpass 0
+         */
+        uint32_t getColorSubpass() const {
+            return depthMode == eDepthPrepass ? 1 : 0;
+        }
+
+        /**
+         * GPU time the passes of the last presented frame took, to pick the depth mode that suits a scene
+         */
+        const PassTimings &getPassTimings() const {
+            return timings;
+        }
+
+        /**
+         * Passes, barriers and depth buffer memory of the frame, with and without aliasing
+         */
+        const overeditor::graphics::RenderGraphStatistics &getGraphStatistics() const {
+            return graph.getStatistics();
+        }
+
+        /**
+         * State changes of the last recorded frame, sorted and as if drawn unsorted
+         */
+        const DrawStatistics &getDrawStatistics() const {
+            return drawStatistics;
+        }
+
+        /**
+         * Layout every drawable's pipeline must be created with, see PassUniforms and DrawConstants
+         */
+        const vk::PipelineLayout &getPipelineLayout() const {
+            return pipelineLayout;
+        }
+
+        const overeditor::graphics::InstanceBuffer &getInstances() const {
+            return *instances;
+        }
+
+        /**
+         * Streamer whose textures drawables sample, null for none. Only viewports know the size instances are drawn
+         * at, so without them textures keep the mips they start with.
+         */
+        void setTextureStreamer(overeditor::graphics::textures::TextureStreamer *textureStreamer) {
+            RenderingSystem::textureStreamer = textureStreamer;
+        }
+
+        /**
+         * Makes the next submission wait on the semaphore at the given stage, usually the finished semaphore of a
+         * ComputePass whose results this frame reads.
+         */
+        void waitFor(const vk::Semaphore &semaphore, vk::PipelineStageFlags stage) {
+            waitSemaphores.push_back(semaphore);
+            waitStages.push_back(stage);
+        }
+
+        /**
+         * Makes the next submission acquire a range a ComputePass released to the graphics family, before anything
+         * reads it. The semaphore the pass signals must be given to waitFor as well.
+         */
+        void acquire(const overeditor::graphics::BufferHandoff &handoff) {
+            if (handoff.transfersOwnership()) {
+                acquires.push_back(handoff);
+            }
+        }
+
+        /**
+         * Records the pending acquires into acquireBuffer, returns false if there were none.
+         * The primary buffers are recorded once and replayed, so the acquires can't be part of them.
+         */
+        bool recordAcquires() {
+            if (acquires.empty()) {
+                return false;
+            }
+            acquireBuffer.begin(
+                    vk::CommandBufferBeginInfo(
+                            (vk::CommandBufferUsageFlags) vk::CommandBufferUsageFlagBits::eOneTimeSubmit
+                    )
+            );
+            for (const overeditor::graphics::BufferHandoff &handoff : acquires) {
+                handoff.acquire(acquireBuffer);
+            }
+            acquireBuffer.end();
+            acquires.clear();
+            return true;
         }
 
         void update(
@@ -96,8 +1157,31 @@ namespace overeditor::systems::graphics {
                 entityx::EventManager &events,
                 entityx::TimeDelta dt
         ) override {
-            std::vector<vk::CommandBuffer> secondaryBuffers;
-
+            auto queueContext = context->getQueueContext();
+            auto &queue = queueContext->getGraphicsQueue();
+            if (drawables.empty()) {
+                // Nothing to draw, so no image is acquired. The semaphores given to waitFor are still waited on, so
+                // they are unsignaled before their ComputePass signals them again, and the handoffs still acquired
+                bool acquiring = recordAcquires();
+                auto lock = queueContext->lock(queue);
+                if (!waitSemaphores.empty() || acquiring) {
+                    vk::SubmitInfo waits(
+                            (uint32_t) waitSemaphores.size(), waitSemaphores.data(), waitStages.data(),
+                            acquiring ? 1 : 0, &acquireBuffer,
+                            0, nullptr
+                    );
+                    vkAssertOk(
+                            queue.submit(1, &waits, nullptr)
+                    )
+                    waitSemaphores.clear();
+                    waitStages.clear();
+                }
+                // Resources released meanwhile are only destroyed once a frame retires them
+                uint64_t submitted = resources->endFrame();
+                queue.waitIdle();
+                resources->retire(submitted);
+                return;
+            }
             uint32_t imageIndex;
             const auto &device = context->getDevice();
             const auto &swapchain = context->getSwapChainContext()->getSwapchain();
@@ -108,53 +1192,65 @@ namespace overeditor::systems::graphics {
                     nullptr,
                     &imageIndex
             );
-
-            vk::PipelineStageFlags waitStages[] = {vk::PipelineStageFlagBits::eColorAttachmentOutput};
-            //Re-record buffer
-            entityx::ComponentHandle<Transform> transform;
-            entityx::ComponentHandle<Drawable> drawable;
-            for (entityx::Entity e : entities.entities_with_components(transform, drawable)) {
-                auto t = transform.get();
-                auto d = drawable.get();
-                secondaryBuffers.emplace_back(d->buf);
+            writeInstances(imageIndex);
+            writeUniforms(imageIndex);
+            if (!viewports.empty()) {
+                updateBounds();
+                cull();
             }
-            if (secondaryBuffers.empty()) {
-                //Nothing to draw
-                return;
+            // No frame is running, update waits for each one to finish
+            textureTable->update(textureStreamer);
+            auto &primaryBuffer = primaryBuffers[imageIndex];
+            RecordedVersions versions{
+                    storage->getDrawableVersion(), viewports.empty() ? 0 : visibilityVersion,
+                    resources->getVersion<overeditor::graphics::BufferResource>(),
+                    resources->getVersion<overeditor::graphics::PipelineResource>(),
+                    textureTable->getVersion()
+            };
+            if (recordedVersions[imageIndex] != versions) {
+                //Re-record buffer
+                gatherDraws();
+                uint32_t passes = viewports.empty() ? 1 : (uint32_t) viewports.size();
+                passDraws.resize(passes);
+                drawStatistics = DrawStatistics();
+                for (uint32_t p = 0; p < passes; ++p) {
+                    sortPass(p, viewports.empty() ? nullptr : &viewports[p]);
+                }
+                primaryBuffer.begin(
+                        vk::CommandBufferBeginInfo(
+                                (vk::CommandBufferUsageFlags) vk::CommandBufferUsageFlagBits::eSimultaneousUse
+                        )
+                );
+                if (timestamps) {
+                    primaryBuffer.resetQueryPool(
+                            timestamps, getFirstQuery(imageIndex), passes * RENDERING_TIMESTAMPS_PER_PASS
+                    );
+                }
+                timedPasses[imageIndex] = passes;
+                graph.record(primaryBuffer, imageIndex);
+                primaryBuffer.end();
+                recordedVersions[imageIndex] = versions;
             }
-            primaryBuffer.begin(
-                    vk::CommandBufferBeginInfo(
-                            (vk::CommandBufferUsageFlags) vk::CommandBufferUsageFlagBits::eSimultaneousUse
-                    )
-            );
-
-            vk::ClearValue value = vk::ClearColorValue((std::array<float, 4>) {
-                    0.0F, 0.0F, 0.0F, 1.0F
-            });
-            primaryBuffer.beginRenderPass(
-                    vk::RenderPassBeginInfo(
-                            renderPass,
-                            framebuffers[imageIndex],
-                            vk::Rect2D(vk::Offset2D(),
-                                       context->getSwapChainContext()->getSwapchainExtent()),
-                            1,
-                            &value
-                    ),
-                    vk::SubpassContents::eSecondaryCommandBuffers
-            );
-            primaryBuffer.executeCommands(secondaryBuffers);
-            primaryBuffer.endRenderPass();
-            primaryBuffer.end();
-            // Submit
+            if (!viewports.empty()) {
+                recordTexelDensities();
+            }
+            // Submit, the graph waits for the image to be available before its first use
+            graph.getWaits(waitSemaphores, waitStages);
+            // Submission order guarantees the acquires happen before the draws
+            vk::CommandBuffer buffers[] = {acquireBuffer, primaryBuffer};
+            bool acquiring = recordAcquires();
             vk::SubmitInfo info = vk::SubmitInfo(
-                    1, &imageAvailableSemaphore, waitStages,
-                    1, &primaryBuffer,
+                    (uint32_t) waitSemaphores.size(), waitSemaphores.data(), waitStages.data(),
+                    acquiring ? 2 : 1, acquiring ? buffers : &primaryBuffer,
                     1, &renderFinishedSemaphore
             );
-            auto &queue = context->getQueueContext()->getGraphicsQueue();
+            auto lock = queueContext->lock(queue);
             vkAssertOk(
                     queue.submit(1, &info, nullptr)
             )
+            uint64_t submitted = resources->endFrame();
+            waitSemaphores.clear();
+            waitStages.clear();
             vkAssertOk(
                     queue.presentKHR(
                             vk::PresentInfoKHR(
@@ -165,6 +1261,8 @@ namespace overeditor::systems::graphics {
                     )
             )
             queue.waitIdle();
+            resources->retire(submitted);
+            readTimings(imageIndex);
         }
     };
 }
@@ -0,0 +1,154 @@
+#ifndef OVEREDITOR_SPATIAL_INDEX_H
+#define OVEREDITOR_SPATIAL_INDEX_H
+
+#include <cstdint>
+#include <vector>
+#include <entityx/entityx.h>
+#include <glm/glm.hpp>
+#include <overeditor/ecs/systems/transform_hierarchy.h>
+#include <overeditor/graphics/frustum.h>
+#include <overeditor/utility/thread_pool.h>
+
+#define SPATIAL_INDEX_NONE UINT32_MAX
+/**
+ * Levels below the root, a node at depth d is 2^d times smaller than the root
+ */
+#define SPATIAL_INDEX_MAX_DEPTH 12
+/**
+ * Items a leaf should hold on average, the depth is limited accordingly on rebuild.
+ * Assumes maps spread mostly over two axes, so every level multiplies the used cells by 4 rather than 8.
+ */
+#define SPATIAL_INDEX_LEAF_ITEMS 8
+
+namespace overeditor::systems::spatial {
+
+    struct RayHit {
+        entityx::Entity::Id entity;
+        /**
+         * Along the ray direction, in units of its length
+         */
+        float distance;
+    };
+
+    struct SpatialIndexStatistics {
+        size_t itemCount = 0;
+        size_t nodeCount = 0;
+        /**
+         * Items whose bounds the last update recomputed
+         */
+        size_t updatedCount = 0;
+        /**
+         * Items centered outside the root cell, kept in the root and tested by every query
+         */
+        size_t overflowCount = 0;
+        bool rebuilt = false;
+    };
+
+    /**
+     * A loose octree over the world bounds of every entity with a Transform, for picking and region queries.
+     *
+     * Every entity is assumed to fill the unit cube scaled by its world matrix, like the RenderingSystem does. Items
+     * live in the deepest node whose cell contains their center and is at least as large as they are, and nodes
+     * are tested with bounds twice the size of their cell, so an item never has to be split or stored twice.
+     *
+     * The index follows the TransformHierarchy: only the ranges it recomputed are re-inserted, and when its order is
+     * rebuilt (a map loaded, entities added or removed) the whole tree is rebuilt, one root octant per thread.
+     * Must run after the TransformHierarchy.
+     */
+    class SpatialIndex : public entityx::System<SpatialIndex> {
+    private:
+        struct Node {
+            glm::vec3 center;
+            float halfSize;
+            uint32_t children[8];
+            std::vector<uint32_t> items;
+        };
+
+        struct Item {
+            entityx::Entity::Id entity;
+            glm::vec3 min, max;
+            uint32_t node;
+            uint32_t slot;
+        };
+
+        const overeditor::systems::transforms::TransformHierarchy *hierarchy;
+        utility::ThreadPool *pool;
+        // Node 0 is the root, items are in the same order as the hierarchy
+        std::vector<Node> nodes;
+        std::vector<Item> items;
+        uint32_t maxDepth;
+        uint64_t hierarchyVersion;
+        SpatialIndexStatistics statistics;
+
+        static Node makeNode(const glm::vec3 &center, float halfSize);
+
+        static void computeBounds(const glm::mat4 &world, glm::vec3 &min, glm::vec3 &max);
+
+        /**
+         * Descends from the given node, which is at the given depth, creating nodes as needed.
+         * Returns the node the item belongs to.
+         */
+        static uint32_t descend(
+                std::vector<Node> &nodes,
+                uint32_t node,
+                uint32_t depth,
+                uint32_t maxDepth,
+                const Item &item
+        );
+
+        static void attach(std::vector<Node> &nodes, uint32_t node, std::vector<Item> &items, uint32_t item);
+
+        void detach(uint32_t item);
+
+        bool isOutsideRoot(const Item &item) const;
+
+        void rebuild();
+
+        void refresh(uint32_t begin, uint32_t end);
+
+        /**
+         * Calls visit(item) for the items of every node whose loose bounds pass test(min, max).
+         * The root is always visited since it holds the items outside of it.
+         */
+        template<typename Test, typename Visit>
+        void traverse(Test test, Visit visit) const;
+
+    public:
+        SpatialIndex(
+                const overeditor::systems::transforms::TransformHierarchy &hierarchy,
+                utility::ThreadPool &pool
+        );
+
+        void update(
+                entityx::EntityManager &entities,
+                entityx::EventManager &events,
+                entityx::TimeDelta dt
+        ) override;
+
+        /**
+         * Finds the nearest entity whose bounds the ray hits within maxDistance, returns false if there is none
+         */
+        bool raycast(
+                const glm::vec3 &origin,
+                const glm::vec3 &direction,
+                float maxDistance,
+                RayHit &hit
+        ) const;
+
+        /**
+         * Appends every entity whose bounds overlap the box
+         */
+        void queryBox(const glm::vec3 &min, const glm::vec3 &max, std::vector<entityx::Entity::Id> &result) const;
+
+        /**
+         * Appends every entity whose bounds may be inside the frustum
+         */
+        void queryFrustum(
+                const overeditor::graphics::Frustum &frustum,
+                std::vector<entityx::Entity::Id> &result
+        ) const;
+
+        const SpatialIndexStatistics &getStatistics() const;
+    };
+}
+#endif
@@ -0,0 +1,122 @@
+#ifndef OVEREDITOR_TRANSFORM_HIERARCHY_H
+#define OVEREDITOR_TRANSFORM_HIERARCHY_H
+
+#include <cstdint>
+#include <vector>
+#include <entityx/entityx.h>
+#include <glm/glm.hpp>
+#include <glm/gtx/quaternion.hpp>
+#include <overeditor/ecs/components/common.h>
+#include <overeditor/ecs/components/hierarchy.h>
+#include <overeditor/utility/event_bus.h>
+#include <overeditor/utility/thread_pool.h>
+
+#define TRANSFORM_HIERARCHY_NO_PARENT UINT32_MAX
+
+namespace overeditor::systems::transforms {
+
+    struct TransformHierarchyStatistics {
+        uint32_t nodeCount = 0;
+        /**
+         * World matrices recomputed by the last update
+         */
+        uint32_t recomputedCount = 0;
+        /**
+         * Independent subtrees the last update recomputed, in parallel
+         */
+        uint32_t subtreeCount = 0;
+        bool rebuilt = false;
+    };
+
+    /**
+     * Computes the world matrix of every entity with a Transform, following Parent links.
+     *
+     * Nodes are stored in depth-first order, so every subtree is a contiguous range that starts with its root and
+     * every parent precedes its children. A TransformChangedEvent marks the subtree of the entity dirty, and only the
+     * dirty subtrees are recomputed on update, disjoint subtrees in parallel. Adding or removing a Transform or Parent
+     * rebuilds the order on the next update.
+     */
+    class TransformHierarchy
+            : public entityx::System<TransformHierarchy>, public entityx::Receiver<TransformHierarchy> {
+    private:
+        utility::ThreadPool *pool;
+        // Depth-first ordered nodes
+        std::vector<entityx::Entity::Id> order;
+        std::vector<uint32_t> parents;
+        std::vector<uint32_t> subtreeSizes;
+        std::vector<glm::vec3> positions;
+        std::vector<glm::quat> rotations;
+        std::vector<glm::vec3> scales;
+        std::vector<glm::mat4> worldMatrices;
+        // Position in order by entity index, TRANSFORM_HIERARCHY_NO_PARENT if the entity isn't part of it
+        std::vector<uint32_t> positionsByIndex;
+        std::vector<entityx::Entity::Id> changed;
+        std::vector<std::pair<uint32_t, uint32_t>> recomputed;
+        bool structureDirty;
+        uint64_t version;
+        TransformHierarchyStatistics statistics;
+
+        void rebuild(entityx::EntityManager &entities);
+
+        void recompute(uint32_t begin, uint32_t end);
+
+    public:
+        TransformHierarchy(utility::ThreadPool &pool, utility::EventBus &eventBus);
+
+        void configure(entityx::EventManager &events) override;
+
+        void update(
+                entityx::EntityManager &entities,
+                entityx::EventManager &events,
+                entityx::TimeDelta dt
+        ) override;
+
+        void receive(const entityx::ComponentAddedEvent<Transform> &event);
+
+        void receive(const entityx::ComponentRemovedEvent<Transform> &event);
+
+        void receive(const entityx::ComponentAddedEvent<Parent> &event);
+
+        void receive(const entityx::ComponentRemovedEvent<Parent> &event);
+
+        void receive(const TransformChangedEvent &event);
+
+        /**
+         * Whether the entity has a world matrix, only valid after the update following its Transform being added
+         */
+        bool contains(entityx::Entity::Id id) const;
+
+        const glm::mat4 &getWorldMatrix(entityx::Entity::Id id) const;
+
+        /**
+         * Every entity of the hierarchy, in depth-first order
+         */
+        const std::vector<entityx::Entity::Id> &getOrder() const;
+
+        /**
+         * Position in getOrder of the parent of every node, TRANSFORM_HIERARCHY_NO_PARENT for roots
+         */
+        const std::vector<uint32_t> &getParents() const;
+
+        /**
+         * World matrices in the same order as getOrder
+         */
+        const std::vector<glm::mat4> &getWorldMatrices() const;
+
+        /**
+         * Ranges of getOrder whose world matrices the last update recomputed, disjoint and in ascending order.
+         * Covers every node when the order was rebuilt.
+         */
+        const std::vector<std::pair<uint32_t, uint32_t>> &getRecomputedRanges() const;
+
+        /**
+         * Incremented by every update that recomputed at least one world matrix
+         */
+        uint64_t getVersion() const;
+
+        const TransformHierarchyStatistics &getStatistics() const;
+
+        static glm::mat4 compose(const glm::vec3 &position, const glm::quat &rotation, const glm::vec3 &scale);
+    };
+}
+#endif
@@ -0,0 +1,183 @@
+#ifndef OVEREDITOR_WORLD_PARTITION_H
+#define OVEREDITOR_WORLD_PARTITION_H
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <entityx/entityx.h>
+#include <glm/glm.hpp>
+#include <overeditor/utility/worker_thread.h>
+
+namespace overeditor::systems::world {
+
+    struct CellCoordinate {
+        int32_t x, z;
+
+        bool operator==(const CellCoordinate &other) const {
+            return x == other.x && z == other.z;
+        }
+    };
+
+    struct CellCoordinateHash {
+        size_t operator()(const CellCoordinate &coordinate) const {
+            return std::hash<uint64_t>()(((uint64_t) (uint32_t) coordinate.x << 32) | (uint32_t) coordinate.z);
+        }
+    };
+
+    /**
+     * The loaded content of a single cell.
+     * Instances are created on the partition worker thread, every other call happens on the main thread.
+     */
+    class CellContent {
+    public:
+        virtual ~CellContent() = default;
+
+        virtual size_t getEntityCount() const = 0;
+
+        /**
+         * Assigns the components of the entity at the given index to a freshly created entity.
+         */
+        virtual void instantiate(size_t index, entityx::Entity entity) = 0;
+
+        /**
+         * Estimated CPU and GPU memory held by this content while loaded.
+         */
+        virtual size_t getMemoryUsage() const = 0;
+
+        /**
+         * Called once every entity of the cell was destroyed. GPU resources owned by the cell are freed here.
+         */
+        virtual void release() {}
+    };
+
+    class CellSource {
+    public:
+        virtual ~CellSource() = default;
+
+        /**
+         * Loads a cell, or returns nullptr if there is nothing in it. Called from the partition worker thread.
+         */
+        virtual std::unique_ptr<CellContent> load(const CellCoordinate &coordinate) = 0;
+    };
+
+    struct WorldPartitionSettings {
+        /**
+         * Side length of a cell on the XZ plane
+         */
+        float cellSize = 64;
+        /**
+         * Cells whose center is closer than this to the focus are loaded
+         */
+        float loadRadius = 256;
+        /**
+         * Cells whose center is farther than this from the focus are unloaded. Must be larger than loadRadius
+         */
+        float unloadRadius = 320;
+        /**
+         * Over it, cells beyond the load radius are unloaded farthest first and no new cell is requested. Cells
+         * inside the load radius are never unloaded for the budget.
+         */
+        size_t memoryBudget = 1024ULL * 1024 * 1024;
+        size_t maxPendingLoads = 4;
+        size_t maxCreationsPerFrame = 2048;
+        size_t maxDestructionsPerFrame = 2048;
+    };
+
+    struct WorldPartitionStatistics {
+        size_t residentCells = 0;
+        size_t loadingCells = 0;
+        size_t memoryUsage = 0;
+        size_t createdEntities = 0;
+        size_t destroyedEntities = 0;
+    };
+
+    /**
+     * Splits the map into a grid of cells on the XZ plane and streams their content in and out around a focus point.
+     *
+     * Cell content is loaded on a worker thread, nearest cells first. Entities are created and destroyed during
+     * update, which runs at a frame boundary, and never more than maxCreationsPerFrame / maxDestructionsPerFrame per
+     * frame, so crossing into a dense area is spread over several frames instead of causing a hitch.
+     */
+    class WorldPartition : public entityx::System<WorldPartition> {
+    private:
+        enum class CellState {
+            eLoading,
+            eInstantiating,
+            eResident,
+            eUnloading
+        };
+
+        struct Cell {
+            CellState state;
+            std::unique_ptr<CellContent> content;
+            std::vector<entityx::Entity> entities;
+            bool wanted;
+        };
+
+        struct CompletedLoad {
+            CellCoordinate coordinate;
+            std::unique_ptr<CellContent> content;
+        };
+
+        std::shared_ptr<CellSource> source;
+        WorldPartitionSettings settings;
+        WorldPartitionStatistics statistics;
+        glm::vec3 focus;
+        std::unordered_map<CellCoordinate, Cell, CellCoordinateHash> cells;
+        size_t pendingLoads;
+        std::mutex completedMutex;
+        std::deque<CompletedLoad> completed;
+        utility::WorkerThread worker;
+
+        float distanceTo(const CellCoordinate &coordinate) const;
+
+        void collectLoads();
+
+        void requestCells();
+
+        void enforceBudget();
+
+        void instantiateCells(entityx::EntityManager &entities);
+
+        void destroyCells();
+
+        std::vector<CellCoordinate> sortedByDistance(CellState state) const;
+
+    public:
+        /**
+         * Nothing is streamed in without a source
+         */
+        explicit WorldPartition(
+                const std::shared_ptr<CellSource> &source = nullptr,
+                const WorldPartitionSettings &settings = WorldPartitionSettings()
+        );
+
+        void update(
+                entityx::EntityManager &entities,
+                entityx::EventManager &events,
+                entityx::TimeDelta dt
+        ) override;
+
+        /**
+         * Cells already loaded from the previous source stay until they leave the unload radius.
+         */
+        void setSource(const std::shared_ptr<CellSource> &source);
+
+        /**
+         * Sets the point cells are streamed around, usually the camera position.
+         */
+        void setFocus(const glm::vec3 &focus);
+
+        CellCoordinate getCellAt(const glm::vec3 &position) const;
+
+        bool isResident(const CellCoordinate &coordinate) const;
+
+        const WorldPartitionSettings &getSettings() const;
+
+        const WorldPartitionStatistics &getStatistics() const;
+    };
+}
+#endif
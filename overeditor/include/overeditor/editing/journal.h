@@ -0,0 +1,227 @@
+#ifndef OVEREDITOR_JOURNAL_H
+#define OVEREDITOR_JOURNAL_H
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+#include <entityx/entityx.h>
+#include <overeditor/ecs/components/common.h>
+#include <overeditor/utility/event_bus.h>
+
+namespace overeditor::editing {
+
+    /**
+     * An immutable list of entities, shared by every history entry that edits the same selection.
+     */
+    typedef std::shared_ptr<const std::vector<entityx::Entity::Id>> Selection;
+
+    /**
+     * A single undoable change.
+     */
+    class JournalEntry {
+    public:
+        virtual ~JournalEntry() = default;
+
+        virtual void undo(entityx::EntityManager &entities, utility::EventBus &eventBus) = 0;
+
+        virtual void redo(entityx::EntityManager &entities, utility::EventBus &eventBus) = 0;
+
+        /**
+         * Approximate memory held by the entry. Data shared with other entries is split between them.
+         */
+        virtual size_t getMemoryUsage() const = 0;
+
+        /**
+         * Absorbs a newer entry of the same continuous gesture, returns false if it can't.
+         */
+        virtual bool merge(const JournalEntry &newer) {
+            return false;
+        }
+    };
+
+    enum TransformField : uint8_t {
+        eTransformPosition = 1,
+        eTransformRotation = 2,
+        eTransformScale = 4,
+        eTransformAll = 7
+    };
+
+    /**
+     * Old and new values of the edited Transform fields of a selection. Fields that weren't edited aren't stored.
+     */
+    class TransformEntry : public JournalEntry {
+    private:
+        Selection selection;
+        uint8_t fields;
+        std::vector<glm::vec3> oldPositions, newPositions;
+        std::vector<glm::quat> oldRotations, newRotations;
+        std::vector<glm::vec3> oldScales, newScales;
+
+        void apply(
+                entityx::EntityManager &entities,
+                utility::EventBus &eventBus,
+                const std::vector<glm::vec3> &positions,
+                const std::vector<glm::quat> &rotations,
+                const std::vector<glm::vec3> &scales
+        ) const;
+
+        void read(
+                entityx::EntityManager &entities,
+                std::vector<glm::vec3> &positions,
+                std::vector<glm::quat> &rotations,
+                std::vector<glm::vec3> &scales
+        ) const;
+
+    public:
+        /**
+         * Captures the current values of the given fields. Call complete once the edit was applied.
+         */
+        TransformEntry(entityx::EntityManager &entities, const Selection &selection, uint8_t fields);
+
+        /**
+         * Captures the edited values.
+         */
+        void complete(entityx::EntityManager &entities);
+
+        void undo(entityx::EntityManager &entities, utility::EventBus &eventBus) override;
+
+        void redo(entityx::EntityManager &entities, utility::EventBus &eventBus) override;
+
+        size_t getMemoryUsage() const override;
+
+        bool merge(const JournalEntry &newer) override;
+    };
+
+    /**
+     * Addition (or removal) of a component of type T to every entity of a selection.
+     * Removals keep the removed values so undo can restore them.
+     */
+    template<typename T>
+    class ComponentEntry : public JournalEntry {
+    private:
+        Selection selection;
+        std::vector<T> values;
+        bool added;
+
+        void assignAll(entityx::EntityManager &entities) {
+            for (size_t i = 0; i < selection->size(); ++i) {
+                entityx::Entity::Id id = (*selection)[i];
+                if (entities.valid(id) && !entities.has_component<T>(id)) {
+                    entities.get(id).template assign_from_copy<T>(values[i]);
+                }
+            }
+        }
+
+        void removeAll(entityx::EntityManager &entities) {
+            for (auto id : *selection) {
+                if (entities.valid(id) && entities.has_component<T>(id)) {
+                    entities.remove<T>(id);
+                }
+            }
+        }
+
+    public:
+        /**
+         * Records the components of the selection right after they were added, or right before they are removed.
+         * Entities that were destroyed or don't have the component are left out of the entry.
+         */
+        ComponentEntry(entityx::EntityManager &entities, const Selection &selection, bool added)
+                : selection(selection), values(), added(added) {
+            values.reserve(selection->size());
+            std::vector<entityx::Entity::Id> recorded;
+            for (auto id : *selection) {
+                if (entities.valid(id) && entities.has_component<T>(id)) {
+                    values.push_back(*entities.component<T>(id));
+                    recorded.push_back(id);
+                }
+            }
+            // The selection stays shared unless some of it had to be left out
+            if (recorded.size() != selection->size()) {
+                ComponentEntry::selection = std::make_shared<const std::vector<entityx::Entity::Id>>(
+                        std::move(recorded)
+                );
+            }
+        }
+
+        void undo(entityx::EntityManager &entities, utility::EventBus &eventBus) override {
+            if (added) {
+                removeAll(entities);
+            } else {
+                assignAll(entities);
+            }
+        }
+
+        void redo(entityx::EntityManager &entities, utility::EventBus &eventBus) override {
+            if (added) {
+                assignAll(entities);
+            } else {
+                removeAll(entities);
+            }
+        }
+
+        size_t getMemoryUsage() const override {
+            return sizeof(*this) + values.capacity() * sizeof(T) +
+                   selection->capacity() * sizeof(entityx::Entity::Id) / selection.use_count();
+        }
+    };
+
+    /**
+     * Linear undo/redo history of editor operations, bounded by a memory cap.
+     */
+    class Journal {
+    private:
+        struct Record {
+            std::unique_ptr<JournalEntry> entry;
+            size_t memory;
+        };
+
+        entityx::EntityManager *entities;
+        utility::EventBus *eventBus;
+        std::deque<Record> history;
+        std::vector<Record> undone;
+        size_t memoryUsage;
+        size_t memoryCap;
+        uint64_t openGesture;
+
+        void trim();
+
+    public:
+        Journal(
+                entityx::EntityManager &entities,
+                utility::EventBus &eventBus,
+                size_t memoryCap = 256ULL * 1024 * 1024
+        );
+
+        /**
+         * Adds an already applied change to the history and clears the redo stack.
+         * Consecutive entries recorded with the same non-zero gesture id, such as the updates of a single gizmo
+         * drag, are merged into one entry.
+         */
+        void record(std::unique_ptr<JournalEntry> entry, uint64_t gesture = 0);
+
+        /**
+         * Stops merging entries into the current gesture, e.g. when the mouse button is released.
+         */
+        void endGesture();
+
+        bool undo();
+
+        bool redo();
+
+        bool canUndo() const;
+
+        bool canRedo() const;
+
+        void clear();
+
+        size_t getMemoryUsage() const;
+
+        size_t getMemoryCap() const;
+
+        void setMemoryCap(size_t memoryCap);
+
+        size_t getHistorySize() const;
+    };
+}
+#endif
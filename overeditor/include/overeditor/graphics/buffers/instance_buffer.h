@@ -0,0 +1,75 @@
+#ifndef OVEREDITOR_INSTANCE_BUFFER_H
+#define OVEREDITOR_INSTANCE_BUFFER_H
+
+#include <cstdint>
+#include <vulkan/vulkan.hpp>
+#include <overeditor/graphics/device_context.h>
+#include <overeditor/utility/transform_batch.h>
+
+namespace overeditor::graphics {
+
+    /**
+     * Per-instance model matrices, one region per frame in flight, in a buffer that stays mapped for its whole life.
+     * Matrices are written straight into the mapped memory, there is no staging copy.
+     * Shaders read them through a single dynamic storage buffer descriptor, offset by the region of the frame.
+     */
+    class InstanceBuffer {
+    private:
+        const DeviceContext *context;
+        utility::MatrixLayout layout;
+        uint32_t frameCount;
+        uint32_t capacity;
+        vk::DeviceSize regionSize;
+        vk::Buffer buffer;
+        vk::DeviceMemory memory;
+        uint8_t *mapped;
+        vk::DescriptorSetLayout setLayout;
+        vk::DescriptorPool descriptorPool;
+        vk::DescriptorSet descriptorSet;
+
+        void allocate(uint32_t capacity);
+
+        void freeBuffer();
+
+    public:
+        InstanceBuffer(
+                const DeviceContext &context,
+                uint32_t frameCount,
+                utility::MatrixLayout layout,
+                uint32_t initialCapacity = 1024
+        );
+
+        InstanceBuffer(const InstanceBuffer &) = delete;
+
+        InstanceBuffer &operator=(const InstanceBuffer &) = delete;
+
+        /**
+         * Frees the buffer and the descriptor set, must be called before the device is destroyed.
+         */
+        void dispose();
+
+        /**
+         * Returns the mapped region of the frame, with room for at least count matrices.
+         * Growing the buffer waits for the device to be idle, since other frames may still be reading it, and
+         * rewrites the descriptor set, so the command buffers binding it must be recorded again.
+         */
+        float *map(uint32_t frame, uint32_t count);
+
+        vk::DeviceSize getOffset(uint32_t frame) const;
+
+        const vk::Buffer &getBuffer() const;
+
+        utility::MatrixLayout getLayout() const;
+
+        /**
+         * Layout of a set with the matrices of a frame as a dynamic storage buffer at binding 0, seen by the vertex
+         * stage. The set is bound with getOffset(frame) as its dynamic offset.
+         */
+        const vk::DescriptorSetLayout &getSetLayout() const;
+
+        const vk::DescriptorSet &getDescriptorSet() const;
+
+        uint32_t getCapacity() const;
+    };
+}
+#endif
@@ -0,0 +1,94 @@
+#ifndef OVEREDITOR_UNIFORM_RING_H
+#define OVEREDITOR_UNIFORM_RING_H
+
+#include <cstdint>
+#include <cstring>
+#include <vulkan/vulkan.hpp>
+#include <overeditor/graphics/device_context.h>
+
+namespace overeditor::graphics {
+
+    /**
+     * Uniforms that change every frame, one region per frame in flight, in a buffer that stays mapped for its whole
+     * life. Values are written straight into the mapped memory and read by shaders through a single dynamic uniform
+     * buffer descriptor, offset by what allocate returned, so nothing is allocated, mapped or updated per frame.
+     *
+     * A frame's allocations come one after the other from the start of its region, aligned to
+     * minUniformBufferOffsetAlignment. Allocating the same sizes in the same order every frame yields the same
+     * offsets, so command buffers may keep them across frames.
+     */
+    class UniformRing {
+    private:
+        const DeviceContext *context;
+        uint32_t frameCount;
+        vk::DeviceSize alignment;
+        vk::DeviceSize regionSize;
+        vk::DeviceSize bindingRange;
+        vk::Buffer buffer;
+        vk::DeviceMemory memory;
+        uint8_t *mapped;
+        // Frame being written and the next free byte of its region
+        uint32_t frame;
+        vk::DeviceSize cursor;
+        vk::DescriptorSetLayout setLayout;
+        vk::DescriptorPool descriptorPool;
+        vk::DescriptorSet descriptorSet;
+
+    public:
+        /**
+         * frameSize is how many bytes a frame may allocate, bindingRange how many a shader sees from an offset, the
+         * largest allocation.
+         */
+        UniformRing(
+                const DeviceContext &context,
+                uint32_t frameCount,
+                vk::DeviceSize frameSize,
+                vk::DeviceSize bindingRange
+        );
+
+        UniformRing(const UniformRing &) = delete;
+
+        UniformRing &operator=(const UniformRing &) = delete;
+
+        /**
+         * Frees the buffer and the descriptor set, must be called before the device is destroyed.
+         */
+        void dispose();
+
+        /**
+         * Starts the frame's region over. What was allocated in it before must no longer be read by the GPU.
+         */
+        void begin(uint32_t frame);
+
+        /**
+         * Reserves size bytes of the current frame, points destination at them and returns their dynamic offset.
+         * Throws if the frame is out of room or size is larger than the binding range.
+         */
+        uint32_t allocate(vk::DeviceSize size, void *&destination);
+
+        template<typename T>
+        uint32_t push(const T &value) {
+            void *destination;
+            uint32_t offset = allocate(sizeof(T), destination);
+            std::memcpy(destination, &value, sizeof(T));
+            return offset;
+        }
+
+        const vk::Buffer &getBuffer() const;
+
+        /**
+         * Layout of a set with the ring as a dynamic uniform buffer at binding 0, seen by every graphics stage
+         */
+        const vk::DescriptorSetLayout &getSetLayout() const;
+
+        const vk::DescriptorSet &getDescriptorSet() const;
+
+        vk::DeviceSize getAlignment() const;
+
+        /**
+         * Bytes allocated so far in the current frame, padding included
+         */
+        vk::DeviceSize getUsed() const;
+    };
+}
+#endif
@@ -12,6 +12,7 @@
 #include <glm/glm.hpp>
 #include <vulkan/vulkan.hpp>
 #include <overeditor/graphics/device_context.h>
+#include <overeditor/graphics/resource_registry.h>
 
 namespace overeditor::graphics {
 
@@ -19,9 +20,10 @@ namespace overeditor::graphics {
     private:
         uint8_t elementLength;
         uint8_t elementCount;
+        vk::Format format;
     public:
-        GeometryLayoutElement(uint8_t elementLength, uint8_t elementCount) : elementLength(elementLength),
-                                                                             elementCount(elementCount) {}
+        GeometryLayoutElement(uint8_t elementLength, uint8_t elementCount, vk::Format format)
+                : elementLength(elementLength), elementCount(elementCount), format(format) {}
 
         uint8_t getElementLength() const {
             return elementLength;
@@ -34,12 +36,26 @@ namespace overeditor::graphics {
         uint8_t getSize() const {
             return elementLength * elementCount;
         }
+
+        /**
+         * Format of the vertex attribute reading the element
+         */
+        vk::Format getFormat() const {
+            return format;
+        }
     };
 
+    /**
+     * Interleaved vertex elements, read by the vertex shader at consecutive locations from 0.
+     * Floats are read as floats, bytes as normalized floats and 32 bit integers as unsigned integers.
+     */
     class GeometryLayout {
     private:
         std::vector<GeometryLayoutElement> elements;
     public:
+        /**
+         * Appends an element of 1 to 4 components
+         */
         template<typename T>
         void push(uint8_t count);
 
@@ -52,24 +68,59 @@ namespace overeditor::graphics {
             return s;
         }
 
+        /**
+         * The vertex binding the layout is read from, one interleaved buffer advancing per vertex
+         */
+        vk::VertexInputBindingDescription getBinding(uint32_t binding = 0) const;
 
+        std::vector<vk::VertexInputAttributeDescription> getAttributes(uint32_t binding = 0) const;
     };
 
 
     class GeometryBuffer {
     private:
         GeometryLayout layout;
-        vk::Buffer buffer;
-        vk::DeviceMemory memory;
+        BufferHandle buffer;
+        uint32_t vertexCount;
 
     public:
         explicit GeometryBuffer(
-                GeometryLayout layout
-        ) : layout(std::move(layout)) {}
+                GeometryLayout layout,
+                BufferHandle buffer = BufferHandle(),
+                uint32_t vertexCount = 0
+        ) : layout(std::move(layout)), buffer(buffer), vertexCount(vertexCount) {}
+
+        /**
+         * Copies the vertices into a new host visible vertex buffer owned by the registry. The previous buffer is
+         * released, so a mesh can be replaced while frames drawing the old vertices are in flight. Replacing it
+         * changes the registry's buffer version, which makes the RenderingSystem record its draws again.
+         */
+        void upload(
+                const DeviceContext &context,
+                ResourceRegistry &registry,
+                const void *vertices,
+                vk::DeviceSize size
+        );
+
+        /**
+         * Releases the buffer, it is destroyed once the frames drawing it retired so meshes can be unloaded any time
+         */
+        void dispose(ResourceRegistry &registry) {
+            registry.release(buffer);
+            buffer = BufferHandle();
+            vertexCount = 0;
+        }
+
+        const BufferHandle &getBuffer() const {
+            return buffer;
+        }
+
+        const GeometryLayout &getLayout() const {
+            return layout;
+        }
 
-        void dispose(vk::Device &device) {
-            device.destroy(buffer);
-            device.free(memory);
+        uint32_t getVertexCount() const {
+            return vertexCount;
         }
 
 
@@ -0,0 +1,62 @@
+#ifndef OVEREDITOR_CAMERA_H
+#define OVEREDITOR_CAMERA_H
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+namespace overeditor::graphics {
+
+    enum CameraProjection : uint8_t {
+        ePerspective,
+        eOrthographic
+    };
+
+    /**
+     * Position, orientation and projection of a view. Looks down its local -Z axis, with +Y up.
+     * Projections map depth to [0, 1] and flip Y, matching Vulkan clip space.
+     */
+    struct Camera {
+        glm::vec3 position = glm::vec3();
+        glm::quat rotation = glm::quat(1, 0, 0, 0);
+        CameraProjection projection = ePerspective;
+        /**
+         * Vertical field of view in radians, used by perspective cameras
+         */
+        float fieldOfView = glm::radians(60.0F);
+        /**
+         * Half of the visible height, used by orthographic cameras
+         */
+        float orthographicSize = 32;
+        float nearPlane = 0.1F;
+        float farPlane = 4096;
+
+        glm::vec3 getForward() const;
+
+        glm::vec3 getUp() const;
+
+        glm::mat4 getView() const;
+
+        glm::mat4 getProjection(float aspect) const;
+
+        glm::mat4 getViewProjection(float aspect) const;
+
+        static Camera perspective(const glm::vec3 &position, const glm::vec3 &target, float fieldOfView);
+
+        /**
+         * Orthographic camera looking down at center along -Y
+         */
+        static Camera top(const glm::vec3 &center, float size);
+
+        /**
+         * Orthographic camera looking at center along -Z
+         */
+        static Camera front(const glm::vec3 &center, float size);
+
+        /**
+         * Orthographic camera looking at center along -X
+         */
+        static Camera side(const glm::vec3 &center, float size);
+    };
+}
+#endif
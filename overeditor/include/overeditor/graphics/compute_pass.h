@@ -0,0 +1,111 @@
+#ifndef OVEREDITOR_COMPUTE_PASS_H
+#define OVEREDITOR_COMPUTE_PASS_H
+
+#include <cstdint>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <overeditor/graphics/device_context.h>
+
+namespace overeditor::graphics {
+
+    /**
+     * Hands a buffer range over from one queue family to another.
+     *
+     * With exclusive sharing, a buffer written on one family must be released by a barrier recorded on that family
+     * and acquired by a matching barrier on the other before it is used there, with a semaphore ordering the two
+     * submissions. When both families are the same, release records a plain barrier and acquire records nothing.
+     */
+    struct BufferHandoff {
+        vk::Buffer buffer;
+        vk::DeviceSize offset;
+        vk::DeviceSize size;
+        uint32_t sourceFamily;
+        uint32_t destinationFamily;
+        vk::AccessFlags sourceAccess;
+        vk::PipelineStageFlags sourceStage;
+        vk::AccessFlags destinationAccess;
+        vk::PipelineStageFlags destinationStage;
+
+        bool transfersOwnership() const;
+
+        /**
+         * Recorded on the source family, after the last write
+         */
+        void release(const vk::CommandBuffer &commands) const;
+
+        /**
+         * Recorded on the destination family, before the first read
+         */
+        void acquire(const vk::CommandBuffer &commands) const;
+    };
+
+    /**
+     * Per-frame command buffers submitted to the compute queue.
+     *
+     * Each frame records into its own buffer, submits it with begin and submit, and signals a semaphore the graphics
+     * submission of the same frame waits on. On devices with an async compute family the work overlaps the graphics
+     * work of the previous frame; otherwise it runs on the graphics queue, in submission order.
+     */
+    class ComputePass {
+    private:
+        const DeviceContext *context;
+        vk::CommandPool pool;
+        std::vector<vk::CommandBuffer> buffers;
+        std::vector<vk::Semaphore> finishedSemaphores;
+        std::vector<vk::Fence> fences;
+        uint32_t recording;
+
+    public:
+        ComputePass(const DeviceContext &context, uint32_t frameCount);
+
+        ComputePass(const ComputePass &) = delete;
+
+        ComputePass &operator=(const ComputePass &) = delete;
+
+        /**
+         * Frees every object of the pass, must be called before the device is destroyed.
+         */
+        void dispose();
+
+        /**
+         * Waits for the previous submission of the frame to finish and starts recording its buffer
+         */
+        const vk::CommandBuffer &begin(uint32_t frame);
+
+        /**
+         * Ends recording and submits the frame, waiting on the given semaphores first.
+         * Signals getFinishedSemaphore(frame), which must be waited on before the next submission of the frame.
+         */
+        void submit(
+                const std::vector<vk::Semaphore> &waitSemaphores = {},
+                const std::vector<vk::PipelineStageFlags> &waitStages = {}
+        );
+
+        /**
+         * A handoff of the range from this pass to the graphics family
+         */
+        BufferHandoff toGraphics(
+                const vk::Buffer &buffer,
+                vk::DeviceSize offset,
+                vk::DeviceSize size,
+                vk::AccessFlags destinationAccess,
+                vk::PipelineStageFlags destinationStage
+        ) const;
+
+        /**
+         * A handoff of the range from the graphics family to this pass
+         */
+        BufferHandoff fromGraphics(
+                const vk::Buffer &buffer,
+                vk::DeviceSize offset,
+                vk::DeviceSize size,
+                vk::AccessFlags sourceAccess,
+                vk::PipelineStageFlags sourceStage
+        ) const;
+
+        const vk::Semaphore &getFinishedSemaphore(uint32_t frame) const;
+
+        uint32_t getFamilyIndex() const;
+    };
+}
+#endif
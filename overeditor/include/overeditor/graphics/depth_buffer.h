@@ -0,0 +1,38 @@
+#ifndef OVEREDITOR_DEPTH_BUFFER_H
+#define OVEREDITOR_DEPTH_BUFFER_H
+
+#include <vulkan/vulkan.hpp>
+#include <overeditor/graphics/device_context.h>
+
+namespace overeditor::graphics {
+
+    /**
+     * A depth attachment, one per framebuffer so images in flight never share it.
+     */
+    class DepthBuffer {
+    private:
+        const DeviceContext *context;
+        vk::Image image;
+        vk::DeviceMemory memory;
+        vk::ImageView view;
+    public:
+        DepthBuffer(const DeviceContext &context, vk::Format format, vk::Extent2D extent);
+
+        DepthBuffer(const DepthBuffer &) = delete;
+
+        DepthBuffer &operator=(const DepthBuffer &) = delete;
+
+        /**
+         * The first depth format the device can use as an optimal tiling attachment, preferring pure depth formats
+         */
+        static vk::Format selectFormat(const DeviceContext &context);
+
+        /**
+         * Frees the image, must be called before the device is destroyed.
+         */
+        void dispose();
+
+        const vk::ImageView &getView() const;
+    };
+}
+#endif
@@ -4,6 +4,7 @@
 #include <vulkan/vulkan.hpp>
 #include <overeditor/graphics/swapchain_context.h>
 #include <overeditor/graphics/queue_context.h>
+#include <overeditor/utility/memory_tracker.h>
 
 namespace overeditor::graphics {
 
@@ -14,11 +15,16 @@ namespace overeditor::graphics {
         SwapChainContext *swapChainContext;
         PhysicalDeviceCandidate candidate;
         vk::Device device;
+        utility::MemoryTracker *memoryTracker;
     public:
+        /**
+         * VK_EXT_memory_budget is enabled when the device has it, so the tracker can follow the heap budgets
+         */
         DeviceContext(
                 const PhysicalDeviceCandidate &dev,
                 const Requirements &requirements,
-                const vk::SurfaceKHR &surface
+                const vk::SurfaceKHR &surface,
+                utility::MemoryTracker &memoryTracker
         );
 
         ~DeviceContext();
@@ -30,6 +36,15 @@ namespace overeditor::graphics {
         const vk::Device &getDevice() const;
 
         const PhysicalDeviceCandidate &getCandidate() const;
+
+        /**
+         * Allocates device memory and attributes it to the category. Every allocation goes through here.
+         */
+        vk::DeviceMemory allocateMemory(const vk::MemoryAllocateInfo &info, utility::MemoryCategory category) const;
+
+        void freeMemory(const vk::DeviceMemory &memory) const;
+
+        utility::MemoryTracker &getMemoryTracker() const;
     };
 }
 #endif
@@ -0,0 +1,54 @@
+#ifndef OVEREDITOR_DRAW_KEYS_H
+#define OVEREDITOR_DRAW_KEYS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <overeditor/utility/thread_pool.h>
+
+/**
+ * Widths of the fields of a draw key, from the most significant one down. They add up to 64.
+ * Ids wider than their field wrap around, which only makes sorting group them less well. Layers can't wrap without
+ * breaking the draw order, so they are clamped to the highest one the field holds instead.
+ */
+#define DRAW_KEY_LAYER_BITS 4
+#define DRAW_KEY_PIPELINE_BITS 12
+#define DRAW_KEY_MATERIAL_BITS 16
+#define DRAW_KEY_MESH_BITS 20
+#define DRAW_KEY_DEPTH_BITS 12
+
+/**
+ * Below this many draws a single thread sorts faster than the pool
+ */
+#define DRAW_SORT_PARALLEL_THRESHOLD 16384
+
+namespace overeditor::graphics {
+
+    /**
+     * A draw to record, ordered by its key. instance is its index in draw order.
+     */
+    struct DrawItem {
+        uint64_t key;
+        uint32_t instance;
+    };
+
+    /**
+     * Packs the state of a draw so sorting by the key draws layer by layer, and within a layer groups the draws
+     * sharing a pipeline, then a material, then a mesh, nearest first.
+     */
+    uint64_t makeDrawKey(uint32_t layer, uint32_t pipeline, uint32_t material, uint32_t mesh, uint32_t depth);
+
+    /**
+     * Maps a distance along the view direction to the depth field of a key, logarithmically so near draws are
+     * told apart more finely. Distances outside [nearPlane, farPlane] are clamped.
+     */
+    uint32_t quantizeDepth(float distance, float nearPlane, float farPlane);
+
+    /**
+     * Sorts the draws by key with a stable least significant digit radix sort, a byte per pass. Passes over bytes
+     * every key shares are skipped. Large lists are split across the pool, which may be null.
+     * scratch is resized to match and holds garbage afterwards, keep it around to avoid reallocating.
+     */
+    void sortDraws(utility::ThreadPool *pool, std::vector<DrawItem> &draws, std::vector<DrawItem> &scratch);
+}
+#endif
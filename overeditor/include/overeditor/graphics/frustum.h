@@ -0,0 +1,58 @@
+#ifndef OVEREDITOR_FRUSTUM_H
+#define OVEREDITOR_FRUSTUM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+/**
+ * Views a single cullSpheres call can test, one bit of the result masks each
+ */
+#define FRUSTUM_MAX_VIEWS 32
+
+namespace overeditor::graphics {
+
+    /**
+     * The six planes bounding the volume visible through a view projection matrix with [0, 1] depth.
+     * Plane normals point inwards and are normalized, w holds the distance.
+     */
+    struct Frustum {
+        glm::vec4 planes[6];
+
+        static Frustum fromMatrix(const glm::mat4 &viewProjection);
+
+        bool intersectsSphere(const glm::vec3 &center, float radius) const;
+
+        /**
+         * Conservative, boxes near a corner of the frustum may pass without touching it
+         */
+        bool intersectsBox(const glm::vec3 &min, const glm::vec3 &max) const;
+    };
+
+    struct CullStatistics {
+        size_t tested = 0;
+        /**
+         * Spheres outside the box around every frustum, rejected without testing any view
+         */
+        size_t rejected = 0;
+        /**
+         * Views tested after merging the ones with the same matrix
+         */
+        uint32_t uniqueViews = 0;
+    };
+
+    /**
+     * Tests count spheres (center in xyz, radius in w) against every view at once and writes one mask per sphere,
+     * bit i set if the sphere is visible in view i.
+     * Views with identical matrices share their result, and spheres outside the box bounding all frusta are rejected
+     * with a single test, so views that mostly overlap cost little more than one.
+     */
+    CullStatistics cullSpheres(
+            const glm::vec4 *spheres,
+            size_t count,
+            const std::vector<glm::mat4> &viewProjections,
+            uint32_t *masks
+    );
+}
+#endif
@@ -0,0 +1,110 @@
+#ifndef OVEREDITOR_MESH_BVH_H
+#define OVEREDITOR_MESH_BVH_H
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include <overeditor/graphics/mesh_data.h>
+
+/**
+ * Triangles a leaf may hold, two packets of four
+ */
+#define MESH_BVH_MAX_LEAF_TRIANGLES 8
+/**
+ * Deeper nodes are split at the median instead of by SAH, which also bounds the traversal stack
+ */
+#define MESH_BVH_MAX_DEPTH 48
+#define MESH_BVH_BINS 16
+
+namespace overeditor::graphics {
+
+    struct MeshHit {
+        /**
+         * Along the ray direction, in units of its length
+         */
+        float distance;
+        /**
+         * Index of the triangle in MeshData::indices, divided by 3
+         */
+        uint32_t triangle;
+        /**
+         * Barycentric coordinates of the hit, relative to the second and third vertex
+         */
+        float u, v;
+        /**
+         * Unit normal of the triangle, facing the side given by its winding
+         */
+        glm::vec3 normal;
+    };
+
+    /**
+     * 32 bytes, two to a cache line. The left child of an interior node directly follows it.
+     */
+    struct MeshBvhNode {
+        float min[3];
+        /**
+         * First packet of a leaf, right child of an interior node
+         */
+        uint32_t offset;
+        float max[3];
+        /**
+         * Triangles of a leaf, 0 for interior nodes
+         */
+        uint32_t count;
+    };
+
+    static_assert(sizeof(MeshBvhNode) == 32, "MeshBvhNode must stay 32 bytes");
+
+    /**
+     * Four triangles stored lane by lane, as the first vertex and the two edges leaving it, so a single SIMD test
+     * covers them all. Unused lanes are degenerate and never hit.
+     */
+    struct MeshTrianglePacket {
+        float v0[3][4];
+        float e1[3][4];
+        float e2[3][4];
+        uint32_t triangles[4];
+    };
+
+    /**
+     * A bounding volume hierarchy over the triangles of one mesh, built with the surface area heuristic.
+     * Immutable once built, so all instances of a mesh share it across threads.
+     */
+    class MeshBvh {
+    private:
+        std::vector<MeshBvhNode> nodes;
+        std::vector<MeshTrianglePacket> packets;
+
+    public:
+        explicit MeshBvh(const MeshData &mesh);
+
+        /**
+         * Finds the nearest triangle the ray hits within maxDistance, in the space of the mesh
+         */
+        bool raycast(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance, MeshHit &hit) const;
+
+        /**
+         * Same as raycast, for an instance of the mesh placed by world.
+         * The distance stays in units of the world direction and the normal is in world space.
+         */
+        bool raycast(
+                const glm::mat4 &world,
+                const glm::vec3 &origin,
+                const glm::vec3 &direction,
+                float maxDistance,
+                MeshHit &hit
+        ) const;
+
+        const std::vector<MeshBvhNode> &getNodes() const;
+
+        size_t getPacketCount() const;
+
+        /**
+         * Bytes held by the arrays of the tree
+         */
+        size_t getMemorySize() const;
+    };
+
+    typedef MeshCache<MeshBvh> MeshBvhCache;
+}
+#endif
@@ -0,0 +1,104 @@
+#ifndef OVEREDITOR_MESH_DATA_H
+#define OVEREDITOR_MESH_DATA_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include <overeditor/utility/memory_tracker.h>
+
+namespace overeditor::graphics {
+
+    /**
+     * CPU side copy of a cooked mesh, the GeometryBuffer only lives on the GPU.
+     * Three indices per triangle. Not modified once cooked, the structures built from it are never refreshed.
+     */
+    struct MeshData {
+        std::vector<glm::vec3> positions;
+        std::vector<uint32_t> indices;
+    };
+
+    /**
+     * Builds a T from a mesh the first time it is asked for, and hands the same one to every later caller, so all
+     * instances of the mesh share it. T must be constructible from a const MeshData & and have a getMemorySize.
+     * Thread safe.
+     */
+    template<typename T>
+    class MeshCache {
+    private:
+        struct Entry {
+            std::weak_ptr<const MeshData> mesh;
+            std::shared_ptr<const T> value;
+        };
+
+        mutable std::mutex mutex;
+        std::unordered_map<const MeshData *, Entry> entries;
+        utility::MemoryTracker *memoryTracker;
+
+        void track(const std::shared_ptr<const T> &value, bool allocated) {
+            if (memoryTracker == nullptr || !value) {
+                return;
+            }
+            if (allocated) {
+                memoryTracker->hostAllocated(utility::eMemoryAssetCache, value->getMemorySize());
+            } else {
+                memoryTracker->hostFreed(utility::eMemoryAssetCache, value->getMemorySize());
+            }
+        }
+
+    public:
+        /**
+         * What is built is reported to memoryTracker as asset cache memory when it isn't null
+         */
+        explicit MeshCache(utility::MemoryTracker *memoryTracker = nullptr)
+                : mutex(), entries(), memoryTracker(memoryTracker) {}
+
+        std::shared_ptr<const T> get(const std::shared_ptr<const MeshData> &mesh) {
+            if (!mesh) {
+                return nullptr;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto found = entries.find(mesh.get());
+                // A freed mesh's address may have been reused by this one
+                if (found != entries.end() && found->second.mesh.lock() == mesh) {
+                    return found->second.value;
+                }
+            }
+            // Built without holding the lock so other meshes can be looked up meanwhile
+            auto value = std::make_shared<const T>(*mesh);
+            std::lock_guard<std::mutex> lock(mutex);
+            Entry &entry = entries[mesh.get()];
+            if (entry.mesh.lock() != mesh) {
+                track(entry.value, false);
+                track(value, true);
+                entry.mesh = mesh;
+                entry.value = value;
+            }
+            return entry.value;
+        }
+
+        /**
+         * Drops what was built for meshes that were freed. The application calls it every frame.
+         */
+        void prune() {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto it = entries.begin(); it != entries.end();) {
+                if (it->second.mesh.expired()) {
+                    track(it->second.value, false);
+                    it = entries.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+
+        size_t size() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            return entries.size();
+        }
+    };
+}
+#endif
@@ -0,0 +1,111 @@
+#ifndef OVEREDITOR_OCCLUSION_H
+#define OVEREDITOR_OCCLUSION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+/**
+ * Default resolution of the occlusion depth buffer, small enough to rasterize every frame on a single core
+ */
+#define OCCLUSION_WIDTH 256
+#define OCCLUSION_HEIGHT 128
+
+namespace overeditor::graphics {
+
+    /**
+     * Triangles used only to hide what is behind them, usually a coarse version of a large mesh.
+     * Occluders must not be larger than what they stand for, or visible geometry would be culled.
+     */
+    struct OccluderMesh {
+        std::vector<glm::vec3> vertices;
+        std::vector<uint32_t> indices;
+
+        /**
+         * The [-1, 1] cube
+         */
+        static OccluderMesh box();
+    };
+
+    struct Occluder {
+        const OccluderMesh *mesh;
+        glm::mat4 model;
+    };
+
+    struct OcclusionStatistics {
+        size_t tested = 0;
+        size_t occluded = 0;
+        size_t triangles = 0;
+        double rasterizeMilliseconds = 0;
+        double testMilliseconds = 0;
+
+        OcclusionStatistics &operator+=(const OcclusionStatistics &other);
+    };
+
+    /**
+     * A low resolution depth buffer the occluders are rasterized into on the CPU, with a hierarchical-Z pyramid
+     * holding the farthest depth of every 2x2 block of the level below.
+     * Depth is [0, 1] with 0 nearest, like the Camera projections.
+     */
+    class OcclusionBuffer {
+    private:
+        uint32_t width, height;
+        // Level 0 is the depth buffer itself
+        std::vector<std::vector<float>> levels;
+        std::vector<uint32_t> levelWidths, levelHeights;
+
+        void rasterizeTriangle(const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c);
+
+    public:
+        /**
+         * The width is rounded up to a multiple of 4 so rows can be rasterized 4 pixels at a time
+         */
+        explicit OcclusionBuffer(uint32_t width = OCCLUSION_WIDTH, uint32_t height = OCCLUSION_HEIGHT);
+
+        /**
+         * Resets every pixel to the far plane
+         */
+        void clear();
+
+        /**
+         * Rasterizes the mesh, returns how many triangles were drawn.
+         * Triangles crossing the near plane are skipped rather than clipped, which only makes culling less aggressive.
+         */
+        size_t rasterize(const OccluderMesh &mesh, const glm::mat4 &modelViewProjection);
+
+        /**
+         * Rebuilds the pyramid from the depth buffer, must be called after rasterizing and before testing
+         */
+        void buildPyramid();
+
+        /**
+         * Whether the part of the box on screen is entirely behind what was rasterized.
+         * Boxes crossing the near plane are never occluded.
+         */
+        bool isOccluded(const glm::vec3 &min, const glm::vec3 &max, const glm::mat4 &viewProjection) const;
+
+        uint32_t getWidth() const;
+
+        uint32_t getHeight() const;
+
+        size_t getLevelCount() const;
+
+        const float *getLevel(size_t level) const;
+    };
+
+    /**
+     * Rasterizes the occluders as seen through viewProjection, then tests every sphere (center in xyz, radius in w)
+     * that still has bit set in its mask, clearing the bit of the occluded ones.
+     */
+    OcclusionStatistics cullOccluded(
+            OcclusionBuffer &buffer,
+            const std::vector<Occluder> &occluders,
+            const glm::mat4 &viewProjection,
+            const glm::vec4 *spheres,
+            size_t count,
+            uint32_t *masks,
+            uint32_t bit
+    );
+}
+#endif
@@ -0,0 +1,44 @@
+#ifndef OVEREDITOR_PIPELINE_CACHE_H
+#define OVEREDITOR_PIPELINE_CACHE_H
+
+#include <filesystem>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+namespace overeditor::graphics {
+
+    /**
+     * A vk::PipelineCache persisted to disk between runs.
+     *
+     * Loading the file and creating the cache are separate steps so the file can be read while the device is still
+     * being created. Data written by a different device or driver is discarded instead of handed to the driver.
+     */
+    class PipelineCache {
+    private:
+        std::filesystem::path path;
+        std::vector<char> initialData;
+        vk::PipelineCache cache;
+
+        bool isCompatible(const vk::PhysicalDeviceProperties &properties) const;
+
+    public:
+        explicit PipelineCache(std::filesystem::path path);
+
+        /**
+         * Reads the file, if there is one. Doesn't need a device, can run on any thread.
+         */
+        void load();
+
+        void create(const vk::Device &device, const vk::PhysicalDeviceProperties &properties);
+
+        /**
+         * Writes the current contents of the cache back to the file
+         */
+        void save(const vk::Device &device) const;
+
+        void dispose(const vk::Device &device);
+
+        const vk::PipelineCache &getCache() const;
+    };
+}
+#endif
@@ -1,6 +1,7 @@
 #ifndef OVEREDITOR_QUERYING_H
 #define OVEREDITOR_QUERYING_H
 
+#include <filesystem>
 #include <vulkan/vulkan.hpp>
 #include <overeditor/graphics/queue_families.h>
 #include <overeditor/graphics/requirements.h>
@@ -115,6 +116,30 @@ namespace overeditor::graphics {
         const SwapchainSupportDetails &getSwapchainSupportDetails() const;
     };
 
+    /**
+     * Identifies the device elected by a previous run, so the next one can skip scoring every candidate.
+     * A driver update invalidates it.
+     */
+    class ElectedDeviceRecord {
+    private:
+        uint32_t vendorID;
+        uint32_t deviceID;
+        uint32_t driverVersion;
+    public:
+        ElectedDeviceRecord();
+
+        explicit ElectedDeviceRecord(const vk::PhysicalDeviceProperties &properties);
+
+        /**
+         * Returns false if there is no record or it couldn't be read
+         */
+        static bool load(const std::filesystem::path &path, ElectedDeviceRecord &record);
+
+        void save(const std::filesystem::path &path) const;
+
+        bool matches(const vk::PhysicalDeviceProperties &properties) const;
+    };
+
 
 }
 #endif
\ No newline at end of file
@@ -5,6 +5,7 @@
 #ifndef OVEREDITOR_QUEUE_CONTEXT_H
 #define OVEREDITOR_QUEUE_CONTEXT_H
 
+#include <mutex>
 #include <vulkan/vulkan.hpp>
 #include <overeditor/graphics/queue_families.h>
 
@@ -12,13 +13,19 @@ namespace overeditor::graphics {
     class QueueContext {
     private:
         QueueFamilyIndices familyIndices;
-        vk::Queue graphicsQueue, presentationQueue;
+        vk::Queue graphicsQueue, presentationQueue, computeQueue;
+        uint32_t computeIndex;
+        mutable std::mutex graphicsMutex, presentationMutex, computeMutex;
     public:
+        /**
+         * computeIndex is the graphics family when the device has no async compute family
+         */
         QueueContext(
                 const vk::Device &device,
                 const QueueFamilyIndices &qIndices,
                 uint32_t graphicsIndex,
-                uint32_t presentationIndex
+                uint32_t presentationIndex,
+                uint32_t computeIndex
         );
 
         const QueueFamilyIndices &getFamilyIndices() const;
@@ -26,6 +33,25 @@ namespace overeditor::graphics {
         const vk::Queue &getGraphicsQueue() const;
 
         const vk::Queue &getPresentationQueue() const;
+
+        /**
+         * The async compute queue, or the graphics queue if the device has none
+         */
+        const vk::Queue &getComputeQueue() const;
+
+        uint32_t getComputeFamilyIndex() const;
+
+        /**
+         * Whether compute work runs on a queue of its own, concurrently with graphics
+         */
+        bool hasAsyncCompute() const;
+
+        /**
+         * Locks one of the queues for a submission, a presentation or a wait, which Vulkan requires to be externally
+         * synchronized. Queues that are the same VkQueue share their lock, so a compute pass without a family of its
+         * own can submit from another thread than the graphics work.
+         */
+        std::unique_lock<std::mutex> lock(const vk::Queue &queue) const;
     };
 }
 #endif //OVEREDITOR_QUEUE_CONTEXT_H
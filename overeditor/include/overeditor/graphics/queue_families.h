@@ -53,10 +53,27 @@ namespace overeditor::graphics {
         ) override;
     };
 
+    /**
+     * A compute family without graphics support, whose queues run alongside the graphics queue instead of
+     * sharing it. Absent on devices that don't expose one.
+     */
+    class AsyncComputeQueueFamily : public QueueFamily {
+    public:
+        AsyncComputeQueueFamily();
+
+        void offer(
+                uint32_t index,
+                const vk::QueueFamilyProperties &properties,
+                const vk::PhysicalDevice &device,
+                const vk::SurfaceKHR &surface
+        ) override;
+    };
+
     class QueueFamilyIndices {
     private:
         FlagBitQueueFamily graphics;
         PresentationQueueFamily presentation;
+        AsyncComputeQueueFamily compute;
     public:
         QueueFamilyIndices();
 
@@ -70,6 +87,8 @@ namespace overeditor::graphics {
         const QueueFamily &getGraphics() const;
 
         const PresentationQueueFamily &getPresentation() const;
+
+        const AsyncComputeQueueFamily &getCompute() const;
     };
 }
 #endif
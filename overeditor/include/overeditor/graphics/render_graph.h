@@ -0,0 +1,203 @@
+#ifndef OVEREDITOR_RENDER_GRAPH_H
+#define OVEREDITOR_RENDER_GRAPH_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <overeditor/graphics/device_context.h>
+
+namespace overeditor::graphics {
+
+    /**
+     * How a pass uses an image, which decides the layout it must be in and the stages and accesses that touch it
+     */
+    enum RenderGraphUsage : uint8_t {
+        eGraphColorAttachment,
+        eGraphDepthAttachment,
+        /**
+         * Depth tested without being written
+         */
+        eGraphDepthReadOnly,
+        eGraphSampled,
+        eGraphTransferSource,
+        eGraphTransferDestination
+    };
+
+    struct RenderGraphStatistics {
+        size_t passes = 0;
+        size_t culledPasses = 0;
+        /**
+         * Image barriers and pipeline barrier commands recorded on every execution, including final transitions
+         */
+        size_t imageBarriers = 0;
+        size_t pipelineBarriers = 0;
+        size_t transientImages = 0;
+        /**
+         * Memory allocated for the transient images, and what they would take without aliasing
+         */
+        vk::DeviceSize transientBytes = 0;
+        vk::DeviceSize unaliasedBytes = 0;
+    };
+
+    /**
+     * Passes declare the images they read and write, and compile works out the rest: passes whose results are never
+     * used are culled, each pass gets the smallest set of barriers and layout transitions it needs batched into a
+     * single pipeline barrier, and images created by the graph share memory with the ones whose lifetimes don't
+     * overlap theirs.
+     *
+     * Passes run in the order they are added, and record their own commands, render passes included. Render passes
+     * must keep their attachments in the layout of their usage from start to end, the graph transitions them.
+     *
+     * Images created by the graph only live within an execution and start with undefined contents. They are shared
+     * by every execution, so executions must not overlap on the GPU.
+     */
+    class RenderGraph {
+    public:
+        typedef std::function<void(const vk::CommandBuffer &commandBuffer, uint32_t imageIndex)> Recorder;
+
+    private:
+        struct Resource {
+            std::string name;
+            vk::Format format;
+            vk::Extent2D extent;
+            vk::ImageAspectFlags aspect;
+            bool transient;
+            // Imported images, one for every image index or a single one for all of them
+            std::vector<vk::Image> images;
+            vk::ImageLayout initialLayout, finalLayout;
+            vk::Semaphore semaphore;
+            vk::PipelineStageFlags waitStage;
+            // Created by compile for transients
+            vk::ImageUsageFlags usage;
+            vk::Image image;
+            vk::ImageView view;
+            uint32_t memory;
+            vk::DeviceSize offset, size;
+            // Passes the resource is used by, first and last ones
+            uint32_t firstPass, lastPass;
+        };
+
+        struct Access {
+            uint32_t resource;
+            RenderGraphUsage usage;
+            bool write;
+        };
+
+        struct Barrier {
+            uint32_t resource;
+            vk::AccessFlags sourceAccess, destinationAccess;
+            vk::ImageLayout oldLayout, newLayout;
+        };
+
+        struct Pass {
+            std::string name;
+            Recorder recorder;
+            std::vector<Access> accesses;
+            bool culled;
+            std::vector<Barrier> barriers;
+            vk::PipelineStageFlags sourceStages, destinationStages;
+        };
+
+        const DeviceContext *context;
+        std::vector<Resource> resources;
+        std::vector<Pass> passes;
+        std::vector<vk::DeviceMemory> memories;
+        // Transitions of the imported images into their final layout, after the last pass
+        std::vector<Barrier> finalBarriers;
+        vk::PipelineStageFlags finalSourceStages;
+        bool compiled;
+        RenderGraphStatistics statistics;
+
+        void cull();
+
+        void allocateTransients();
+
+        void computeBarriers();
+
+        void recordBarriers(
+                const vk::CommandBuffer &commandBuffer,
+                uint32_t imageIndex,
+                const std::vector<Barrier> &barriers,
+                vk::PipelineStageFlags sourceStages,
+                vk::PipelineStageFlags destinationStages
+        ) const;
+
+        const vk::Image &getImage(uint32_t resource, uint32_t imageIndex) const;
+
+    public:
+        explicit RenderGraph(const DeviceContext &context);
+
+        RenderGraph(const RenderGraph &) = delete;
+
+        RenderGraph &operator=(const RenderGraph &) = delete;
+
+        /**
+         * Adds an image owned by someone else, either one per image index or a single one.
+         * Images with a final layout are the results of the graph and are transitioned into it after the last pass,
+         * the others are only kept for as long as a pass reads them. When a semaphore is given, the submission must
+         * wait on it at the stage getWaits reports, before the image's first use.
+         */
+        uint32_t importImage(
+                const std::string &name,
+                const std::vector<vk::Image> &images,
+                vk::Format format,
+                vk::ImageLayout initialLayout,
+                vk::ImageLayout finalLayout,
+                const vk::Semaphore &semaphore = nullptr
+        );
+
+        /**
+         * Adds an image created and owned by the graph, used only within an execution
+         */
+        uint32_t createImage(const std::string &name, vk::Format format, vk::Extent2D extent);
+
+        /**
+         * Adds a pass run after every pass added so far, returns its index
+         */
+        uint32_t addPass(const std::string &name, const Recorder &recorder);
+
+        /**
+         * Declares that the pass depends on the image's current contents
+         */
+        void read(uint32_t pass, uint32_t resource, RenderGraphUsage usage);
+
+        /**
+         * Declares that the pass writes the image, a pass that both reads and writes it declares both
+         */
+        void write(uint32_t pass, uint32_t resource, RenderGraphUsage usage);
+
+        /**
+         * Culls the passes, creates the transient images and computes the barriers.
+         * Nothing can be added afterwards until the graph is disposed.
+         */
+        void compile();
+
+        /**
+         * Records every pass that wasn't culled, with its barriers.
+         */
+        void record(const vk::CommandBuffer &commandBuffer, uint32_t imageIndex) const;
+
+        /**
+         * Appends the semaphores of the imported images and the stages the submission must wait on them at
+         */
+        void getWaits(std::vector<vk::Semaphore> &semaphores, std::vector<vk::PipelineStageFlags> &stages) const;
+
+        /**
+         * View of a transient image, valid once compiled
+         */
+        const vk::ImageView &getView(uint32_t resource) const;
+
+        bool isCulled(uint32_t pass) const;
+
+        const RenderGraphStatistics &getStatistics() const;
+
+        /**
+         * Frees the transient images and forgets every pass and resource, must be called before the device is
+         * destroyed.
+         */
+        void dispose();
+    };
+}
+#endif
@@ -0,0 +1,46 @@
+#ifndef OVEREDITOR_RENDER_TARGET_H
+#define OVEREDITOR_RENDER_TARGET_H
+
+#include <vulkan/vulkan.hpp>
+#include <overeditor/graphics/device_context.h>
+
+namespace overeditor::graphics {
+
+    /**
+     * A color image with its own framebuffer, rendered to offscreen and copied into the swapchain image afterwards.
+     * The depth attachment comes from whoever renders into it.
+     */
+    class RenderTarget {
+    private:
+        const DeviceContext *context;
+        vk::Extent2D extent;
+        vk::Image image;
+        vk::DeviceMemory memory;
+        vk::ImageView view;
+        vk::Framebuffer framebuffer;
+    public:
+        RenderTarget(const DeviceContext &context, vk::Format format, vk::Extent2D extent);
+
+        RenderTarget(const RenderTarget &) = delete;
+
+        RenderTarget &operator=(const RenderTarget &) = delete;
+
+        /**
+         * Frees the image, must be called before the device is destroyed.
+         */
+        void dispose();
+
+        /**
+         * Replaces the framebuffer. The render pass must have a color attachment of the target's format followed by
+         * a depth attachment, the depth view must be as large as the target.
+         */
+        void createFramebuffer(const vk::RenderPass &renderPass, const vk::ImageView &depthView);
+
+        const vk::Extent2D &getExtent() const;
+
+        const vk::Image &getImage() const;
+
+        const vk::Framebuffer &getFramebuffer() const;
+    };
+}
+#endif
@@ -0,0 +1,244 @@
+#ifndef OVEREDITOR_RESOURCE_REGISTRY_H
+#define OVEREDITOR_RESOURCE_REGISTRY_H
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <overeditor/graphics/device_context.h>
+
+namespace overeditor::graphics {
+
+    /**
+     * Memory may be null for a buffer or image bound to memory the registry doesn't own
+     */
+    struct BufferResource {
+        vk::Buffer buffer;
+        vk::DeviceMemory memory;
+    };
+
+    struct ImageResource {
+        vk::Image image;
+        vk::ImageView view;
+        vk::DeviceMemory memory;
+    };
+
+    /**
+     * The layout is destroyed with the pipeline unless it's null
+     */
+    struct PipelineResource {
+        vk::Pipeline pipeline;
+        vk::PipelineLayout layout;
+    };
+
+    /**
+     * Refers to a resource of the registry. The generation changes every time its slot is released, so a handle kept
+     * after its resource was released is stale instead of referring to whatever took the slot next.
+     * A default constructed handle is null.
+     */
+    template<typename T>
+    struct ResourceHandle {
+        uint32_t index = 0;
+        uint32_t generation = 0;
+
+        bool isNull() const {
+            return generation == 0;
+        }
+
+        bool operator==(const ResourceHandle &other) const {
+            return index == other.index && generation == other.generation;
+        }
+
+        bool operator!=(const ResourceHandle &other) const {
+            return !(*this == other);
+        }
+    };
+
+    typedef ResourceHandle<BufferResource> BufferHandle;
+    typedef ResourceHandle<ImageResource> ImageHandle;
+    typedef ResourceHandle<PipelineResource> PipelineHandle;
+
+    /**
+     * Owns GPU resources that frames in flight may still use, and destroys them only once the GPU is done with them.
+     *
+     * A resource released during a frame, the one getFrame returns, may have been used by any frame submitted up to
+     * then, and is destroyed when retire is called with that frame or a later one. Work submitted to the graphics
+     * queue before a frame, like texture uploads, is covered by its retirement as well. Meshes and
+     * textures can be released in the middle of streaming, while frames still use them.
+     *
+     * Thread safe.
+     */
+    class ResourceRegistry {
+    private:
+        template<typename T>
+        struct Pool {
+            struct Slot {
+                T resource;
+                // Starts at 1 so the null handle never matches
+                uint32_t generation;
+            };
+
+            std::vector<Slot> slots;
+            std::vector<uint32_t> available;
+            // Released resources with the frame they were released during, in release order
+            std::deque<std::pair<uint64_t, T>> pending;
+            uint64_t version = 0;
+        };
+
+        const DeviceContext *context;
+        mutable std::mutex mutex;
+        std::tuple<
+                Pool<BufferResource>,
+                Pool<ImageResource>,
+                Pool<PipelineResource>
+        > pools;
+        uint64_t frame;
+        uint64_t retiredFrame;
+
+        template<typename T>
+        Pool<T> &getPool() {
+            return std::get<Pool<T>>(pools);
+        }
+
+        template<typename T>
+        const Pool<T> &getPool() const {
+            return std::get<Pool<T>>(pools);
+        }
+
+        template<typename T>
+        bool isCurrent(const Pool<T> &pool, const ResourceHandle<T> &handle) const {
+            return !handle.isNull() && handle.index < pool.slots.size() &&
+                   pool.slots[handle.index].generation == handle.generation;
+        }
+
+        template<typename T>
+        void collect(Pool<T> &pool, uint64_t retired) {
+            while (!pool.pending.empty() && pool.pending.front().first <= retired) {
+                destroy(pool.pending.front().second);
+                pool.pending.pop_front();
+            }
+        }
+
+        void destroy(const BufferResource &resource);
+
+        void destroy(const ImageResource &resource);
+
+        void destroy(const PipelineResource &resource);
+
+    public:
+        explicit ResourceRegistry(const DeviceContext &context);
+
+        ResourceRegistry(const ResourceRegistry &) = delete;
+
+        ResourceRegistry &operator=(const ResourceRegistry &) = delete;
+
+        /**
+         * Destroys every resource, released or not. The device must be idle.
+         */
+        void dispose();
+
+        /**
+         * Takes ownership of the resource
+         */
+        template<typename T>
+        ResourceHandle<T> add(const T &resource) {
+            std::lock_guard<std::mutex> lock(mutex);
+            Pool<T> &pool = getPool<T>();
+            ResourceHandle<T> handle;
+            if (pool.available.empty()) {
+                handle.index = (uint32_t) pool.slots.size();
+                pool.slots.push_back({resource, 1});
+            } else {
+                handle.index = pool.available.back();
+                pool.available.pop_back();
+                pool.slots[handle.index].resource = resource;
+            }
+            handle.generation = pool.slots[handle.index].generation;
+            pool.version++;
+            return handle;
+        }
+
+        /**
+         * Copies the resource out, returns false if the handle is null or stale
+         */
+        template<typename T>
+        bool get(const ResourceHandle<T> &handle, T &resource) const {
+            std::lock_guard<std::mutex> lock(mutex);
+            const Pool<T> &pool = getPool<T>();
+            if (!isCurrent(pool, handle)) {
+                return false;
+            }
+            resource = pool.slots[handle.index].resource;
+            return true;
+        }
+
+        /**
+         * Incremented whenever a resource of the type is added or released. Command buffers recorded with resources
+         * resolved from handles of the type may refer to destroyed ones once it changed, and must be recorded again.
+         */
+        template<typename T>
+        uint64_t getVersion() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            return getPool<T>().version;
+        }
+
+        template<typename T>
+        bool isAlive(const ResourceHandle<T> &handle) const {
+            std::lock_guard<std::mutex> lock(mutex);
+            return isCurrent(getPool<T>(), handle);
+        }
+
+        /**
+         * Invalidates the handle and queues its resource for destruction. Null and stale handles are ignored.
+         */
+        template<typename T>
+        void release(const ResourceHandle<T> &handle) {
+            std::lock_guard<std::mutex> lock(mutex);
+            Pool<T> &pool = getPool<T>();
+            if (!isCurrent(pool, handle)) {
+                return;
+            }
+            auto &slot = pool.slots[handle.index];
+            pool.pending.emplace_back(frame, slot.resource);
+            slot.resource = T();
+            if (++slot.generation == 0) {
+                slot.generation = 1;
+            }
+            pool.available.push_back(handle.index);
+            pool.version++;
+        }
+
+        /**
+         * Queues a resource that was never added for destruction, like release
+         */
+        template<typename T>
+        void defer(const T &resource) {
+            std::lock_guard<std::mutex> lock(mutex);
+            getPool<T>().pending.emplace_back(frame, resource);
+        }
+
+        /**
+         * The frame being recorded, which the resources released now are queued with
+         */
+        uint64_t getFrame() const;
+
+        /**
+         * Must be called once the work of the frame was submitted. Returns its number and starts the next one.
+         */
+        uint64_t endFrame();
+
+        /**
+         * Destroys what was released up to the given frame, once the GPU finished it and every frame before it
+         */
+        void retire(uint64_t frame);
+
+        /**
+         * Resources released and not destroyed yet
+         */
+        size_t getPendingCount() const;
+    };
+}
+#endif
@@ -6,7 +6,10 @@
 #include <filesystem>
 #include <fstream>
 #include <string>
+#include <unordered_map>
 #include <overeditor/graphics/device_context.h>
+#include <overeditor/graphics/resource_registry.h>
+#include <overeditor/graphics/buffers/vertices.h>
 
 namespace overeditor::graphics::shaders {
     class ShaderSource {
@@ -17,12 +20,59 @@ namespace overeditor::graphics::shaders {
                 const std::filesystem::path &filepath
         );
 
-        vk::ShaderModule createModuleFor(const vk::Device &device);
+        vk::ShaderModule createModuleFor(const vk::Device &device) const;
 
     };
 
+    /**
+     * Every compiled shader of a directory, read up front so it can happen off the main thread.
+     */
+    class ShaderLibrary {
+    private:
+        std::unordered_map<std::string, ShaderSource> sources;
+    public:
+        ShaderLibrary();
+
+        /**
+         * Reads every .spv file of the directory, keyed by file name
+         */
+        void load(const std::filesystem::path &directory);
+
+        bool contains(const std::string &name) const;
+
+        const ShaderSource &get(const std::string &name) const;
+
+        size_t size() const;
+    };
+
 #define PIPELINE_NAME "main"
 
+    /**
+     * How a pipeline uses the depth attachment of its subpass
+     */
+    enum DepthUsage : uint8_t {
+        /**
+         * Tests against and writes depth, for a pass drawn without a prepass. Also what drawables without a prepass
+         * pipeline use in the color subpass after a prepass.
+         */
+        eDepthTestWrite,
+        /**
+         * Only writes depth, without a fragment stage or color output, for the prepass subpass
+         */
+        eDepthPrepass,
+        /**
+         * Shades only the fragments the prepass left in front, with an equal test and no depth writes, for the color
+         * subpass after a prepass
+         */
+        eDepthAfterPrepass
+    };
+
+    /**
+     * A graphics pipeline for a render pass subpass. Without a pipeline layout, an empty one is created and owned by
+     * the shader, the layout given is used as is otherwise and must outlive it.
+     * The vertices are read from binding 0 with the given geometry layout, without one the pipeline has no vertex
+     * input and the vertex shader must make up its vertices.
+     */
     class Shader {
     private:
         const vk::Device *owner;
@@ -30,6 +80,10 @@ namespace overeditor::graphics::shaders {
         vk::ShaderModule fragModule, vertModule;
         vk::Pipeline pipeline;
         vk::PipelineLayout layout;
+        // False when the layout was given to initialize
+        bool ownsLayout;
+        // Null until the pipeline is added to a registry, which owns it from then on
+        PipelineHandle handle;
     public:
         Shader();
 
@@ -39,15 +93,50 @@ namespace overeditor::graphics::shaders {
                 const DeviceContext &deviceCtx,
                 const vk::RenderPass &renderPass,
                 const std::filesystem::path &fragmentPath,
-                const std::filesystem::path &vertexPath
+                const std::filesystem::path &vertexPath,
+                const vk::PipelineCache &cache = vk::PipelineCache(),
+                DepthUsage depthUsage = eDepthTestWrite,
+                uint32_t subpass = 0,
+                const vk::PipelineLayout &pipelineLayout = vk::PipelineLayout(),
+                const GeometryLayout *geometryLayout = nullptr
         );
 
+        void initialize(
+                const DeviceContext &deviceCtx,
+                const vk::RenderPass &renderPass,
+                const ShaderSource &fragmentSource,
+                const ShaderSource &vertexSource,
+                const vk::PipelineCache &cache = vk::PipelineCache(),
+                DepthUsage depthUsage = eDepthTestWrite,
+                uint32_t subpass = 0,
+                const vk::PipelineLayout &pipelineLayout = vk::PipelineLayout(),
+                const GeometryLayout *geometryLayout = nullptr
+        );
+
+        /**
+         * Adds the pipeline, and the layout if the shader owns it, to the registry and returns the handle drawables
+         * refer to it with. Adding it again returns the same handle.
+         */
+        const PipelineHandle &registerPipeline(ResourceRegistry &registry);
+
+        /**
+         * Hands the pipeline, and the layout if the shader owns it, to the registry so they are destroyed once the
+         * frames drawing with them retired. A registered pipeline is released, which makes the drawables using it
+         * skip their draws. The destructor destroys an unregistered pipeline right away, which is only safe once the
+         * device is idle.
+         */
+        void dispose(ResourceRegistry &registry);
+
         ShaderSource *getFragment() const;
 
         ShaderSource *getVertex() const;
 
         const vk::Pipeline &getPipeline() const;
 
+        const PipelineHandle &getHandle() const;
+
+        const vk::PipelineLayout &getLayout() const;
+
     };
 
     class ShaderInstance {
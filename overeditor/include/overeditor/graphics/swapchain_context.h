@@ -15,6 +15,7 @@ namespace overeditor::graphics {
         std::vector<ImageContext> swapchainImages;
         vk::Format swapchainFormat;
         vk::Extent2D swapchainExtent;
+        vk::ImageUsageFlags imageUsage;
         const vk::Device *devicePtr;
     public:
 
@@ -35,6 +36,11 @@ namespace overeditor::graphics {
 
         const vk::Extent2D &getSwapchainExtent() const;
 
+        /**
+         * Always includes color attachment, and transfer destination where the surface supports it
+         */
+        vk::ImageUsageFlags getImageUsage() const;
+
         const vk::Device *getDevicePtr() const;
 
     };
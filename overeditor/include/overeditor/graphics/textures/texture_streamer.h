@@ -0,0 +1,198 @@
+#ifndef OVEREDITOR_TEXTURE_STREAMER_H
+#define OVEREDITOR_TEXTURE_STREAMER_H
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <overeditor/graphics/device_context.h>
+#include <overeditor/graphics/resource_registry.h>
+#include <overeditor/utility/worker_thread.h>
+
+namespace overeditor::graphics::textures {
+
+    class TextureDescription {
+    private:
+        vk::Format format;
+        uint32_t width, height, mipCount;
+        /**
+         * Size in bytes of a single block, and the width/height in texels a block covers.
+         * Uncompressed formats use a block extent of 1, BCn formats use 4.
+         */
+        uint32_t blockSize, blockExtent;
+    public:
+        TextureDescription(
+                vk::Format format,
+                uint32_t width,
+                uint32_t height,
+                uint32_t mipCount,
+                uint32_t blockSize,
+                uint32_t blockExtent = 1
+        );
+
+        vk::Format getFormat() const;
+
+        uint32_t getWidth() const;
+
+        uint32_t getHeight() const;
+
+        uint32_t getMipCount() const;
+
+        vk::Extent3D getMipExtent(uint32_t level) const;
+
+        vk::DeviceSize getMipSize(uint32_t level) const;
+    };
+
+    /**
+     * Provides the texel data of a texture, one mip level at a time.
+     * loadMip is always called from the streaming worker thread.
+     */
+    class TextureSource {
+    public:
+        virtual ~TextureSource() = default;
+
+        virtual const TextureDescription &getDescription() const = 0;
+
+        virtual std::vector<uint8_t> loadMip(uint32_t level) = 0;
+    };
+
+    typedef uint32_t TextureHandle;
+
+    struct TextureStreamingSettings {
+        /**
+         * Maximum amount of device memory resident textures may occupy
+         */
+        vk::DeviceSize budget = 512ULL * 1024 * 1024;
+        /**
+         * Maximum amount of texel data uploaded in a single frame
+         */
+        vk::DeviceSize uploadBytesPerFrame = 8ULL * 1024 * 1024;
+        /**
+         * Mips whose largest side is at most this size are always resident
+         */
+        uint32_t residentMipExtent = 64;
+    };
+
+    struct TextureStreamingStatistics {
+        vk::DeviceSize residentBytes = 0;
+        vk::DeviceSize uploadedBytes = 0;
+        vk::DeviceSize evictedBytes = 0;
+        size_t pendingLoads = 0;
+        size_t textureCount = 0;
+    };
+
+    /**
+     * Keeps a budgeted subset of every texture's mip chain resident in device memory.
+     *
+     * Textures start with only their low mips. Finer mips are requested from the texel density recorded with
+     * recordTexelDensity, read from their TextureSource on a worker thread and uploaded on the graphics queue, at
+     * most uploadBytesPerFrame per frame. When an upload would exceed the budget, the streamed mips of the least
+     * recently used textures are evicted first.
+     */
+    class TextureStreamer {
+    private:
+        struct StreamedTexture {
+            std::shared_ptr<TextureSource> source;
+            // Owns the image, view and memory, which are copied out of it to avoid locking the registry on lookups
+            ImageHandle resource;
+            vk::Image image;
+            vk::ImageView view;
+            vk::DeviceSize residentBytes;
+            // Finest resident mip, equal to the mip count when nothing is resident
+            uint32_t residentBase;
+            // Coarsest mip that must always be resident
+            uint32_t minimumBase;
+            float texelDensity;
+            uint64_t lastUsedFrame;
+            bool loading;
+        };
+
+        struct MipLoad {
+            TextureHandle handle;
+            uint32_t base;
+            std::vector<std::vector<uint8_t>> mips;
+            // Already failed to find room in the budget, kept until it does
+            bool waitingForRoom = false;
+        };
+
+        const DeviceContext *context;
+        // Owns the images, and destroys the ones replaced by a relocation once the upload and the frames sampling
+        // them finished
+        ResourceRegistry *resources;
+        TextureStreamingSettings settings;
+        TextureStreamingStatistics statistics;
+        std::vector<StreamedTexture> textures;
+        uint64_t frame;
+        // Upload batch
+        vk::CommandPool uploadPool;
+        vk::CommandBuffer uploadBuffer;
+        vk::Fence uploadFence;
+        bool uploadInFlight;
+        vk::Buffer staging;
+        vk::DeviceMemory stagingMemory;
+        vk::DeviceSize stagingCapacity;
+        uint8_t *stagingData;
+        // Loads finished by the worker, waiting for upload
+        std::mutex completedMutex;
+        std::deque<MipLoad> completed;
+        utility::WorkerThread worker;
+
+        void retireFinishedUpload();
+
+        void requestLoad(TextureHandle handle, uint32_t base);
+
+        void ensureStagingCapacity(vk::DeviceSize capacity);
+
+        bool makeRoom(vk::DeviceSize bytes, TextureHandle requester);
+
+        void relocate(StreamedTexture &texture, uint32_t newBase, const MipLoad *load, vk::DeviceSize stagingOffset);
+
+    public:
+        TextureStreamer(
+                const DeviceContext &context,
+                ResourceRegistry &resources,
+                const TextureStreamingSettings &settings = TextureStreamingSettings()
+        );
+
+        TextureStreamer(const TextureStreamer &) = delete;
+
+        TextureStreamer &operator=(const TextureStreamer &) = delete;
+
+        ~TextureStreamer();
+
+        TextureHandle add(const std::shared_ptr<TextureSource> &source);
+
+        /**
+         * Records that the texture was drawn this frame at the given density of mip 0 texels per screen pixel.
+         * The finest density recorded during a frame decides which mips are requested.
+         */
+        void recordTexelDensity(TextureHandle handle, float texelsPerPixel);
+
+        /**
+         * Issues new mip requests and uploads finished loads. Must be called once per frame.
+         */
+        void update();
+
+        size_t getTextureCount() const;
+
+        const TextureDescription &getDescription(TextureHandle handle) const;
+
+        bool isResident(TextureHandle handle) const;
+
+        /**
+         * The view covering every resident mip. It changes whenever the residency of the texture changes.
+         */
+        const vk::ImageView &getView(TextureHandle handle) const;
+
+        uint32_t getResidentBase(TextureHandle handle) const;
+
+        const TextureStreamingSettings &getSettings() const;
+
+        void setSettings(const TextureStreamingSettings &settings);
+
+        const TextureStreamingStatistics &getStatistics() const;
+    };
+}
+#endif
@@ -0,0 +1,76 @@
+#ifndef OVEREDITOR_TEXTURE_TABLE_H
+#define OVEREDITOR_TEXTURE_TABLE_H
+
+#include <cstdint>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <overeditor/graphics/device_context.h>
+#include <overeditor/graphics/textures/texture_streamer.h>
+
+/**
+ * Textures shaders can sample through the table, handles past it are drawn with the fallback
+ */
+#define TEXTURE_TABLE_CAPACITY 64
+
+namespace overeditor::graphics::textures {
+
+    /**
+     * The resident mips of every streamed texture, as an array of combined image samplers indexed by texture handle.
+     * Slots of textures with nothing resident yet, and the extra slot at the end of the array, hold a white 1x1
+     * fallback, so every slot is always valid.
+     */
+    class TextureTable {
+    private:
+        const DeviceContext *context;
+        vk::Sampler sampler;
+        vk::Image fallbackImage;
+        vk::DeviceMemory fallbackMemory;
+        vk::ImageView fallbackView;
+        vk::DescriptorSetLayout setLayout;
+        vk::DescriptorPool descriptorPool;
+        vk::DescriptorSet descriptorSet;
+        // View every slot was last written with
+        std::vector<vk::ImageView> views;
+        uint64_t version;
+
+        void createFallback();
+
+    public:
+        explicit TextureTable(const DeviceContext &context);
+
+        TextureTable(const TextureTable &) = delete;
+
+        TextureTable &operator=(const TextureTable &) = delete;
+
+        /**
+         * Frees the sampler, the fallback and the descriptor set, must be called before the device is destroyed.
+         */
+        void dispose();
+
+        /**
+         * Writes the slots whose texture changed residency since the last call, streamer may be null.
+         * Nothing may be reading the set, and the command buffers binding it must be recorded again when the version
+         * changed.
+         */
+        void update(const TextureStreamer *streamer);
+
+        /**
+         * Slot the shaders sample for the texture, the fallback's for handles past the table
+         */
+        static uint32_t getSlot(TextureHandle handle);
+
+        /**
+         * Layout of a set with the table as an array of TEXTURE_TABLE_CAPACITY + 1 combined image samplers at
+         * binding 0, seen by the fragment stage.
+         */
+        const vk::DescriptorSetLayout &getSetLayout() const;
+
+        const vk::DescriptorSet &getDescriptorSet() const;
+
+        /**
+         * Incremented whenever update rewrites a slot
+         */
+        uint64_t getVersion() const;
+    };
+}
+#endif
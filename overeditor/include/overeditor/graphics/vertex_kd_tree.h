@@ -0,0 +1,94 @@
+#ifndef OVEREDITOR_VERTEX_KD_TREE_H
+#define OVEREDITOR_VERTEX_KD_TREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include <overeditor/graphics/mesh_data.h>
+
+/**
+ * Ranges this small are tested linearly instead of being split further
+ */
+#define VERTEX_KD_TREE_LEAF_SIZE 8
+
+namespace overeditor::graphics {
+
+    struct VertexHit {
+        /**
+         * Index of the vertex in MeshData::positions
+         */
+        uint32_t vertex;
+        /**
+         * In the space of the query
+         */
+        float distance;
+        glm::vec3 position;
+    };
+
+    /**
+     * A balanced kd-tree over the vertices of one mesh, in the space of the mesh, for vertex snapping.
+     * The tree is implicit: the vertices are sorted so every range is split at its middle vertex.
+     * Immutable once built, so all instances of a mesh share it across threads.
+     */
+    class VertexKdTree {
+    private:
+        struct Search;
+
+        std::vector<glm::vec3> points;
+        // Index in MeshData::positions and split axis of every point, the axis is only used by middle vertices
+        std::vector<uint32_t> vertices;
+        std::vector<uint8_t> axes;
+
+        void build(size_t begin, size_t end);
+
+        void search(size_t begin, size_t end, Search &search) const;
+
+        void query(Search &search, std::vector<VertexHit> &result) const;
+
+    public:
+        explicit VertexKdTree(const MeshData &mesh);
+
+        /**
+         * Replaces result with the k vertices nearest to point within maxDistance, nearest first
+         */
+        void nearest(const glm::vec3 &point, size_t k, float maxDistance, std::vector<VertexHit> &result) const;
+
+        /**
+         * Same as nearest, for an instance of the mesh placed by world.
+         * The point, distances and positions are in world space, so non uniform scales are accounted for.
+         */
+        void nearest(
+                const glm::mat4 &world,
+                const glm::vec3 &point,
+                size_t k,
+                float maxDistance,
+                std::vector<VertexHit> &result
+        ) const;
+
+        /**
+         * Replaces result with every vertex within radius of point, nearest first
+         */
+        void withinRadius(const glm::vec3 &point, float radius, std::vector<VertexHit> &result) const;
+
+        /**
+         * Same as withinRadius, for an instance of the mesh placed by world, in world space
+         */
+        void withinRadius(
+                const glm::mat4 &world,
+                const glm::vec3 &point,
+                float radius,
+                std::vector<VertexHit> &result
+        ) const;
+
+        size_t size() const;
+
+        /**
+         * Bytes held by the arrays of the tree
+         */
+        size_t getMemorySize() const;
+    };
+
+    typedef MeshCache<VertexKdTree> VertexKdTreeCache;
+}
+#endif
@@ -5,6 +5,13 @@
 #include <vulkan/vulkan.h>
 #define PREFERRED_WIDTH 1920
 #define PREFERRED_HEIGHT 1080
+/**
+ * Directories relative to the working directory
+ */
+#define OVEREDITOR_RESOURCE_DIRECTORY "res"
+#define OVEREDITOR_CACHE_DIRECTORY ".cache"
+#define OVEREDITOR_PIPELINE_CACHE_FILE "pipeline_cache.bin"
+#define OVEREDITOR_ELECTED_DEVICE_FILE "elected_device"
 static std::vector<const char *> kRequiredInstanceExtensions = {
         // VK_KHR_SURFACE_EXTENSION_NAME  - Not included because is already included throught GLFW
 };
@@ -0,0 +1,75 @@
+#ifndef OVEREDITOR_AUTOSAVE_H
+#define OVEREDITOR_AUTOSAVE_H
+
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <entityx/entityx.h>
+#include <overeditor/scene/scene_format.h>
+#include <overeditor/utility/worker_thread.h>
+
+namespace overeditor::scene {
+
+    struct AutosaveStatistics {
+        /**
+         * Time spent on the main thread taking the last snapshot
+         */
+        double snapshotMilliseconds = 0;
+        /**
+         * Memory the last snapshot had to allocate, chunks shared with the previous snapshot excluded
+         */
+        size_t snapshotCopiedBytes = 0;
+        /**
+         * Time the worker spent compressing and writing the last completed save
+         */
+        double writeMilliseconds = 0;
+        uint64_t completedSaves = 0;
+    };
+
+    /**
+     * Periodically saves the scene without stalling the frame.
+     *
+     * At a frame boundary the components are gathered into an immutable snapshot whose unchanged chunks are shared
+     * with the previous snapshot, so only chunks edited since the last save are copied. With a format backed by the
+     * chunk storage, the chunk versions tell which chunks changed without reading the others. Compression and disk I/O
+     * then happen on a worker thread while editing continues, and only the chunks new to the snapshot are compressed.
+     */
+    class Autosave {
+    private:
+        const SceneFormat *format;
+        std::filesystem::path path;
+        float interval;
+        float elapsed;
+        SceneData previous;
+        // Only used by the worker, one save runs at a time
+        SceneChunkCache cache;
+        std::atomic<bool> saving;
+        std::mutex statisticsMutex;
+        AutosaveStatistics statistics;
+        utility::WorkerThread worker;
+    public:
+        Autosave(
+                const SceneFormat &format,
+                const std::filesystem::path &path,
+                float interval
+        );
+
+        /**
+         * Advances the autosave timer. Must be called at a frame boundary, when no system is modifying components.
+         */
+        void update(entityx::EntityManager &entities, float dt);
+
+        /**
+         * Snapshots the scene now and queues it to be written, unless a save is already in progress.
+         * Returns whether a save was queued.
+         */
+        bool saveNow(entityx::EntityManager &entities);
+
+        bool isSaving() const;
+
+        const std::filesystem::path &getPath() const;
+
+        AutosaveStatistics getStatistics();
+    };
+}
+#endif
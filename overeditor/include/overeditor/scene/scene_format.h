@@ -0,0 +1,248 @@
+#ifndef OVEREDITOR_SCENE_FORMAT_H
+#define OVEREDITOR_SCENE_FORMAT_H
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include <entityx/entityx.h>
+#include <overeditor/utility/thread_pool.h>
+
+#define SCENE_FOURCC(a, b, c, d) \
+    ((uint32_t) (a) | ((uint32_t) (b) << 8) | ((uint32_t) (c) << 16) | ((uint32_t) (d) << 24))
+#define SCENE_MAGIC SCENE_FOURCC('O', 'E', 'S', 'C')
+#define SCENE_VERSION 1
+/**
+ * Target uncompressed size of a single column chunk
+ */
+#define SCENE_CHUNK_SIZE (64 * 1024)
+
+namespace overeditor::storage {
+    class ChunkStorage;
+
+    class StorageChunk;
+}
+
+namespace overeditor::scene {
+
+    /**
+     * On-disk layout:
+     * [SceneFileHeader][chunk payloads...][SceneChunkEntry * chunkCount]
+     * A chunk payload holds rowCount scene entity ids (uint32) followed by rowCount components of one type,
+     * compressed independently of every other chunk. Ids only identify entities within the file, they needn't be
+     * dense.
+     */
+    struct SceneFileHeader {
+        uint32_t magic;
+        uint32_t version;
+        // Distinct ids among the rows, so never more than the rows of every chunk together
+        uint64_t entityCount;
+        uint64_t tocOffset;
+        uint32_t chunkCount;
+        uint32_t tocChecksum;
+    };
+
+    enum SceneChunkCompression : uint32_t {
+        eSceneChunkRaw = 0,
+        eSceneChunkLZ = 1
+    };
+
+    struct SceneChunkEntry {
+        uint32_t columnId;
+        uint32_t compression;
+        uint32_t elementSize;
+        uint32_t rowCount;
+        uint64_t offset;
+        uint64_t storedSize;
+        uint64_t rawSize;
+        // CRC32 of the stored (possibly compressed) bytes
+        uint32_t checksum;
+        uint32_t reserved;
+    };
+
+    static_assert(sizeof(SceneFileHeader) == 32, "Scene header layout changed");
+    static_assert(sizeof(SceneChunkEntry) == 48, "Scene chunk entry layout changed");
+
+    /**
+     * Rows of a single component type, by scene entity id, which is the index of the entity when it was saved.
+     * Chunks are immutable once built so they can be shared between snapshots.
+     */
+    struct ColumnChunk {
+        std::vector<uint32_t> rows;
+        std::vector<uint8_t> data;
+        // Storage chunk the rows were copied from and its version at the time, null if they weren't
+        const storage::StorageChunk *source = nullptr;
+        uint64_t sourceVersion = 0;
+    };
+
+    struct ColumnData {
+        uint32_t id;
+        uint32_t elementSize;
+        std::vector<std::shared_ptr<const ColumnChunk>> chunks;
+    };
+
+    struct SceneData {
+        std::vector<ColumnData> columns;
+    };
+
+    /**
+     * Chunks compressed by the last write, so chunks shared by consecutive snapshots are only compressed once.
+     */
+    struct SceneChunkCache {
+        struct Entry {
+            // Keeps the chunk alive so its address can't be reused by another chunk
+            std::shared_ptr<const ColumnChunk> chunk;
+            std::vector<uint8_t> stored;
+            SceneChunkEntry entry;
+        };
+
+        std::unordered_map<const ColumnChunk *, Entry> entries;
+    };
+
+    struct SceneStatistics {
+        uint64_t entityCount = 0;
+        uint64_t chunkCount = 0;
+        uint64_t rawBytes = 0;
+        uint64_t storedBytes = 0;
+        double milliseconds = 0;
+    };
+
+    /**
+     * Converts one component type between entityx and its column representation.
+     */
+    class ColumnSerializer {
+    public:
+        typedef std::function<void(entityx::Entity, const uint8_t *)> Visitor;
+        /**
+         * The entity loaded for a scene id, created the first time the id is seen
+         */
+        typedef std::function<entityx::Entity(uint32_t)> Resolver;
+
+        virtual ~ColumnSerializer() = default;
+
+        virtual uint32_t getId() const = 0;
+
+        virtual uint32_t getElementSize() const = 0;
+
+        /**
+         * Calls the visitor with the bytes of the component of every entity that has one.
+         */
+        virtual void gather(entityx::EntityManager &entities, const Visitor &visitor) const = 0;
+
+        /**
+         * Fills the column with the rows of every entity, sharing the chunks of the previous snapshot of the column
+         * whose content didn't change, and adds the size of the chunks it had to copy to copiedBytes.
+         * By default every row is gathered and the chunks built from them are compared with the previous ones.
+         */
+        virtual void snapshot(
+                entityx::EntityManager &entities,
+                const ColumnData *previous,
+                ColumnData &column,
+                size_t &copiedBytes
+        ) const;
+
+        virtual void scatter(entityx::Entity entity, const uint8_t *element, const Resolver &resolve) const = 0;
+    };
+
+    /**
+     * Serializes trivially copyable components by copying their bytes.
+     */
+    template<typename T>
+    class PodColumnSerializer : public ColumnSerializer {
+        static_assert(std::is_trivially_copyable<T>::value, "Pod columns require trivially copyable components");
+    private:
+        uint32_t id;
+    public:
+        explicit PodColumnSerializer(uint32_t id) : id(id) {}
+
+        uint32_t getId() const override {
+            return id;
+        }
+
+        uint32_t getElementSize() const override {
+            return sizeof(T);
+        }
+
+        void gather(entityx::EntityManager &entities, const Visitor &visitor) const override {
+            entityx::ComponentHandle<T> component;
+            for (entityx::Entity e : entities.entities_with_components(component)) {
+                visitor(e, reinterpret_cast<const uint8_t *>(component.get()));
+            }
+        }
+
+        void scatter(entityx::Entity entity, const uint8_t *element, const Resolver &resolve) const override {
+            T value;
+            std::memcpy(&value, element, sizeof(T));
+            entity.assign_from_copy<T>(value);
+        }
+    };
+
+    /**
+     * Binary, column oriented scene format.
+     * Files are memory mapped when loading, and their chunks are verified and decompressed in parallel before the
+     * entities are created. Chunks are compressed and decompressed on the pool, or on the calling thread without one.
+     */
+    class SceneFormat {
+    private:
+        std::vector<std::shared_ptr<ColumnSerializer>> serializers;
+        utility::ThreadPool *pool;
+
+        const ColumnSerializer *findSerializer(uint32_t id) const;
+
+        void forEachChunk(size_t count, const std::function<void(size_t)> &task) const;
+
+    public:
+        explicit SceneFormat(utility::ThreadPool *pool = nullptr);
+
+        /**
+         * Creates the format with every component OverEditor knows how to save: Transform and Parent.
+         * Drawable isn't saved, its pipelines and geometry only exist for the current device, so whatever loads a
+         * scene assigns the drawables from its assets again.
+         * With a storage, snapshots copy the transforms of the storage chunks changed since the previous snapshot
+         * instead of gathering and comparing all of them.
+         */
+        static SceneFormat createOverEditorFormat(
+                utility::ThreadPool *pool = nullptr,
+                const storage::ChunkStorage *storage = nullptr
+        );
+
+        void add(const std::shared_ptr<ColumnSerializer> &serializer);
+
+        /**
+         * Copies the serializable components of every entity into columns.
+         * When a previous gather is given, chunks whose content didn't change since are shared with it instead of
+         * being copied, and copiedBytes receives the size of the chunks that had to be copied.
+         */
+        SceneData gather(
+                entityx::EntityManager &entities,
+                const SceneData *previous = nullptr,
+                size_t *copiedBytes = nullptr
+        ) const;
+
+        /**
+         * Writes a gathered scene. When a cache is given, chunks it holds from the previous write aren't compressed
+         * again, and it is left holding the chunks of this write.
+         */
+        SceneStatistics write(
+                const std::filesystem::path &path,
+                const SceneData &data,
+                SceneChunkCache *cache = nullptr
+        ) const;
+
+        SceneStatistics save(const std::filesystem::path &path, entityx::EntityManager &entities) const;
+
+        /**
+         * Creates the entities stored in the file. When created is not null, it receives them in creation order.
+         */
+        SceneStatistics load(
+                const std::filesystem::path &path,
+                entityx::EntityManager &entities,
+                std::vector<entityx::Entity> *created = nullptr
+        ) const;
+    };
+}
+#endif
@@ -0,0 +1,105 @@
+#ifndef OVEREDITOR_ASYNC_LOG_APPENDER_H
+#define OVEREDITOR_ASYNC_LOG_APPENDER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+#include <thread>
+#include <plog/Log.h>
+
+/**
+ * Amount of records the ring holds, must be a power of two
+ */
+#define ASYNC_LOG_CAPACITY 1024
+/**
+ * Longest message kept, longer ones are truncated
+ */
+#define ASYNC_LOG_MESSAGE_LENGTH 232
+#define ASYNC_LOG_SITE_COUNT 1024
+/**
+ * Records a single call site may log per second before being suppressed
+ */
+#define ASYNC_LOG_SITE_RATE 32
+
+namespace overeditor::utility {
+
+    /**
+     * plog appender that moves formatting and console output off the calling thread.
+     *
+     * write only copies the record into a fixed size slot of a lock-free ring, a background thread formats and prints
+     * it. When the ring is full the record is dropped instead of blocking, and a call site (file and line) that logs
+     * more than ASYNC_LOG_SITE_RATE records in a second is suppressed until the next second. Both are counted and
+     * reported by the background thread. Fatal records are never suppressed and are flushed before write returns.
+     */
+    class AsyncLogAppender : public plog::IAppender {
+    private:
+        struct Slot {
+            std::atomic<size_t> sequence;
+            std::time_t time;
+            uint16_t milliseconds;
+            plog::Severity severity;
+            unsigned int tid;
+            size_t line;
+            const char *file;
+            plog::util::nchar message[ASYNC_LOG_MESSAGE_LENGTH];
+        };
+
+        struct Site {
+            std::atomic<uint32_t> second;
+            std::atomic<uint32_t> count;
+        };
+
+        Slot slots[ASYNC_LOG_CAPACITY];
+        Site sites[ASYNC_LOG_SITE_COUNT];
+        std::atomic<size_t> head;
+        // Only touched by the background thread
+        size_t tail;
+        std::atomic<size_t> consumed;
+        std::atomic<uint64_t> dropped;
+        std::atomic<uint64_t> suppressed;
+        std::atomic<bool> stopping;
+        std::mutex sleepMutex;
+        std::condition_variable wake;
+        std::thread thread;
+
+        bool admit(const plog::Record &record);
+
+        void print(const Slot &slot);
+
+        size_t drain();
+
+        void loop();
+
+    public:
+        AsyncLogAppender();
+
+        AsyncLogAppender(const AsyncLogAppender &) = delete;
+
+        AsyncLogAppender &operator=(const AsyncLogAppender &) = delete;
+
+        /**
+         * Prints every queued record before returning
+         */
+        ~AsyncLogAppender() override;
+
+        void write(const plog::Record &record) override;
+
+        /**
+         * Blocks until every record written so far has been printed
+         */
+        void flush();
+
+        /**
+         * Records lost because the ring was full
+         */
+        uint64_t getDroppedCount() const;
+
+        /**
+         * Records discarded by the per call site rate limit
+         */
+        uint64_t getSuppressedCount() const;
+    };
+}
+#endif
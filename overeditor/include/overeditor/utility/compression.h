@@ -0,0 +1,23 @@
+#ifndef OVEREDITOR_COMPRESSION_H
+#define OVEREDITOR_COMPRESSION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace overeditor::utility::compression {
+    /**
+     * Compresses a block with a byte-oriented LZ77 codec (LZ4-style sequences of literals and back-references).
+     * Blocks are independent of each other, so they can be decompressed in any order and on any thread.
+     */
+    std::vector<uint8_t> compress(const uint8_t *data, size_t size);
+
+    /**
+     * Decompresses a block produced by compress into exactly outputSize bytes.
+     * Throws if the block is malformed or doesn't decompress to outputSize bytes.
+     */
+    void decompress(const uint8_t *data, size_t size, uint8_t *output, size_t outputSize);
+
+    uint32_t crc32(const uint8_t *data, size_t size);
+}
+#endif
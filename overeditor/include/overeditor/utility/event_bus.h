@@ -0,0 +1,220 @@
+#ifndef OVEREDITOR_EVENT_BUS_H
+#define OVEREDITOR_EVENT_BUS_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#define EVENT_BUS_MAX_THREADS 64
+#define EVENT_BUS_MAX_TYPES 64
+/**
+ * Key of events that are never coalesced
+ */
+#define EVENT_BUS_NO_KEY UINT64_MAX
+
+namespace overeditor::utility {
+
+    struct EventBusStatistics {
+        /**
+         * Events published since the previous dispatch
+         */
+        size_t published = 0;
+        /**
+         * Events delivered by the last dispatch, after coalescing
+         */
+        size_t delivered = 0;
+    };
+
+    /**
+     * Typed, deferred event queue.
+     *
+     * Publishing appends to a buffer owned by the calling thread, so producers never lock or contend. Events are held
+     * until dispatch, which delivers every event type as a single batch to its listeners. Events published with the
+     * same key (usually an entity id) since the last dispatch are coalesced into the latest one, so a bulk edit
+     * touching an entity many times notifies listeners once.
+     *
+     * Dispatch must not run concurrently with publishing, it's meant to be called between frame phases. Events
+     * published by listeners during a dispatch are delivered by the next one.
+     */
+    class EventBus {
+    public:
+        typedef uint32_t SubscriptionId;
+    private:
+        class BaseChannel {
+        public:
+            virtual ~BaseChannel() = default;
+
+            virtual void dispatch(EventBusStatistics &statistics) = 0;
+        };
+
+        template<typename E>
+        class Channel : public BaseChannel {
+        public:
+            typedef std::function<void(const std::vector<E> &)> Listener;
+        private:
+            struct Record {
+                uint64_t key;
+                E event;
+            };
+
+            // Indexed by thread slot, only ever written by the owning thread
+            std::vector<Record> buffers[EVENT_BUS_MAX_THREADS];
+            // Used by threads beyond EVENT_BUS_MAX_THREADS
+            std::mutex overflowMutex;
+            std::vector<Record> overflow;
+            std::vector<std::pair<SubscriptionId, Listener>> listeners;
+            SubscriptionId nextSubscription;
+            std::vector<Record> pending;
+            std::vector<E> batch;
+            std::unordered_map<uint64_t, size_t> keyed;
+        public:
+            Channel() : overflowMutex(), overflow(), listeners(), nextSubscription(0), pending(), batch(), keyed() {}
+
+            void publish(uint32_t slot, uint64_t key, E &&event) {
+                if (slot < EVENT_BUS_MAX_THREADS) {
+                    buffers[slot].push_back(Record{key, std::move(event)});
+                    return;
+                }
+                std::lock_guard<std::mutex> lock(overflowMutex);
+                overflow.push_back(Record{key, std::move(event)});
+            }
+
+            SubscriptionId subscribe(Listener listener) {
+                SubscriptionId id = nextSubscription++;
+                listeners.emplace_back(id, std::move(listener));
+                return id;
+            }
+
+            void unsubscribe(SubscriptionId id) {
+                for (auto it = listeners.begin(); it != listeners.end(); ++it) {
+                    if (it->first == id) {
+                        listeners.erase(it);
+                        return;
+                    }
+                }
+            }
+
+            void dispatch(EventBusStatistics &statistics) override {
+                pending.clear();
+                for (auto &buffer : buffers) {
+                    pending.insert(
+                            pending.end(),
+                            std::make_move_iterator(buffer.begin()),
+                            std::make_move_iterator(buffer.end())
+                    );
+                    buffer.clear();
+                }
+                {
+                    std::lock_guard<std::mutex> lock(overflowMutex);
+                    pending.insert(
+                            pending.end(),
+                            std::make_move_iterator(overflow.begin()),
+                            std::make_move_iterator(overflow.end())
+                    );
+                    overflow.clear();
+                }
+                if (pending.empty()) {
+                    return;
+                }
+                batch.clear();
+                keyed.clear();
+                for (Record &record : pending) {
+                    if (record.key != EVENT_BUS_NO_KEY) {
+                        auto inserted = keyed.emplace(record.key, batch.size());
+                        if (!inserted.second) {
+                            batch[inserted.first->second] = std::move(record.event);
+                            continue;
+                        }
+                    }
+                    batch.push_back(std::move(record.event));
+                }
+                statistics.published += pending.size();
+                statistics.delivered += batch.size();
+                for (auto &listener : listeners) {
+                    listener.second(batch);
+                }
+            }
+        };
+
+        std::atomic<BaseChannel *> channels[EVENT_BUS_MAX_TYPES];
+        std::mutex channelMutex;
+        EventBusStatistics statistics;
+
+        static uint32_t nextTypeIndex();
+
+        template<typename E>
+        static uint32_t typeIndex() {
+            static uint32_t index = nextTypeIndex();
+            return index;
+        }
+
+        /**
+         * Small integer identifying the calling thread, assigned on first use
+         */
+        static uint32_t getThreadSlot();
+
+        template<typename E>
+        Channel<E> &channel() {
+            uint32_t index = typeIndex<E>();
+            BaseChannel *existing = channels[index].load(std::memory_order_acquire);
+            if (existing == nullptr) {
+                std::lock_guard<std::mutex> lock(channelMutex);
+                existing = channels[index].load(std::memory_order_acquire);
+                if (existing == nullptr) {
+                    existing = new Channel<E>();
+                    channels[index].store(existing, std::memory_order_release);
+                }
+            }
+            return *static_cast<Channel<E> *>(existing);
+        }
+
+    public:
+        EventBus();
+
+        EventBus(const EventBus &) = delete;
+
+        EventBus &operator=(const EventBus &) = delete;
+
+        ~EventBus();
+
+        /**
+         * Queues an event, coalesced with the other events of the same type and key queued since the last dispatch.
+         * Safe to call from any thread.
+         */
+        template<typename E>
+        void publish(uint64_t key, E event) {
+            channel<E>().publish(getThreadSlot(), key, std::move(event));
+        }
+
+        /**
+         * Queues an event that is never coalesced.
+         */
+        template<typename E>
+        void publish(E event) {
+            publish<E>(EVENT_BUS_NO_KEY, std::move(event));
+        }
+
+        template<typename E>
+        SubscriptionId subscribe(typename Channel<E>::Listener listener) {
+            return channel<E>().subscribe(std::move(listener));
+        }
+
+        template<typename E>
+        void unsubscribe(SubscriptionId id) {
+            channel<E>().unsubscribe(id);
+        }
+
+        /**
+         * Delivers every queued event.
+         */
+        void dispatch();
+
+        const EventBusStatistics &getStatistics() const;
+    };
+}
+#endif
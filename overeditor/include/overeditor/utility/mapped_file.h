@@ -0,0 +1,36 @@
+#ifndef OVEREDITOR_MAPPED_FILE_H
+#define OVEREDITOR_MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace overeditor::utility {
+    /**
+     * A read-only memory mapping of a whole file.
+     */
+    class MappedFile {
+    private:
+        const uint8_t *data;
+        size_t size;
+#ifdef _WIN32
+        void *fileHandle;
+        void *mappingHandle;
+#else
+        int descriptor;
+#endif
+    public:
+        explicit MappedFile(const std::filesystem::path &path);
+
+        MappedFile(const MappedFile &) = delete;
+
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        ~MappedFile();
+
+        const uint8_t *getData() const;
+
+        size_t getSize() const;
+    };
+}
+#endif
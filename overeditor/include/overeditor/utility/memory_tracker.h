@@ -0,0 +1,166 @@
+#ifndef OVEREDITOR_MEMORY_TRACKER_H
+#define OVEREDITOR_MEMORY_TRACKER_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+/**
+ * Fraction of a heap's budget past which a warning is logged, before the driver starts moving memory out of it.
+ * The warning is logged again only once usage went back under the clear ratio.
+ */
+#define MEMORY_BUDGET_WARNING_RATIO 0.9
+#define MEMORY_BUDGET_CLEAR_RATIO 0.8
+
+namespace overeditor::utility {
+
+    enum MemoryCategory : uint8_t {
+        eMemoryGeometry,
+        eMemoryTextures,
+        eMemoryStaging,
+        /**
+         * Depth buffers, render targets and the images of the render graph
+         */
+        eMemoryAttachments,
+        /**
+         * Instance matrices and uniforms, rewritten every frame
+         */
+        eMemoryFrameData,
+        eMemoryEcs,
+        /**
+         * Structures built from the meshes on the CPU, like their BVH and kd-tree
+         */
+        eMemoryAssetCache,
+        eMemoryCategoryCount
+    };
+
+    const char *getMemoryCategoryName(MemoryCategory category);
+
+    struct MemoryUsage {
+        uint64_t current = 0;
+        uint64_t peak = 0;
+        /**
+         * Allocations currently alive
+         */
+        uint64_t allocations = 0;
+    };
+
+    struct MemoryHeapBudget {
+        uint64_t size = 0;
+        bool deviceLocal = false;
+        /**
+         * Bytes allocated in the heap through the tracker
+         */
+        uint64_t tracked = 0;
+        /**
+         * What the process uses and may use of the heap according to VK_EXT_memory_budget. Without it, what was
+         * tracked and the size of the heap.
+         */
+        uint64_t usage = 0;
+        uint64_t budget = 0;
+    };
+
+    /**
+     * Attributes device allocations and large host allocations to a category, keeping their current and peak size,
+     * and follows the budget of every heap so streaming can stay under it.
+     *
+     * Allocations and frees may come from any thread. update and getHeapBudgets belong to the main thread.
+     */
+    class MemoryTracker {
+    private:
+        struct Counter {
+            std::atomic<uint64_t> current;
+            std::atomic<uint64_t> peak;
+            std::atomic<uint64_t> allocations;
+
+            Counter();
+
+            void add(uint64_t size);
+
+            void remove(uint64_t size);
+
+            MemoryUsage get() const;
+        };
+
+        struct Allocation {
+            uint64_t size;
+            uint32_t heap;
+            MemoryCategory category;
+        };
+
+        Counter device[eMemoryCategoryCount];
+        Counter host[eMemoryCategoryCount];
+        Counter heaps[VK_MAX_MEMORY_HEAPS];
+        mutable std::mutex mutex;
+        std::unordered_map<VkDeviceMemory, Allocation> allocations;
+        vk::PhysicalDevice physicalDevice;
+        vk::PhysicalDeviceMemoryProperties memoryProperties;
+        bool budgetSupported;
+        std::vector<MemoryHeapBudget> budgets;
+        // Heaps a warning was logged for and that didn't go back under the clear ratio since
+        std::vector<bool> warned;
+
+    public:
+        MemoryTracker();
+
+        MemoryTracker(const MemoryTracker &) = delete;
+
+        MemoryTracker &operator=(const MemoryTracker &) = delete;
+
+        /**
+         * Sets the device whose heaps are followed, budgetSupported if VK_EXT_memory_budget is enabled on it
+         */
+        void attach(
+                const vk::PhysicalDevice &physicalDevice,
+                const vk::PhysicalDeviceMemoryProperties &memoryProperties,
+                bool budgetSupported
+        );
+
+        void deviceAllocated(
+                const vk::DeviceMemory &memory,
+                vk::DeviceSize size,
+                uint32_t memoryType,
+                MemoryCategory category
+        );
+
+        /**
+         * Memory that wasn't allocated through the tracker is ignored
+         */
+        void deviceFreed(const vk::DeviceMemory &memory);
+
+        void hostAllocated(MemoryCategory category, uint64_t size);
+
+        void hostFreed(MemoryCategory category, uint64_t size);
+
+        /**
+         * Reads the heap budgets again and warns about the heaps getting close to theirs. Called once a frame.
+         */
+        void update();
+
+        MemoryUsage getDeviceUsage(MemoryCategory category) const;
+
+        MemoryUsage getHostUsage(MemoryCategory category) const;
+
+        /**
+         * As of the last update
+         */
+        const std::vector<MemoryHeapBudget> &getHeapBudgets() const;
+
+        /**
+         * Bytes the device local heaps can still take before reaching the warning ratio of their budget, as of the
+         * last update
+         */
+        uint64_t getDeviceHeadroom() const;
+
+        bool isBudgetSupported() const;
+
+        /**
+         * Logs the usage of every category and heap
+         */
+        void log() const;
+    };
+}
+#endif
@@ -0,0 +1,70 @@
+#ifndef OVEREDITOR_PHASE_PROFILER_H
+#define OVEREDITOR_PHASE_PROFILER_H
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace overeditor::utility {
+
+    struct PhaseTiming {
+        std::string name;
+        /**
+         * Milliseconds from the creation of the profiler to the start of the phase
+         */
+        double start;
+        double milliseconds;
+        std::thread::id thread;
+    };
+
+    /**
+     * Records how long named phases take, relative to when the profiler was created.
+     * Phases may run concurrently on different threads.
+     */
+    class PhaseProfiler {
+    private:
+        std::chrono::steady_clock::time_point origin;
+        mutable std::mutex mutex;
+        std::vector<PhaseTiming> phases;
+
+        double since(std::chrono::steady_clock::time_point time) const;
+
+    public:
+        /**
+         * Times a phase from its construction to its destruction
+         */
+        class Scope {
+        private:
+            PhaseProfiler *profiler;
+            std::string name;
+            std::chrono::steady_clock::time_point start;
+        public:
+            Scope(PhaseProfiler &profiler, std::string name);
+
+            Scope(const Scope &) = delete;
+
+            Scope &operator=(const Scope &) = delete;
+
+            ~Scope();
+        };
+
+        PhaseProfiler();
+
+        void record(const std::string &name, std::chrono::steady_clock::time_point start);
+
+        /**
+         * Milliseconds elapsed since the profiler was created
+         */
+        double getElapsed() const;
+
+        std::vector<PhaseTiming> getPhases() const;
+
+        /**
+         * Logs every recorded phase in the order they started
+         */
+        void log(const std::string &title) const;
+    };
+}
+#endif
@@ -1,7 +1,10 @@
 #ifndef OVEREDITOR_STEPFUNCTION_H
 #define OVEREDITOR_STEPFUNCTION_H
 
+#include <algorithm>
 #include <functional>
+#include <vector>
+#include <overeditor/utility/event_bus.h>
 
 namespace overeditor::utility {
     template<typename... T>
@@ -20,7 +23,7 @@ namespace overeditor::utility {
         }
 
         void operator-=(EventListener *listener) {
-            listeners.erase(std::remove(listeners.begin(), listeners.end(), listener));
+            listeners.erase(std::remove(listeners.begin(), listeners.end(), listener), listeners.end());
         }
 
         void operator()(T... args) {
@@ -35,11 +38,19 @@ namespace overeditor::utility {
     private:
         Event<T...> earlyStep;
         Event<T...> lateStep;
+        EventBus *eventBus;
     public:
-        StepFunction() : earlyStep(), lateStep() {
+        StepFunction() : earlyStep(), lateStep(), eventBus(nullptr) {
 
         }
 
+        /**
+         * Events queued on the bus are delivered at the end of each step
+         */
+        void setEventBus(EventBus *eventBus) {
+            StepFunction::eventBus = eventBus;
+        }
+
         void clear() {
             earlyStep.clear();
             lateStep.clear();
@@ -56,7 +67,13 @@ namespace overeditor::utility {
 
         void operator()(T... params) {
             earlyStep(params...);
+            if (eventBus != nullptr) {
+                eventBus->dispatch();
+            }
             lateStep(params...);
+            if (eventBus != nullptr) {
+                eventBus->dispatch();
+            }
         }
     };
 }
@@ -0,0 +1,104 @@
+#ifndef OVEREDITOR_THREAD_POOL_H
+#define OVEREDITOR_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace overeditor::utility {
+
+    /**
+     * A fixed set of worker threads, each with its own task deque.
+     * Workers pop their own most recently pushed task first, and steal the oldest task of another worker when they
+     * run out. Tasks submitted from outside the pool are spread over the workers.
+     */
+    class ThreadPool {
+    public:
+        typedef std::function<void()> Task;
+    private:
+        struct WorkQueue {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        std::vector<std::unique_ptr<WorkQueue>> queues;
+        std::atomic<size_t> pending;
+        std::atomic<size_t> nextQueue;
+        std::atomic<bool> stopping;
+        std::mutex sleepMutex;
+        std::condition_variable wake;
+        std::vector<std::thread> threads;
+
+        bool pop(size_t queue, Task &task);
+
+        bool steal(size_t thief, Task &task);
+
+        void loop(size_t index);
+
+    public:
+        /**
+         * Creates the pool with the given amount of workers, by default one less than the hardware threads so the
+         * main thread keeps a core.
+         */
+        explicit ThreadPool(size_t workerCount = 0);
+
+        ThreadPool(const ThreadPool &) = delete;
+
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        ~ThreadPool();
+
+        void submit(Task task);
+
+        /**
+         * Runs one pending task on the calling thread, if there is one.
+         * Threads waiting on other tasks call this so that nested waits can't starve the pool.
+         */
+        bool runPending();
+
+        size_t getWorkerCount() const;
+
+        /**
+         * Calls job(begin, end) over [0, count) split into ranges of at most grain elements, and returns once all of
+         * them finished. The calling thread takes part in the work.
+         */
+        void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)> &job);
+    };
+
+    /**
+     * A set of tasks that can be waited on together.
+     * Tasks may add more tasks to the group while it runs. The first exception thrown by a task is rethrown by wait.
+     */
+    class TaskGroup {
+    private:
+        ThreadPool *pool;
+        std::atomic<size_t> remaining;
+        std::mutex errorMutex;
+        std::exception_ptr error;
+    public:
+        explicit TaskGroup(ThreadPool &pool);
+
+        TaskGroup(const TaskGroup &) = delete;
+
+        TaskGroup &operator=(const TaskGroup &) = delete;
+
+        /**
+         * Waits for tasks still running, without rethrowing their exceptions
+         */
+        ~TaskGroup();
+
+        void run(ThreadPool::Task task);
+
+        /**
+         * Blocks until every task of the group finished, running pending tasks of the pool meanwhile.
+         */
+        void wait();
+    };
+}
+#endif
@@ -0,0 +1,56 @@
+#ifndef OVEREDITOR_TRANSFORM_BATCH_H
+#define OVEREDITOR_TRANSFORM_BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+namespace overeditor::utility {
+
+    /**
+     * Column-major matrix layouts, the value is the amount of floats per matrix.
+     * 4x3 drops the constant last row of affine matrices: four columns of three floats each.
+     */
+    enum MatrixLayout : uint8_t {
+        eMatrix4x3 = 12,
+        eMatrix4x4 = 16
+    };
+
+    /**
+     * Converts count translation, rotation and scale triplets into matrices written consecutively to destination.
+     * Rotations must be normalized. Uses AVX2 when built with OVEREDITOR_AVX2, SSE2 otherwise on x86. destination
+     * needs no alignment and is only written to, so it can point straight into mapped GPU memory.
+     */
+    void composeMatrices(
+            const glm::vec3 *positions,
+            const glm::quat *rotations,
+            const glm::vec3 *scales,
+            size_t count,
+            float *destination,
+            MatrixLayout layout
+    );
+
+    /**
+     * Reference implementation of composeMatrices, one matrix at a time.
+     */
+    void composeMatricesScalar(
+            const glm::vec3 *positions,
+            const glm::quat *rotations,
+            const glm::vec3 *scales,
+            size_t count,
+            float *destination,
+            MatrixLayout layout
+    );
+
+    /**
+     * Writes a single already composed matrix in the given layout
+     */
+    void storeMatrix(const glm::mat4 &matrix, float *destination, MatrixLayout layout);
+
+    /**
+     * Name of the instruction set composeMatrices was built with
+     */
+    const char *getComposeImplementation();
+}
+#endif
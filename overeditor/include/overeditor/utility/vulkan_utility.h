@@ -16,4 +16,16 @@
 
 #define vkAssertOk(x) _vkAssertOk(x, std::string("Error while executing ") + #x +": " + vk::to_string((vk::Result) vkAssertVar) + ")")
 
+namespace overeditor::utility {
+    /**
+     * Finds the index of the first memory type allowed by typeBits that has all the requested property flags.
+     * Throws if no such memory type exists.
+     */
+    uint32_t findMemoryType(
+            const vk::PhysicalDeviceMemoryProperties &properties,
+            uint32_t typeBits,
+            vk::MemoryPropertyFlags flags
+    );
+}
+
 #endif
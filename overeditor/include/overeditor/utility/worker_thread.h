@@ -0,0 +1,74 @@
+#ifndef OVEREDITOR_WORKER_THREAD_H
+#define OVEREDITOR_WORKER_THREAD_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace overeditor::utility {
+    /**
+     * A single background thread that executes tasks in the order they were enqueued.
+     * Tasks still pending when the worker is destroyed are discarded.
+     */
+    class WorkerThread {
+    public:
+        typedef std::function<void()> Task;
+    private:
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::deque<Task> tasks;
+        bool stopping;
+        std::thread thread;
+
+        void loop() {
+            while (true) {
+                Task task;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    condition.wait(lock, [this] {
+                        return stopping || !tasks.empty();
+                    });
+                    if (stopping) {
+                        return;
+                    }
+                    task = std::move(tasks.front());
+                    tasks.pop_front();
+                }
+                task();
+            }
+        }
+
+    public:
+        WorkerThread() : mutex(), condition(), tasks(), stopping(false), thread(&WorkerThread::loop, this) {
+        }
+
+        WorkerThread(const WorkerThread &) = delete;
+
+        WorkerThread &operator=(const WorkerThread &) = delete;
+
+        ~WorkerThread() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            condition.notify_all();
+            thread.join();
+        }
+
+        void enqueue(Task task) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                tasks.push_back(std::move(task));
+            }
+            condition.notify_one();
+        }
+
+        size_t getPendingCount() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return tasks.size();
+        }
+    };
+}
+#endif
@@ -1,10 +1,21 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
+// DrawConstants
+layout(push_constant) uniform Draw {
+    uint instance;
+    uint material;
+    uint texture;
+} draw;
+
+// TextureTable, TEXTURE_TABLE_CAPACITY slots and the fallback
+layout(set = 2, binding = 0) uniform sampler2D textures[65];
+
 layout(location = 0) in vec3 fragColor;
+layout(location = 1) in vec2 fragTexCoord;
 
 layout(location = 0) out vec4 outColor;
 
 void main() {
-    outColor = vec4(fragColor, 1.0);
+    outColor = vec4(fragColor, 1.0) * texture(textures[draw.texture], fragTexCoord);
 }
\ No newline at end of file
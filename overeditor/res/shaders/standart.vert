@@ -1,13 +1,30 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
-layout(location = 0) out vec3 fragColor;
+// PassUniforms, from the rendering system's uniform ring
+layout(set = 0, binding = 0) uniform Pass {
+    mat4 viewProjection;
+    vec4 cameraPosition;
+} pass;
 
-vec2 positions[3] = vec2[](
-vec2(0.0, -0.5),
-vec2(0.5, 0.5),
-vec2(-0.5, 0.5)
-);
+// DrawConstants
+layout(push_constant) uniform Draw {
+    uint instance;
+    uint material;
+    uint texture;
+} draw;
+
+// InstanceBuffer of the frame, four columns of three floats per instance
+layout(set = 1, binding = 0) readonly buffer Instances {
+    float values[];
+} instances;
+
+// GeometryLayout with a single float * 3 element
+layout(location = 0) in vec3 position;
+
+layout(location = 0) out vec3 fragColor;
+// The layout has no texture coordinates, the texture is projected along the geometry's Z axis
+layout(location = 1) out vec2 fragTexCoord;
 
 vec3 colors[3] = vec3[](
 vec3(1.0, 0.0, 0.0),
@@ -15,7 +32,21 @@ vec3(0.0, 1.0, 0.0),
 vec3(0.0, 0.0, 1.0)
 );
 
+mat4 loadModel(uint instance) {
+    uint base = instance * 12u;
+    mat4 model;
+    for (uint column = 0u; column < 4u; ++column) {
+        uint first = base + column * 3u;
+        model[column] = vec4(
+            instances.values[first], instances.values[first + 1u], instances.values[first + 2u],
+            column == 3u ? 1.0 : 0.0
+        );
+    }
+    return model;
+}
+
 void main() {
-    gl_Position = vec4(positions[gl_VertexIndex], 0.0, 1.0);
-    fragColor = colors[gl_VertexIndex];
+    gl_Position = pass.viewProjection * loadModel(draw.instance) * vec4(position, 1.0);
+    fragColor = colors[gl_VertexIndex % 3];
+    fragTexCoord = position.xy * 0.5 + 0.5;
 }
\ No newline at end of file
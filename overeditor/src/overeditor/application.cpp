@@ -2,6 +2,7 @@
 #include <overeditor/overeditor_constants.h>
 #include <overeditor/utility/string_utility.h>
 #include <overeditor/utility/memory_utility.h>
+#include <overeditor/utility/async_log_appender.h>
 #include <overeditor/graphics/queue_families.h>
 #include <overeditor/graphics/querying.h>
 #include <overeditor/graphics/requirements.h>
@@ -10,97 +11,20 @@
 #include <vulkan/vulkan.hpp>
 
 #include <plog/Log.h>
-#include <plog/Appenders/ColorConsoleAppender.h>
 
 #include <algorithm>
+#include <chrono>
+#include <memory>
 
 namespace overeditor {
     void onError(int code, const char *msg) {
         LOG_ERROR << "GLFW Error (" << code << "): " << msg;
     }
 
-    Application::Application()
-            : instance(), deviceContext(nullptr), running(true),
-              sceneTick(), window(), instanceSuitable() {
-        static plog::ColorConsoleAppender<plog::TxtFormatter> consoleAppender;
-        plog::init(plog::debug, &consoleAppender);
-        glfwInit();
-        glfwSetErrorCallback(onError);
-        LOG_INFO << "Using GLFW: " << glfwGetVersionString();
-        auto requirements = overeditor::graphics::VulkanRequirements::createOverEditorRequirements();
-        const auto &instanceRequirements = requirements.getInstanceRequirements();
-        const std::vector<const char *> &instanceRequiredExtensions = instanceRequirements.getRequiredExtensions();
-        const auto &instanceRequiredLayers = instanceRequirements.getRequiredLayers();
-        // Get available instance extensions and layers
-        uint32_t instanceLayerCount, instanceExtensionCount;
-        // Find instance extensions
-        vkEnumerateInstanceExtensionProperties(nullptr, &instanceExtensionCount, nullptr);
-        std::vector<vk::ExtensionProperties> availableInstanceExtensions(instanceExtensionCount);
-        vkEnumerateInstanceExtensionProperties(
-                nullptr, &instanceExtensionCount,
-                reinterpret_cast<VkExtensionProperties *>(availableInstanceExtensions.data())
-        );
-        // Find instance layers
-        vkEnumerateInstanceLayerProperties(&instanceLayerCount, nullptr);
-        std::vector<vk::LayerProperties> availableInstanceLayers(instanceLayerCount);
-        vkEnumerateInstanceLayerProperties(
-                &instanceLayerCount,
-                reinterpret_cast<VkLayerProperties *>(availableInstanceLayers.data())
-        );
-        LOG_REQUIREMENTS("instance extensions", instanceRequiredExtensions);
-        LOG_VECTOR_WITH("Available instance extensions (" << availableInstanceExtensions.size() << "):",
-                        availableInstanceExtensions, 1, value.extensionName);
-        LOG_REQUIREMENTS("instance layers", instanceRequiredLayers);
-        LOG_VECTOR_WITH("Available instance layers (" << availableInstanceLayers.size() << "):",
-                        availableInstanceLayers, 1, value.layerName);
-        instanceRequirements.checkRequirements(availableInstanceExtensions, availableInstanceLayers, instanceSuitable);
-        if (instanceSuitable.isSuccessful()) {
-            LOG_INFO << "Successfully found all required extensions and layers";
-        } else {
-            LOG_ERROR << "Error(s) occoured while finding instance extensions and layers:";
-            instanceSuitable.printErrors();
-        }
-        const auto &deviceRequirements = requirements.getDeviceRequirements();
-
-        auto appInfo = vk::ApplicationInfo(
-                OVEREDITOR_NAME, // Application name
-                OVEREDITOR_VERSION, // Application Version
-                OVEREDITOR_NAME, // Engine name
-                OVEREDITOR_VERSION, // Engine version
-                VK_API_VERSION_1_1 // Vulkan version
-        );
-
-
-        auto createInfo = vk::InstanceCreateInfo(
-                (vk::InstanceCreateFlags) 0, &appInfo,
-                instanceRequiredLayers.size(), instanceRequiredLayers.data(),
-                instanceRequiredExtensions.size(), instanceRequiredExtensions.data()
-        );
-        instance = vk::createInstance(createInfo);
-        uint32_t totalDevices;
-
-        // Check how many devices there are
-        vkEnumeratePhysicalDevices((VkInstance) instance, &totalDevices, nullptr);
-        if (totalDevices <= 0) {
-            throw std::runtime_error("There are no Vulkan capable devices available!");
-        }
-        std::vector<vk::PhysicalDevice> devices(totalDevices);
-        vkEnumeratePhysicalDevices((VkInstance) instance, &totalDevices,
-                                   reinterpret_cast<VkPhysicalDevice *>(devices.data()));
-        // Create Window and Surface
-        glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-        glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
-        window = glfwCreateWindow(600, 800, OVEREDITOR_NAME, nullptr, nullptr);
-        glfwCreateWindowSurface((VkInstance) instance, window, nullptr, reinterpret_cast<VkSurfaceKHR *>(&surface));
-        // Convert devices to candidates
-        std::vector<graphics::PhysicalDeviceCandidate> candidates;
-        candidates.reserve(devices.size());
-        for (const vk::PhysicalDevice &device : devices) {
-            candidates.emplace_back(deviceRequirements, device, surface);
-        }
+    static void logCandidates(const std::vector<std::unique_ptr<graphics::PhysicalDeviceCandidate>> &candidates) {
         LOG_INFO << "Device candidates (" << candidates.size() << "):";
         for (int i = 0; i < candidates.size(); ++i) {
-            const graphics::PhysicalDeviceCandidate &c = candidates[i];
+            const graphics::PhysicalDeviceCandidate &c = *candidates[i];
             LOG_INFO << INDENTATION(1) << "Device #" << i << " (\"" << c.getName() << "\", score: " << c.getScore()
                      << ")";
             const vk::PhysicalDeviceProperties &deviceProperties = c.getDeviceProperties();
@@ -133,45 +57,266 @@ namespace overeditor {
                 LOG_INFO << LOG_QUEUE_FAMILY_BIT(vk::QueueFlagBits::eSparseBinding, "Sparse binding", prop.queueFlags);
             }
         }
+    }
+
+    /**
+     * Picks the device to use, returns nullptr if none is suitable.
+     * The device elected by the previous run is reused without scoring the others if it's still present and suitable.
+     */
+    static std::unique_ptr<graphics::PhysicalDeviceCandidate> electDevice(
+            utility::ThreadPool &pool,
+            const std::vector<vk::PhysicalDevice> &devices,
+            const graphics::Requirements &requirements,
+            const vk::SurfaceKHR &surface,
+            const std::filesystem::path &recordPath
+    ) {
+        graphics::ElectedDeviceRecord record;
+        if (graphics::ElectedDeviceRecord::load(recordPath, record)) {
+            for (const vk::PhysicalDevice &device : devices) {
+                if (!record.matches(device.getProperties())) {
+                    continue;
+                }
+                auto candidate = std::make_unique<graphics::PhysicalDeviceCandidate>(requirements, device, surface);
+                if (candidate->getSuitableness().isSuccessful()) {
+                    LOG_INFO << "Reusing the device elected by the previous run";
+                    return candidate;
+                }
+                break;
+            }
+        }
+        // Convert devices to candidates, each one only queries its own device
+        std::vector<std::unique_ptr<graphics::PhysicalDeviceCandidate>> candidates(devices.size());
+        pool.parallelFor(devices.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                candidates[i] = std::make_unique<graphics::PhysicalDeviceCandidate>(requirements, devices[i], surface);
+            }
+        });
+        logCandidates(candidates);
         // Remove devices that are not suitable
         candidates.erase(
                 std::remove_if(candidates.begin(), candidates.end(),
-                               [&](graphics::PhysicalDeviceCandidate &candidate) {
-                                   return !candidate.getSuitableness().isSuccessful();
+                               [&](std::unique_ptr<graphics::PhysicalDeviceCandidate> &candidate) {
+                                   return !candidate->getSuitableness().isSuccessful();
                                }
                 ), candidates.end()
         );
-        // Sort by highest score
-        std::sort(candidates.begin(), candidates.end(),
-                  [](graphics::PhysicalDeviceCandidate &a, graphics::PhysicalDeviceCandidate &b) {
-                      return a.getScore() > b.getScore();
-                  }
-        );
         if (candidates.empty()) {
+            return nullptr;
+        }
+        // Pick the highest score
+        auto best = std::max_element(
+                candidates.begin(), candidates.end(),
+                [](const std::unique_ptr<graphics::PhysicalDeviceCandidate> &a,
+                   const std::unique_ptr<graphics::PhysicalDeviceCandidate> &b) {
+                    return a->getScore() < b->getScore();
+                }
+        );
+        graphics::ElectedDeviceRecord((*best)->getDeviceProperties()).save(recordPath);
+        return std::move(*best);
+    }
+
+    Application::Application()
+            : startupProfiler(), memoryTracker(), instance(), deviceContext(nullptr), resourceRegistry(nullptr),
+              textureStreamer(nullptr), running(true), sceneTick(), window(), instanceSuitable(), threadPool(),
+              eventBus(), scheduler(entities, events, threadPool),
+              pipelineCache(
+                      std::filesystem::current_path() / OVEREDITOR_CACHE_DIRECTORY / OVEREDITOR_PIPELINE_CACHE_FILE
+              ),
+              meshBvhCache(&memoryTracker), vertexKdTreeCache(&memoryTracker), shaderLibrary(), firstFrame(true),
+              sceneFormat(scene::SceneFormat::createOverEditorFormat(&threadPool)), autosave(nullptr),
+              journal(entities, eventBus) {
+        static utility::AsyncLogAppender logAppender;
+        plog::init(plog::debug, &logAppender);
+        // Disk reads that don't need a device, overlapped with instance and device creation
+        utility::TaskGroup loads(threadPool);
+        loads.run([this] {
+            utility::PhaseProfiler::Scope phase(startupProfiler, "Shader library");
+            shaderLibrary.load(std::filesystem::current_path() / OVEREDITOR_RESOURCE_DIRECTORY);
+        });
+        loads.run([this] {
+            utility::PhaseProfiler::Scope phase(startupProfiler, "Pipeline cache file");
+            pipelineCache.load();
+        });
+        auto requirements = overeditor::graphics::VulkanRequirements::createOverEditorRequirements();
+        const auto &deviceRequirements = requirements.getDeviceRequirements();
+        std::vector<vk::PhysicalDevice> devices;
+        {
+            utility::PhaseProfiler::Scope phase(startupProfiler, "Instance");
+            glfwInit();
+            glfwSetErrorCallback(onError);
+            LOG_INFO << "Using GLFW: " << glfwGetVersionString();
+            const auto &instanceRequirements = requirements.getInstanceRequirements();
+            const std::vector<const char *> &instanceRequiredExtensions = instanceRequirements.getRequiredExtensions();
+            const auto &instanceRequiredLayers = instanceRequirements.getRequiredLayers();
+            // Get available instance extensions and layers
+            uint32_t instanceLayerCount, instanceExtensionCount;
+            // Find instance extensions
+            vkEnumerateInstanceExtensionProperties(nullptr, &instanceExtensionCount, nullptr);
+            std::vector<vk::ExtensionProperties> availableInstanceExtensions(instanceExtensionCount);
+            vkEnumerateInstanceExtensionProperties(
+                    nullptr, &instanceExtensionCount,
+                    reinterpret_cast<VkExtensionProperties *>(availableInstanceExtensions.data())
+            );
+            // Find instance layers
+            vkEnumerateInstanceLayerProperties(&instanceLayerCount, nullptr);
+            std::vector<vk::LayerProperties> availableInstanceLayers(instanceLayerCount);
+            vkEnumerateInstanceLayerProperties(
+                    &instanceLayerCount,
+                    reinterpret_cast<VkLayerProperties *>(availableInstanceLayers.data())
+            );
+            LOG_REQUIREMENTS("instance extensions", instanceRequiredExtensions);
+            LOG_VECTOR_WITH("Available instance extensions (" << availableInstanceExtensions.size() << "):",
+                            availableInstanceExtensions, 1, value.extensionName);
+            LOG_REQUIREMENTS("instance layers", instanceRequiredLayers);
+            LOG_VECTOR_WITH("Available instance layers (" << availableInstanceLayers.size() << "):",
+                            availableInstanceLayers, 1, value.layerName);
+            instanceRequirements.checkRequirements(
+                    availableInstanceExtensions, availableInstanceLayers, instanceSuitable
+            );
+            if (instanceSuitable.isSuccessful()) {
+                LOG_INFO << "Successfully found all required extensions and layers";
+            } else {
+                LOG_ERROR << "Error(s) occoured while finding instance extensions and layers:";
+                instanceSuitable.printErrors();
+            }
+
+            auto appInfo = vk::ApplicationInfo(
+                    OVEREDITOR_NAME, // Application name
+                    OVEREDITOR_VERSION, // Application Version
+                    OVEREDITOR_NAME, // Engine name
+                    OVEREDITOR_VERSION, // Engine version
+                    VK_API_VERSION_1_1 // Vulkan version
+            );
+
+
+            auto createInfo = vk::InstanceCreateInfo(
+                    (vk::InstanceCreateFlags) 0, &appInfo,
+                    instanceRequiredLayers.size(), instanceRequiredLayers.data(),
+                    instanceRequiredExtensions.size(), instanceRequiredExtensions.data()
+            );
+            instance = vk::createInstance(createInfo);
+            uint32_t totalDevices;
+
+            // Check how many devices there are
+            vkEnumeratePhysicalDevices((VkInstance) instance, &totalDevices, nullptr);
+            if (totalDevices <= 0) {
+                throw std::runtime_error("There are no Vulkan capable devices available!");
+            }
+            devices.resize(totalDevices);
+            vkEnumeratePhysicalDevices((VkInstance) instance, &totalDevices,
+                                       reinterpret_cast<VkPhysicalDevice *>(devices.data()));
+        }
+        {
+            // GLFW only allows this on the main thread
+            utility::PhaseProfiler::Scope phase(startupProfiler, "Window");
+            // Create Window and Surface
+            glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+            glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+            window = glfwCreateWindow(600, 800, OVEREDITOR_NAME, nullptr, nullptr);
+            glfwCreateWindowSurface(
+                    (VkInstance) instance, window, nullptr, reinterpret_cast<VkSurfaceKHR *>(&surface)
+            );
+        }
+        std::unique_ptr<graphics::PhysicalDeviceCandidate> elected;
+        {
+            utility::PhaseProfiler::Scope phase(startupProfiler, "Device selection");
+            elected = electDevice(
+                    threadPool, devices, deviceRequirements, surface,
+                    std::filesystem::current_path() / OVEREDITOR_CACHE_DIRECTORY / OVEREDITOR_ELECTED_DEVICE_FILE
+            );
+        }
+        if (!elected) {
             LOG_FATAL << "There are no suitable devices!";
             return;
         }
-
-        graphics::PhysicalDeviceCandidate elected = candidates[0];
-        LOG_INFO << "Elected device is \"" << elected.getName() << "\"";
-        deviceContext = new graphics::DeviceContext(elected, deviceRequirements, surface);
-        LOG_INFO << "Logical device created";
-        // Load shaders
+        LOG_INFO << "Elected device is \"" << elected->getName() << "\"";
+        {
+            utility::PhaseProfiler::Scope phase(startupProfiler, "Device creation");
+            deviceContext = new graphics::DeviceContext(*elected, deviceRequirements, surface, memoryTracker);
+            LOG_INFO << "Logical device created";
+            resourceRegistry = new graphics::ResourceRegistry(*deviceContext);
+            textureStreamer = new graphics::textures::TextureStreamer(*deviceContext, *resourceRegistry);
+        }
+        memoryTracker.log();
+        {
+            // Only shows up if the loads took longer than everything above
+            utility::PhaseProfiler::Scope phase(startupProfiler, "Waiting for loads");
+            loads.wait();
+        }
+        pipelineCache.create(deviceContext->getDevice(), elected->getDeviceProperties());
+        LOG_INFO << "Loaded " << shaderLibrary.size() << " shaders";
+        utility::PhaseProfiler::Scope phase(startupProfiler, "Systems");
         static utility::Event<float>::EventListener quitter = [&](float dt) {
             running = !glfwWindowShouldClose(window);
             if (glfwGetKey(window, GLFW_KEY_ESCAPE)) {
                 running = false;
             }
-            systems.update_all(1.0F / 60);
+            scheduler.update(1.0F / 60);
         };
         sceneTick.getEarlyStep() += &quitter;
+        sceneTick.setEventBus(&eventBus);
+        static utility::Event<float>::EventListener streamer = [&](float dt) {
+            textureStreamer->update();
+        };
+        sceneTick.getLateStep() += &streamer;
+        static utility::Event<float>::EventListener autosaver = [&](float dt) {
+            if (autosave != nullptr) {
+                autosave->update(entities, dt);
+            }
+        };
+        sceneTick.getLateStep() += &autosaver;
+        static utility::Event<float>::EventListener pruner = [&](float dt) {
+            // Meshes are freed by whoever unloads them, drop what was built for them along with them
+            meshBvhCache.prune();
+            vertexKdTreeCache.prune();
+        };
+        sceneTick.getLateStep() += &pruner;
+        static utility::Event<float>::EventListener budgets = [&](float dt) {
+            memoryTracker.update();
+        };
+        sceneTick.getLateStep() += &budgets;
         glfwShowWindow(window);
-        renderingSystem = systems.add<overeditor::systems::graphics::RenderingSystem>(*deviceContext);
+        worldPartition = systems.add<systems::world::WorldPartition>();
+        chunkStorage = systems.add<storage::ChunkStorage>(eventBus, &memoryTracker);
+        // Autosave snapshots then copy only the transform chunks that changed
+        sceneFormat = scene::SceneFormat::createOverEditorFormat(&threadPool, chunkStorage.get());
+        transformHierarchy = systems.add<systems::transforms::TransformHierarchy>(threadPool, eventBus);
+        spatialIndex = systems.add<systems::spatial::SpatialIndex>(*transformHierarchy, threadPool);
+        renderingSystem = systems.add<overeditor::systems::graphics::RenderingSystem>(
+                *deviceContext, *chunkStorage, *transformHierarchy, threadPool, *resourceRegistry, entities, events
+        );
+        renderingSystem->setTextureStreamer(textureStreamer);
         systems.configure();
+        // Creates and destroys entities, so it runs alone, and first so the other systems see the cells it streamed
+        scheduler.add("WorldPartition", worldPartition, ecs::SystemAccess().setExclusive());
+        // Scheduled before the systems reading its components and writing both, so they run on up to date chunks
+        scheduler.add("ChunkStorage", chunkStorage, ecs::SystemAccess().write<Transform, Drawable>());
+        scheduler.add("TransformHierarchy", transformHierarchy, ecs::SystemAccess().read<Parent, Transform>());
+        // Both read the world matrices the hierarchy derives from the transforms
+        scheduler.add(
+                "SpatialIndex", spatialIndex, ecs::SystemAccess().read<Transform>().after("TransformHierarchy")
+        );
+        scheduler.add(
+                "RenderingSystem", renderingSystem,
+                ecs::SystemAccess().read<Transform, Drawable>().after("TransformHierarchy")
+        );
     }
 
     Application::~Application() {
         sceneTick.clear();
+        delete autosave;
+        delete textureStreamer;
+        if (renderingSystem) {
+            renderingSystem->dispose();
+        }
+        if (resourceRegistry != nullptr) {
+            resourceRegistry->dispose();
+        }
+        delete resourceRegistry;
+        if (deviceContext != nullptr) {
+            pipelineCache.save(deviceContext->getDevice());
+            pipelineCache.dispose(deviceContext->getDevice());
+        }
         delete deviceContext;
         vkDestroySurfaceKHR((VkInstance) instance, (VkSurfaceKHR) surface, nullptr);
         instance.destroy();
@@ -182,6 +327,14 @@ namespace overeditor {
             glfwPollEvents();
             //TODO: Variable delta time
             const float deltaTime = 1.0F / 60;
+            if (firstFrame) {
+                auto start = std::chrono::steady_clock::now();
+                sceneTick(deltaTime);
+                startupProfiler.record("First frame", start);
+                startupProfiler.log("Startup to first frame");
+                firstFrame = false;
+                continue;
+            }
             sceneTick(deltaTime);
         }
         deviceContext->getDevice().waitIdle();
@@ -191,7 +344,84 @@ namespace overeditor {
         return deviceContext;
     }
 
+    graphics::ResourceRegistry *Application::getResourceRegistry() const {
+        return resourceRegistry;
+    }
+
+    graphics::textures::TextureStreamer *Application::getTextureStreamer() const {
+        return textureStreamer;
+    }
+
     const std::shared_ptr<systems::graphics::RenderingSystem> &Application::getRenderingSystem() const {
         return renderingSystem;
     }
+
+    const std::shared_ptr<storage::ChunkStorage> &Application::getChunkStorage() const {
+        return chunkStorage;
+    }
+
+    const std::shared_ptr<systems::world::WorldPartition> &Application::getWorldPartition() const {
+        return worldPartition;
+    }
+
+    const std::shared_ptr<systems::transforms::TransformHierarchy> &Application::getTransformHierarchy() const {
+        return transformHierarchy;
+    }
+
+    const std::shared_ptr<systems::spatial::SpatialIndex> &Application::getSpatialIndex() const {
+        return spatialIndex;
+    }
+
+    graphics::MeshBvhCache &Application::getMeshBvhCache() {
+        return meshBvhCache;
+    }
+
+    graphics::VertexKdTreeCache &Application::getVertexKdTreeCache() {
+        return vertexKdTreeCache;
+    }
+
+    utility::ThreadPool &Application::getThreadPool() {
+        return threadPool;
+    }
+
+    const utility::MemoryTracker &Application::getMemoryTracker() const {
+        return memoryTracker;
+    }
+
+    const graphics::PipelineCache &Application::getPipelineCache() const {
+        return pipelineCache;
+    }
+
+    const graphics::shaders::ShaderLibrary &Application::getShaderLibrary() const {
+        return shaderLibrary;
+    }
+
+    const utility::PhaseProfiler &Application::getStartupProfiler() const {
+        return startupProfiler;
+    }
+
+    utility::EventBus &Application::getEventBus() {
+        return eventBus;
+    }
+
+    ecs::Scheduler &Application::getScheduler() {
+        return scheduler;
+    }
+
+    const scene::SceneFormat &Application::getSceneFormat() const {
+        return sceneFormat;
+    }
+
+    void Application::enableAutosave(const std::filesystem::path &path, float interval) {
+        delete autosave;
+        autosave = new scene::Autosave(sceneFormat, path, interval);
+    }
+
+    scene::Autosave *Application::getAutosave() const {
+        return autosave;
+    }
+
+    editing::Journal &Application::getJournal() {
+        return journal;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,126 @@
+#include <overeditor/ecs/scheduler.h>
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+namespace overeditor::ecs {
+    typedef std::chrono::high_resolution_clock Clock;
+
+    SystemAccess::SystemAccess() : reads(), writes(), predecessors(), exclusive(false) {}
+
+    SystemAccess &SystemAccess::setExclusive() {
+        exclusive = true;
+        return *this;
+    }
+
+    SystemAccess &SystemAccess::after(const std::string &name) {
+        predecessors.push_back(name);
+        return *this;
+    }
+
+    bool SystemAccess::isExclusive() const {
+        return exclusive;
+    }
+
+    bool SystemAccess::runsAfter(const std::string &name) const {
+        return std::find(predecessors.begin(), predecessors.end(), name) != predecessors.end();
+    }
+
+    bool SystemAccess::conflicts(const SystemAccess &other) const {
+        if (exclusive || other.exclusive) {
+            return true;
+        }
+        return (writes & (other.reads | other.writes)).any() || (other.writes & reads).any();
+    }
+
+    Scheduler::Scheduler(
+            entityx::EntityManager &entities,
+            entityx::EventManager &events,
+            utility::ThreadPool &pool
+    ) : entities(&entities), events(&events), pool(&pool), nodes(), remaining(), graphDirty(false),
+        frameMilliseconds(0) {}
+
+    void Scheduler::add(
+            const std::string &name,
+            const std::shared_ptr<entityx::BaseSystem> &system,
+            const SystemAccess &access
+    ) {
+        nodes.push_back(Node{name, system, access, {}, 0, 0});
+        graphDirty = true;
+    }
+
+    void Scheduler::buildGraph() {
+        for (Node &node : nodes) {
+            node.dependents.clear();
+            node.dependencyCount = 0;
+        }
+        for (size_t later = 0; later < nodes.size(); ++later) {
+            for (size_t earlier = 0; earlier < later; ++earlier) {
+                if (nodes[earlier].access.conflicts(nodes[later].access) ||
+                    nodes[later].access.runsAfter(nodes[earlier].name)) {
+                    nodes[earlier].dependents.push_back(later);
+                    nodes[later].dependencyCount++;
+                }
+            }
+            for (size_t following = later + 1; following < nodes.size(); ++following) {
+                if (nodes[later].access.runsAfter(nodes[following].name)) {
+                    throw std::runtime_error(
+                            "System " + nodes[later].name + " must be added after " + nodes[following].name
+                    );
+                }
+            }
+        }
+        remaining.reset(new std::atomic<size_t>[nodes.size()]);
+        graphDirty = false;
+    }
+
+    void Scheduler::run(utility::TaskGroup &group, size_t index, entityx::TimeDelta dt) {
+        group.run([this, &group, index, dt] {
+            Node &node = nodes[index];
+            auto start = Clock::now();
+            node.system->update(*entities, *events, dt);
+            node.milliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            for (size_t dependent : node.dependents) {
+                if (--remaining[dependent] == 0) {
+                    run(group, dependent, dt);
+                }
+            }
+        });
+    }
+
+    void Scheduler::update(entityx::TimeDelta dt) {
+        if (graphDirty) {
+            buildGraph();
+        }
+        auto start = Clock::now();
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            remaining[i] = nodes[i].dependencyCount;
+        }
+        utility::TaskGroup group(*pool);
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            if (nodes[i].dependencyCount == 0) {
+                run(group, i, dt);
+            }
+        }
+        group.wait();
+        frameMilliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    std::vector<SystemTiming> Scheduler::getTimings() const {
+        std::vector<SystemTiming> timings;
+        timings.reserve(nodes.size());
+        for (const Node &node : nodes) {
+            timings.push_back(SystemTiming{node.name, node.milliseconds});
+        }
+        return timings;
+    }
+
+    double Scheduler::getFrameMilliseconds() const {
+        return frameMilliseconds;
+    }
+
+    utility::ThreadPool &Scheduler::getThreadPool() const {
+        return *pool;
+    }
+}
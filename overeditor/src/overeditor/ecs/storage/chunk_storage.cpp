@@ -0,0 +1,343 @@
+#include <overeditor/ecs/storage/chunk_storage.h>
+
+namespace overeditor::storage {
+
+    /**
+     * Rounds offset up to the chunk array alignment
+     */
+    static size_t alignOffset(size_t offset) {
+        return (offset + STORAGE_CHUNK_ALIGNMENT - 1) & ~((size_t) STORAGE_CHUNK_ALIGNMENT - 1);
+    }
+
+    static size_t computeRowSize(uint8_t archetype) {
+        size_t size = sizeof(entityx::Entity::Id);
+        if (archetype & eStorageTransform) {
+            size += sizeof(glm::vec3) + sizeof(glm::quat) + sizeof(glm::vec3);
+        }
+        if (archetype & eStorageDrawable) {
+            size += sizeof(Drawable);
+        }
+        return size;
+    }
+
+    static size_t computeArrayCount(uint8_t archetype) {
+        size_t count = 1;
+        if (archetype & eStorageTransform) {
+            count += 3;
+        }
+        if (archetype & eStorageDrawable) {
+            count += 1;
+        }
+        return count;
+    }
+
+    uint32_t StorageChunk::computeCapacity(uint8_t archetype) {
+        // Every array may waste up to one alignment worth of padding
+        size_t usable = STORAGE_CHUNK_SIZE - computeArrayCount(archetype) * STORAGE_CHUNK_ALIGNMENT;
+        return (uint32_t) (usable / computeRowSize(archetype));
+    }
+
+    StorageChunk::StorageChunk(uint8_t archetype)
+            : memory(new uint8_t[STORAGE_CHUNK_SIZE + STORAGE_CHUNK_ALIGNMENT]),
+              capacity(computeCapacity(archetype)), count(0), version(0),
+              entities(nullptr), positions(nullptr), rotations(nullptr), scales(nullptr), drawables(nullptr) {
+        auto base = reinterpret_cast<uintptr_t>(memory.get());
+        size_t offset = alignOffset(base) - base;
+        auto carve = [&](size_t elementSize) {
+            uint8_t *array = memory.get() + offset;
+            offset = alignOffset(offset + base + elementSize * capacity) - base;
+            return array;
+        };
+        entities = reinterpret_cast<entityx::Entity::Id *>(carve(sizeof(entityx::Entity::Id)));
+        if (archetype & eStorageTransform) {
+            positions = reinterpret_cast<glm::vec3 *>(carve(sizeof(glm::vec3)));
+            rotations = reinterpret_cast<glm::quat *>(carve(sizeof(glm::quat)));
+            scales = reinterpret_cast<glm::vec3 *>(carve(sizeof(glm::vec3)));
+        }
+        if (archetype & eStorageDrawable) {
+            drawables = reinterpret_cast<Drawable *>(carve(sizeof(Drawable)));
+        }
+    }
+
+    uint32_t StorageChunk::getCapacity() const {
+        return capacity;
+    }
+
+    uint32_t StorageChunk::getCount() const {
+        return count;
+    }
+
+    bool StorageChunk::isFull() const {
+        return count == capacity;
+    }
+
+    uint64_t StorageChunk::getVersion() const {
+        return version;
+    }
+
+    void StorageChunk::setVersion(uint64_t version) {
+        StorageChunk::version = version;
+    }
+
+    const entityx::Entity::Id *StorageChunk::getEntities() const {
+        return entities;
+    }
+
+    glm::vec3 *StorageChunk::getPositions() const {
+        return positions;
+    }
+
+    glm::quat *StorageChunk::getRotations() const {
+        return rotations;
+    }
+
+    glm::vec3 *StorageChunk::getScales() const {
+        return scales;
+    }
+
+    Drawable *StorageChunk::getDrawables() const {
+        return drawables;
+    }
+
+    uint32_t StorageChunk::push(entityx::Entity::Id entity) {
+        uint32_t row = count++;
+        entities[row] = entity;
+        return row;
+    }
+
+    entityx::Entity::Id StorageChunk::swapRemove(uint32_t row) {
+        uint32_t last = --count;
+        if (row != last) {
+            entities[row] = entities[last];
+            if (positions != nullptr) {
+                positions[row] = positions[last];
+                rotations[row] = rotations[last];
+                scales[row] = scales[last];
+            }
+            if (drawables != nullptr) {
+                drawables[row] = drawables[last];
+            }
+        }
+        return entities[row];
+    }
+
+    Archetype::Archetype(uint8_t mask) : mask(mask), chunks(), available() {}
+
+    uint8_t Archetype::getMask() const {
+        return mask;
+    }
+
+    const std::vector<std::unique_ptr<StorageChunk>> &Archetype::getChunks() const {
+        return chunks;
+    }
+
+    uint32_t Archetype::acquireChunk() {
+        if (available.empty()) {
+            available.push_back((uint32_t) chunks.size());
+            chunks.emplace_back(new StorageChunk(mask));
+        }
+        uint32_t index = available.back();
+        if (chunks[index]->getCount() + 1 == chunks[index]->getCapacity()) {
+            // The row about to be pushed fills it
+            available.pop_back();
+        }
+        return index;
+    }
+
+    void Archetype::releaseRow(uint32_t chunk) {
+        // Only chunks that were full before the removal are missing from the available list
+        if (chunks[chunk]->getCount() + 1 == chunks[chunk]->getCapacity()) {
+            available.push_back(chunk);
+        }
+    }
+
+    ChunkStorage::ChunkStorage(utility::EventBus &eventBus, utility::MemoryTracker *memoryTracker)
+            : locations(), dirty(), version(0), drawableVersion(0), memoryTracker(memoryTracker) {
+        for (uint8_t mask = 0; mask < STORAGE_ARCHETYPE_COUNT; ++mask) {
+            archetypes[mask] = Archetype(mask);
+        }
+        eventBus.subscribe<TransformChangedEvent>([this](const std::vector<TransformChangedEvent> &events) {
+            for (auto &event : events) {
+                receive(event);
+            }
+        });
+        eventBus.subscribe<DrawableChangedEvent>([this](const std::vector<DrawableChangedEvent> &events) {
+            for (auto &event : events) {
+                receive(event);
+            }
+        });
+    }
+
+    void ChunkStorage::configure(entityx::EventManager &events) {
+        events.subscribe<entityx::ComponentAddedEvent<Transform>>(*this);
+        events.subscribe<entityx::ComponentAddedEvent<Drawable>>(*this);
+        events.subscribe<entityx::ComponentRemovedEvent<Transform>>(*this);
+        events.subscribe<entityx::ComponentRemovedEvent<Drawable>>(*this);
+    }
+
+    ChunkStorage::Location &ChunkStorage::locate(entityx::Entity::Id id) {
+        uint32_t index = id.index();
+        if (index >= locations.size()) {
+            locations.resize(index + 1, Location{0, 0, 0, 0});
+        }
+        return locations[index];
+    }
+
+    void ChunkStorage::move(
+            entityx::Entity entity,
+            uint8_t archetype,
+            const Transform *transform,
+            const Drawable *drawable
+    ) {
+        Location &location = locate(entity.id());
+        // Carry over the fields of the previous archetype that weren't given
+        Transform carriedTransform;
+        Drawable carriedDrawable;
+        version++;
+        if (location.archetype != 0) {
+            Archetype &previous = archetypes[location.archetype];
+            StorageChunk &chunk = *previous.getChunks()[location.chunk];
+            if (transform == nullptr && chunk.getPositions() != nullptr) {
+                carriedTransform = Transform(
+                        chunk.getPositions()[location.row],
+                        chunk.getRotations()[location.row],
+                        chunk.getScales()[location.row]
+                );
+                transform = &carriedTransform;
+            }
+            if (drawable == nullptr && chunk.getDrawables() != nullptr) {
+                carriedDrawable = chunk.getDrawables()[location.row];
+                drawable = &carriedDrawable;
+            }
+            entityx::Entity::Id moved = chunk.swapRemove(location.row);
+            if (moved != entity.id()) {
+                locate(moved).row = location.row;
+            }
+            chunk.setVersion(version);
+            previous.releaseRow(location.chunk);
+        }
+        if ((location.archetype | archetype) & eStorageDrawable) {
+            drawableVersion++;
+        }
+        location.archetype = archetype;
+        if (archetype == 0) {
+            return;
+        }
+        Archetype &next = archetypes[archetype];
+        size_t chunkCount = next.getChunks().size();
+        location.chunk = next.acquireChunk();
+        if (memoryTracker != nullptr && next.getChunks().size() > chunkCount) {
+            // Chunks live as long as the storage, so they are never reported freed
+            memoryTracker->hostAllocated(utility::eMemoryEcs, STORAGE_CHUNK_SIZE + STORAGE_CHUNK_ALIGNMENT);
+        }
+        StorageChunk &chunk = *next.getChunks()[location.chunk];
+        location.row = chunk.push(entity.id());
+        chunk.setVersion(version);
+        if (archetype & eStorageTransform) {
+            chunk.getPositions()[location.row] = transform->position;
+            chunk.getRotations()[location.row] = transform->rotation;
+            chunk.getScales()[location.row] = transform->scale;
+        }
+        if (archetype & eStorageDrawable) {
+            chunk.getDrawables()[location.row] = *drawable;
+        }
+    }
+
+    void ChunkStorage::receive(const entityx::ComponentAddedEvent<Transform> &event) {
+        uint8_t archetype = locate(event.entity.id()).archetype;
+        move(event.entity, archetype | eStorageTransform, event.component.get(), nullptr);
+    }
+
+    void ChunkStorage::receive(const entityx::ComponentAddedEvent<Drawable> &event) {
+        uint8_t archetype = locate(event.entity.id()).archetype;
+        move(event.entity, archetype | eStorageDrawable, nullptr, event.component.get());
+    }
+
+    void ChunkStorage::receive(const entityx::ComponentRemovedEvent<Transform> &event) {
+        uint8_t archetype = locate(event.entity.id()).archetype;
+        move(event.entity, archetype & ~eStorageTransform, nullptr, nullptr);
+    }
+
+    void ChunkStorage::receive(const entityx::ComponentRemovedEvent<Drawable> &event) {
+        uint8_t archetype = locate(event.entity.id()).archetype;
+        move(event.entity, archetype & ~eStorageDrawable, nullptr, nullptr);
+    }
+
+    void ChunkStorage::markDirty(entityx::Entity::Id id, StorageComponent component) {
+        Location &location = locate(id);
+        if ((location.dirty & component) || !(location.archetype & component)) {
+            return;
+        }
+        if (location.dirty == 0) {
+            dirty.push_back(id);
+        }
+        location.dirty |= component;
+    }
+
+    void ChunkStorage::receive(const TransformChangedEvent &event) {
+        markDirty(event.entity.id(), eStorageTransform);
+    }
+
+    void ChunkStorage::receive(const DrawableChangedEvent &event) {
+        markDirty(event.entity.id(), eStorageDrawable);
+    }
+
+    void ChunkStorage::update(
+            entityx::EntityManager &entities,
+            entityx::EventManager &events,
+            entityx::TimeDelta dt
+    ) {
+        for (entityx::Entity::Id id : dirty) {
+            Location &location = locate(id);
+            // The entity may have lost the components, or been destroyed and its index reused, since it was marked
+            uint8_t changed = location.dirty & location.archetype;
+            location.dirty = 0;
+            if (changed == 0 || !entities.valid(id)) {
+                continue;
+            }
+            StorageChunk &chunk = *archetypes[location.archetype].getChunks()[location.chunk];
+            if (chunk.getEntities()[location.row] != id) {
+                continue;
+            }
+            // The version the storage takes once every dirty row is copied
+            chunk.setVersion(version + 1);
+            if (changed & eStorageTransform) {
+                auto transform = entities.component<Transform>(id);
+                chunk.getPositions()[location.row] = transform->position;
+                chunk.getRotations()[location.row] = transform->rotation;
+                chunk.getScales()[location.row] = transform->scale;
+            }
+            if (changed & eStorageDrawable) {
+                chunk.getDrawables()[location.row] = *entities.component<Drawable>(id);
+                drawableVersion++;
+            }
+        }
+        if (!dirty.empty()) {
+            version++;
+            dirty.clear();
+        }
+    }
+
+    bool ChunkStorage::find(entityx::Entity::Id id, const StorageChunk *&chunk, uint32_t &row) const {
+        uint32_t index = id.index();
+        if (index >= locations.size() || locations[index].archetype == 0) {
+            return false;
+        }
+        const Location &location = locations[index];
+        chunk = archetypes[location.archetype].getChunks()[location.chunk].get();
+        row = location.row;
+        return chunk->getEntities()[row] == id;
+    }
+
+    const Archetype &ChunkStorage::getArchetype(uint8_t mask) const {
+        return archetypes[mask];
+    }
+
+    uint64_t ChunkStorage::getVersion() const {
+        return version;
+    }
+
+    uint64_t ChunkStorage::getDrawableVersion() const {
+        return drawableVersion;
+    }
+}
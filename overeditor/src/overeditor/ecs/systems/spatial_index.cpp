@@ -0,0 +1,387 @@
+#include <overeditor/ecs/systems/spatial_index.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace overeditor::systems::spatial {
+
+    /**
+     * Narrows [near, far] to where the ray is between min and max along one axis
+     */
+    static bool clipSlab(float origin, float inverse, float min, float max, float &near, float &far) {
+        float t0 = (min - origin) * inverse;
+        float t1 = (max - origin) * inverse;
+        if (t0 > t1) {
+            std::swap(t0, t1);
+        }
+        near = std::max(near, t0);
+        far = std::min(far, t1);
+        return near <= far;
+    }
+
+    static bool intersectRay(
+            const glm::vec3 &origin,
+            const glm::vec3 &inverse,
+            const glm::vec3 &min,
+            const glm::vec3 &max,
+            float limit,
+            float &distance
+    ) {
+        float near = 0, far = limit;
+        if (!clipSlab(origin.x, inverse.x, min.x, max.x, near, far)
+            || !clipSlab(origin.y, inverse.y, min.y, max.y, near, far)
+            || !clipSlab(origin.z, inverse.z, min.z, max.z, near, far)) {
+            return false;
+        }
+        distance = near;
+        return true;
+    }
+
+    static bool overlaps(const glm::vec3 &minA, const glm::vec3 &maxA, const glm::vec3 &minB, const glm::vec3 &maxB) {
+        return minA.x <= maxB.x && maxA.x >= minB.x
+               && minA.y <= maxB.y && maxA.y >= minB.y
+               && minA.z <= maxB.z && maxA.z >= minB.z;
+    }
+
+    static float getRadius(const glm::vec3 &min, const glm::vec3 &max) {
+        glm::vec3 extent = (max - min) * 0.5F;
+        return std::max(extent.x, std::max(extent.y, extent.z));
+    }
+
+    static uint32_t getOctant(const glm::vec3 &center, const glm::vec3 &point) {
+        return (point.x >= center.x ? 1U : 0U) | (point.y >= center.y ? 2U : 0U) | (point.z >= center.z ? 4U : 0U);
+    }
+
+    static glm::vec3 getChildCenter(const glm::vec3 &center, float childHalfSize, uint32_t octant) {
+        return center + glm::vec3(
+                octant & 1 ? childHalfSize : -childHalfSize,
+                octant & 2 ? childHalfSize : -childHalfSize,
+                octant & 4 ? childHalfSize : -childHalfSize
+        );
+    }
+
+    SpatialIndex::SpatialIndex(
+            const overeditor::systems::transforms::TransformHierarchy &hierarchy,
+            utility::ThreadPool &pool
+    ) : hierarchy(&hierarchy), pool(&pool), nodes(), items(), maxDepth(0),
+        hierarchyVersion(UINT64_MAX), statistics() {}
+
+    SpatialIndex::Node SpatialIndex::makeNode(const glm::vec3 &center, float halfSize) {
+        Node node;
+        node.center = center;
+        node.halfSize = halfSize;
+        std::fill(node.children, node.children + 8, SPATIAL_INDEX_NONE);
+        return node;
+    }
+
+    void SpatialIndex::computeBounds(const glm::mat4 &world, glm::vec3 &min, glm::vec3 &max) {
+        // The unit cube transformed by world, boxed
+        glm::vec3 center(world[3]);
+        glm::vec3 extent(
+                std::fabs(world[0].x) + std::fabs(world[1].x) + std::fabs(world[2].x),
+                std::fabs(world[0].y) + std::fabs(world[1].y) + std::fabs(world[2].y),
+                std::fabs(world[0].z) + std::fabs(world[1].z) + std::fabs(world[2].z)
+        );
+        min = center - extent;
+        max = center + extent;
+    }
+
+    uint32_t SpatialIndex::descend(
+            std::vector<Node> &nodes,
+            uint32_t node,
+            uint32_t depth,
+            uint32_t maxDepth,
+            const Item &item
+    ) {
+        glm::vec3 center = (item.min + item.max) * 0.5F;
+        float radius = getRadius(item.min, item.max);
+        while (depth < maxDepth) {
+            float childHalfSize = nodes[node].halfSize * 0.5F;
+            // Loose bounds are twice the cell, so anything up to the cell's size fits wherever its center is
+            if (radius > childHalfSize) {
+                break;
+            }
+            uint32_t octant = getOctant(nodes[node].center, center);
+            uint32_t child = nodes[node].children[octant];
+            if (child == SPATIAL_INDEX_NONE) {
+                child = (uint32_t) nodes.size();
+                glm::vec3 childCenter = getChildCenter(nodes[node].center, childHalfSize, octant);
+                nodes.push_back(makeNode(childCenter, childHalfSize));
+                nodes[node].children[octant] = child;
+            }
+            node = child;
+            depth++;
+        }
+        return node;
+    }
+
+    void SpatialIndex::attach(std::vector<Node> &nodes, uint32_t node, std::vector<Item> &items, uint32_t item) {
+        items[item].node = node;
+        items[item].slot = (uint32_t) nodes[node].items.size();
+        nodes[node].items.push_back(item);
+    }
+
+    void SpatialIndex::detach(uint32_t item) {
+        std::vector<uint32_t> &siblings = nodes[items[item].node].items;
+        uint32_t slot = items[item].slot;
+        uint32_t last = siblings.back();
+        siblings[slot] = last;
+        items[last].slot = slot;
+        siblings.pop_back();
+    }
+
+    bool SpatialIndex::isOutsideRoot(const Item &item) const {
+        const Node &root = nodes[0];
+        glm::vec3 offset = (item.min + item.max) * 0.5F - root.center;
+        return std::fabs(offset.x) > root.halfSize || std::fabs(offset.y) > root.halfSize
+               || std::fabs(offset.z) > root.halfSize;
+    }
+
+    void SpatialIndex::rebuild() {
+        const auto &order = hierarchy->getOrder();
+        const auto &worldMatrices = hierarchy->getWorldMatrices();
+        size_t count = order.size();
+        items.resize(count);
+        nodes.clear();
+        size_t grain = std::max<size_t>(1024, count / (pool->getWorkerCount() * 4 + 1));
+        pool->parallelFor(count, grain, [this, &order, &worldMatrices](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                items[i].entity = order[i];
+                computeBounds(worldMatrices[i], items[i].min, items[i].max);
+            }
+        });
+        // The root cell is fitted around every center, with some room to move before leaving it
+        glm::vec3 low(0), high(0);
+        if (count > 0) {
+            low = glm::vec3(std::numeric_limits<float>::max());
+            high = glm::vec3(-std::numeric_limits<float>::max());
+        }
+        for (const Item &item : items) {
+            glm::vec3 center = (item.min + item.max) * 0.5F;
+            low = glm::min(low, center);
+            high = glm::max(high, center);
+        }
+        glm::vec3 size = high - low;
+        float halfSize = std::max(1.0F, std::max(size.x, std::max(size.y, size.z)) * 0.5F * 1.25F);
+        nodes.push_back(makeNode((low + high) * 0.5F, halfSize));
+        maxDepth = 0;
+        while (maxDepth < SPATIAL_INDEX_MAX_DEPTH && (1ULL << (2 * maxDepth)) * SPATIAL_INDEX_LEAF_ITEMS < count) {
+            maxDepth++;
+        }
+        // Items too large for an octant stay in the root, every octant is then built on its own
+        std::vector<uint32_t> octantItems[8];
+        for (uint32_t i = 0; i < count; ++i) {
+            if (getRadius(items[i].min, items[i].max) > halfSize * 0.5F) {
+                attach(nodes, 0, items, i);
+            } else {
+                octantItems[getOctant(nodes[0].center, (items[i].min + items[i].max) * 0.5F)].push_back(i);
+            }
+        }
+        std::vector<Node> octantNodes[8];
+        const glm::vec3 rootCenter = nodes[0].center;
+        pool->parallelFor(8, 1, [&](size_t begin, size_t end) {
+            for (size_t octant = begin; octant < end; ++octant) {
+                if (octantItems[octant].empty()) {
+                    continue;
+                }
+                std::vector<Node> &local = octantNodes[octant];
+                local.push_back(makeNode(
+                        getChildCenter(rootCenter, halfSize * 0.5F, (uint32_t) octant), halfSize * 0.5F
+                ));
+                // Every item belongs to a single octant, so the tasks write disjoint items
+                for (uint32_t item : octantItems[octant]) {
+                    attach(local, descend(local, 0, 1, maxDepth, items[item]), items, item);
+                }
+            }
+        });
+        for (uint32_t octant = 0; octant < 8; ++octant) {
+            if (octantNodes[octant].empty()) {
+                continue;
+            }
+            auto offset = (uint32_t) nodes.size();
+            nodes[0].children[octant] = offset;
+            for (Node &node : octantNodes[octant]) {
+                for (uint32_t &child : node.children) {
+                    if (child != SPATIAL_INDEX_NONE) {
+                        child += offset;
+                    }
+                }
+                for (uint32_t item : node.items) {
+                    items[item].node += offset;
+                }
+                nodes.push_back(std::move(node));
+            }
+        }
+        statistics.overflowCount = 0;
+        statistics.rebuilt = true;
+    }
+
+    void SpatialIndex::refresh(uint32_t begin, uint32_t end) {
+        const auto &worldMatrices = hierarchy->getWorldMatrices();
+        for (uint32_t i = begin; i < end; ++i) {
+            Item &item = items[i];
+            if (item.node == 0 && isOutsideRoot(item)) {
+                statistics.overflowCount--;
+            }
+            detach(i);
+            computeBounds(worldMatrices[i], item.min, item.max);
+            uint32_t node = 0;
+            if (isOutsideRoot(item)) {
+                statistics.overflowCount++;
+            } else {
+                node = descend(nodes, 0, 0, maxDepth, item);
+            }
+            attach(nodes, node, items, i);
+        }
+    }
+
+    void SpatialIndex::update(
+            entityx::EntityManager &entities,
+            entityx::EventManager &events,
+            entityx::TimeDelta dt
+    ) {
+        statistics.rebuilt = false;
+        statistics.updatedCount = 0;
+        uint64_t version = hierarchy->getVersion();
+        size_t count = hierarchy->getOrder().size();
+        if (version == hierarchyVersion && items.size() == count) {
+            return;
+        }
+        // Missed updates, a new order or too many items outside the root can't be patched
+        if (version != hierarchyVersion + 1 || hierarchy->getStatistics().rebuilt || items.size() != count
+            || statistics.overflowCount > count / 8 + 64) {
+            rebuild();
+            statistics.updatedCount = count;
+        } else {
+            for (auto &range : hierarchy->getRecomputedRanges()) {
+                refresh(range.first, range.second);
+                statistics.updatedCount += range.second - range.first;
+            }
+        }
+        hierarchyVersion = version;
+        statistics.itemCount = items.size();
+        statistics.nodeCount = nodes.size();
+    }
+
+    template<typename Test, typename Visit>
+    void SpatialIndex::traverse(Test test, Visit visit) const {
+        if (nodes.empty()) {
+            return;
+        }
+        // Every visited node pushes at most 8 children and pops itself
+        uint32_t pending[8 * (SPATIAL_INDEX_MAX_DEPTH + 1)];
+        size_t count = 0;
+        pending[count++] = 0;
+        while (count > 0) {
+            const Node &node = nodes[pending[--count]];
+            for (uint32_t item : node.items) {
+                visit(items[item]);
+            }
+            for (uint32_t child : node.children) {
+                if (child == SPATIAL_INDEX_NONE) {
+                    continue;
+                }
+                const Node &candidate = nodes[child];
+                glm::vec3 loose(candidate.halfSize * 2);
+                if (test(candidate.center - loose, candidate.center + loose)) {
+                    pending[count++] = child;
+                }
+            }
+        }
+    }
+
+    bool SpatialIndex::raycast(
+            const glm::vec3 &origin,
+            const glm::vec3 &direction,
+            float maxDistance,
+            RayHit &hit
+    ) const {
+        if (nodes.empty()) {
+            return false;
+        }
+        glm::vec3 inverse(1.0F / direction.x, 1.0F / direction.y, 1.0F / direction.z);
+        float nearest = maxDistance;
+        bool found = false;
+        // Nodes with the distance the ray enters them at, children pushed farthest first so the nearest is
+        // visited first and everything behind the closest hit so far is skipped
+        std::pair<uint32_t, float> pending[8 * (SPATIAL_INDEX_MAX_DEPTH + 1)];
+        size_t count = 0;
+        pending[count++] = std::make_pair(0U, 0.0F);
+        while (count > 0) {
+            auto[index, entry] = pending[--count];
+            if (found && entry > nearest) {
+                continue;
+            }
+            const Node &node = nodes[index];
+            for (uint32_t item : node.items) {
+                const Item &candidate = items[item];
+                float distance;
+                if (intersectRay(origin, inverse, candidate.min, candidate.max, nearest, distance)
+                    && (!found || distance < nearest)) {
+                    nearest = distance;
+                    hit.entity = candidate.entity;
+                    hit.distance = distance;
+                    found = true;
+                }
+            }
+            std::pair<uint32_t, float> children[8];
+            size_t childCount = 0;
+            for (uint32_t child : node.children) {
+                if (child == SPATIAL_INDEX_NONE) {
+                    continue;
+                }
+                const Node &candidate = nodes[child];
+                glm::vec3 loose(candidate.halfSize * 2);
+                glm::vec3 min = candidate.center - loose, max = candidate.center + loose;
+                float distance;
+                if (intersectRay(origin, inverse, min, max, nearest, distance)) {
+                    children[childCount++] = std::make_pair(child, distance);
+                }
+            }
+            std::sort(children, children + childCount, [](const auto &a, const auto &b) {
+                return a.second > b.second;
+            });
+            std::copy(children, children + childCount, pending + count);
+            count += childCount;
+        }
+        return found;
+    }
+
+    void SpatialIndex::queryBox(
+            const glm::vec3 &min,
+            const glm::vec3 &max,
+            std::vector<entityx::Entity::Id> &result
+    ) const {
+        traverse(
+                [&](const glm::vec3 &nodeMin, const glm::vec3 &nodeMax) {
+                    return overlaps(min, max, nodeMin, nodeMax);
+                },
+                [&](const Item &item) {
+                    if (overlaps(min, max, item.min, item.max)) {
+                        result.push_back(item.entity);
+                    }
+                }
+        );
+    }
+
+    void SpatialIndex::queryFrustum(
+            const overeditor::graphics::Frustum &frustum,
+            std::vector<entityx::Entity::Id> &result
+    ) const {
+        traverse(
+                [&](const glm::vec3 &nodeMin, const glm::vec3 &nodeMax) {
+                    return frustum.intersectsBox(nodeMin, nodeMax);
+                },
+                [&](const Item &item) {
+                    if (frustum.intersectsBox(item.min, item.max)) {
+                        result.push_back(item.entity);
+                    }
+                }
+        );
+    }
+
+    const SpatialIndexStatistics &SpatialIndex::getStatistics() const {
+        return statistics;
+    }
+}
@@ -0,0 +1,244 @@
+#include <overeditor/ecs/systems/transform_hierarchy.h>
+#include <plog/Log.h>
+
+#include <algorithm>
+
+namespace overeditor::systems::transforms {
+
+    TransformHierarchy::TransformHierarchy(utility::ThreadPool &pool, utility::EventBus &eventBus)
+            : pool(&pool), order(), parents(), subtreeSizes(), positions(), rotations(), scales(), worldMatrices(),
+              positionsByIndex(), changed(), recomputed(), structureDirty(true), version(0), statistics() {
+        eventBus.subscribe<TransformChangedEvent>([this](const std::vector<TransformChangedEvent> &events) {
+            for (auto &event : events) {
+                receive(event);
+            }
+        });
+    }
+
+    void TransformHierarchy::configure(entityx::EventManager &events) {
+        events.subscribe<entityx::ComponentAddedEvent<Transform>>(*this);
+        events.subscribe<entityx::ComponentRemovedEvent<Transform>>(*this);
+        events.subscribe<entityx::ComponentAddedEvent<Parent>>(*this);
+        events.subscribe<entityx::ComponentRemovedEvent<Parent>>(*this);
+    }
+
+    void TransformHierarchy::receive(const entityx::ComponentAddedEvent<Transform> &event) {
+        structureDirty = true;
+    }
+
+    void TransformHierarchy::receive(const entityx::ComponentRemovedEvent<Transform> &event) {
+        structureDirty = true;
+    }
+
+    void TransformHierarchy::receive(const entityx::ComponentAddedEvent<Parent> &event) {
+        structureDirty = true;
+    }
+
+    void TransformHierarchy::receive(const entityx::ComponentRemovedEvent<Parent> &event) {
+        structureDirty = true;
+    }
+
+    void TransformHierarchy::receive(const TransformChangedEvent &event) {
+        if (!structureDirty) {
+            changed.push_back(event.entity.id());
+        }
+    }
+
+    glm::mat4 TransformHierarchy::compose(const glm::vec3 &position, const glm::quat &rotation, const glm::vec3 &scale) {
+        glm::mat4 matrix = glm::mat4_cast(rotation);
+        matrix[0] = matrix[0] * scale.x;
+        matrix[1] = matrix[1] * scale.y;
+        matrix[2] = matrix[2] * scale.z;
+        matrix[3] = glm::vec4(position, 1);
+        return matrix;
+    }
+
+    void TransformHierarchy::rebuild(entityx::EntityManager &entities) {
+        std::vector<entityx::Entity::Id> nodes;
+        for (entityx::Entity entity : entities.entities_with_components<Transform>()) {
+            nodes.push_back(entity.id());
+        }
+        // Children lists, linked through entity indices
+        size_t capacity = positionsByIndex.size();
+        for (auto id : nodes) {
+            capacity = std::max<size_t>(capacity, id.index() + 1);
+        }
+        std::vector<uint32_t> firstChild(capacity, TRANSFORM_HIERARCHY_NO_PARENT);
+        std::vector<uint32_t> nextSibling(capacity, TRANSFORM_HIERARCHY_NO_PARENT);
+        std::vector<entityx::Entity::Id> idsByIndex(capacity);
+        std::vector<entityx::Entity::Id> roots;
+        for (auto id : nodes) {
+            idsByIndex[id.index()] = id;
+            auto parent = entities.component<Parent>(id);
+            if (parent && parent->entity.valid() && parent->entity.id() != id &&
+                parent->entity.has_component<Transform>()) {
+                uint32_t parentIndex = parent->entity.id().index();
+                nextSibling[id.index()] = firstChild[parentIndex];
+                firstChild[parentIndex] = id.index();
+            } else {
+                roots.push_back(id);
+            }
+        }
+        positionsByIndex.assign(capacity, TRANSFORM_HIERARCHY_NO_PARENT);
+        order.clear();
+        parents.clear();
+        order.reserve(nodes.size());
+        parents.reserve(nodes.size());
+        // Pre-order depth-first traversal with an explicit stack of (index, parent position)
+        std::vector<std::pair<uint32_t, uint32_t>> pending;
+        auto traverse = [&](entityx::Entity::Id root) {
+            pending.emplace_back(root.index(), TRANSFORM_HIERARCHY_NO_PARENT);
+            while (!pending.empty()) {
+                auto[index, parent] = pending.back();
+                pending.pop_back();
+                if (positionsByIndex[index] != TRANSFORM_HIERARCHY_NO_PARENT) {
+                    continue;
+                }
+                positionsByIndex[index] = (uint32_t) order.size();
+                order.push_back(idsByIndex[index]);
+                parents.push_back(parent);
+                for (uint32_t child = firstChild[index];
+                     child != TRANSFORM_HIERARCHY_NO_PARENT; child = nextSibling[child]) {
+                    pending.emplace_back(child, positionsByIndex[index]);
+                }
+            }
+        };
+        for (auto root : roots) {
+            traverse(root);
+        }
+        // Whatever wasn't reached is part of a parent cycle, break it at the first node found
+        if (order.size() != nodes.size()) {
+            LOG_WARNING << "Transform hierarchy has " << nodes.size() - order.size()
+                        << " entities in parent cycles, they are treated as roots";
+            for (auto id : nodes) {
+                if (positionsByIndex[id.index()] == TRANSFORM_HIERARCHY_NO_PARENT) {
+                    traverse(id);
+                }
+            }
+        }
+        size_t count = order.size();
+        subtreeSizes.assign(count, 1);
+        // Parents precede their children, so walking backwards accumulates whole subtrees
+        for (size_t i = count; i-- > 0;) {
+            if (parents[i] != TRANSFORM_HIERARCHY_NO_PARENT) {
+                subtreeSizes[parents[i]] += subtreeSizes[i];
+            }
+        }
+        positions.resize(count);
+        rotations.resize(count);
+        scales.resize(count);
+        worldMatrices.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            auto transform = entities.component<Transform>(order[i]);
+            positions[i] = transform->position;
+            rotations[i] = transform->rotation;
+            scales[i] = transform->scale;
+        }
+        structureDirty = false;
+        statistics.rebuilt = true;
+    }
+
+    void TransformHierarchy::recompute(uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            glm::mat4 local = compose(positions[i], rotations[i], scales[i]);
+            uint32_t parent = parents[i];
+            worldMatrices[i] = parent == TRANSFORM_HIERARCHY_NO_PARENT ? local : worldMatrices[parent] * local;
+        }
+    }
+
+    void TransformHierarchy::update(
+            entityx::EntityManager &entities,
+            entityx::EventManager &events,
+            entityx::TimeDelta dt
+    ) {
+        statistics.rebuilt = false;
+        statistics.recomputedCount = 0;
+        statistics.subtreeCount = 0;
+        // Subtree ranges to recompute, disjoint and in ascending order
+        std::vector<std::pair<uint32_t, uint32_t>> &ranges = recomputed;
+        ranges.clear();
+        if (structureDirty) {
+            rebuild(entities);
+            for (uint32_t i = 0; i < order.size(); i += subtreeSizes[i]) {
+                ranges.emplace_back(i, i + subtreeSizes[i]);
+            }
+        } else if (!changed.empty()) {
+            std::vector<uint32_t> dirty;
+            dirty.reserve(changed.size());
+            for (auto id : changed) {
+                if (!contains(id)) {
+                    continue;
+                }
+                uint32_t position = positionsByIndex[id.index()];
+                auto transform = entities.component<Transform>(id);
+                positions[position] = transform->position;
+                rotations[position] = transform->rotation;
+                scales[position] = transform->scale;
+                dirty.push_back(position);
+            }
+            std::sort(dirty.begin(), dirty.end());
+            uint32_t coveredUntil = 0;
+            for (uint32_t position : dirty) {
+                // Nodes inside an already dirty subtree are recomputed with it
+                if (!ranges.empty() && position < coveredUntil) {
+                    continue;
+                }
+                coveredUntil = position + subtreeSizes[position];
+                ranges.emplace_back(position, coveredUntil);
+            }
+        }
+        changed.clear();
+        if (ranges.empty()) {
+            return;
+        }
+        size_t grain = std::max<size_t>(1, ranges.size() / (pool->getWorkerCount() * 4));
+        pool->parallelFor(ranges.size(), grain, [this, &ranges](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                recompute(ranges[i].first, ranges[i].second);
+            }
+        });
+        for (auto &range : ranges) {
+            statistics.recomputedCount += range.second - range.first;
+        }
+        statistics.subtreeCount = (uint32_t) ranges.size();
+        statistics.nodeCount = (uint32_t) order.size();
+        version++;
+    }
+
+    bool TransformHierarchy::contains(entityx::Entity::Id id) const {
+        uint32_t index = id.index();
+        if (index >= positionsByIndex.size()) {
+            return false;
+        }
+        uint32_t position = positionsByIndex[index];
+        return position != TRANSFORM_HIERARCHY_NO_PARENT && order[position] == id;
+    }
+
+    const glm::mat4 &TransformHierarchy::getWorldMatrix(entityx::Entity::Id id) const {
+        return worldMatrices[positionsByIndex[id.index()]];
+    }
+
+    const std::vector<entityx::Entity::Id> &TransformHierarchy::getOrder() const {
+        return order;
+    }
+
+    const std::vector<uint32_t> &TransformHierarchy::getParents() const {
+        return parents;
+    }
+
+    const std::vector<glm::mat4> &TransformHierarchy::getWorldMatrices() const {
+        return worldMatrices;
+    }
+
+    const std::vector<std::pair<uint32_t, uint32_t>> &TransformHierarchy::getRecomputedRanges() const {
+        return recomputed;
+    }
+
+    uint64_t TransformHierarchy::getVersion() const {
+        return version;
+    }
+
+    const TransformHierarchyStatistics &TransformHierarchy::getStatistics() const {
+        return statistics;
+    }
+}
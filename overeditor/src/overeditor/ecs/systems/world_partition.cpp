@@ -0,0 +1,251 @@
+#include <overeditor/ecs/systems/world_partition.h>
+#include <plog/Log.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace overeditor::systems::world {
+
+    WorldPartition::WorldPartition(
+            const std::shared_ptr<CellSource> &source,
+            const WorldPartitionSettings &settings
+    ) : source(source), settings(settings), statistics(), focus(), cells(), pendingLoads(0),
+        completedMutex(), completed(), worker() {
+        if (settings.unloadRadius <= settings.loadRadius) {
+            throw std::runtime_error("World partition unload radius must be larger than its load radius");
+        }
+    }
+
+    float WorldPartition::distanceTo(const CellCoordinate &coordinate) const {
+        glm::vec2 center(
+                (coordinate.x + 0.5F) * settings.cellSize,
+                (coordinate.z + 0.5F) * settings.cellSize
+        );
+        return glm::length(center - glm::vec2(focus.x, focus.z));
+    }
+
+    CellCoordinate WorldPartition::getCellAt(const glm::vec3 &position) const {
+        return CellCoordinate{
+                (int32_t) std::floor(position.x / settings.cellSize),
+                (int32_t) std::floor(position.z / settings.cellSize)
+        };
+    }
+
+    std::vector<CellCoordinate> WorldPartition::sortedByDistance(CellState state) const {
+        std::vector<CellCoordinate> result;
+        for (auto &pair : cells) {
+            if (pair.second.state == state) {
+                result.push_back(pair.first);
+            }
+        }
+        std::sort(result.begin(), result.end(), [this](const CellCoordinate &a, const CellCoordinate &b) {
+            return distanceTo(a) < distanceTo(b);
+        });
+        return result;
+    }
+
+    void WorldPartition::collectLoads() {
+        std::deque<CompletedLoad> loads;
+        {
+            std::lock_guard<std::mutex> lock(completedMutex);
+            loads.swap(completed);
+        }
+        for (CompletedLoad &load : loads) {
+            pendingLoads--;
+            auto &cell = cells[load.coordinate];
+            if (!cell.wanted) {
+                // Left the load radius while loading
+                if (load.content) {
+                    load.content->release();
+                }
+                cells.erase(load.coordinate);
+                continue;
+            }
+            cell.content = std::move(load.content);
+            cell.state = cell.content ? CellState::eInstantiating : CellState::eResident;
+            if (cell.content) {
+                cell.entities.reserve(cell.content->getEntityCount());
+            }
+        }
+    }
+
+    void WorldPartition::requestCells() {
+        // Mark cells that left the unload radius
+        for (auto &pair : cells) {
+            if (distanceTo(pair.first) > settings.unloadRadius) {
+                pair.second.wanted = false;
+                if (pair.second.state != CellState::eLoading) {
+                    pair.second.state = CellState::eUnloading;
+                }
+            }
+        }
+        if (!source) {
+            return;
+        }
+        // Gather missing cells inside the load radius, nearest first
+        auto center = getCellAt(focus);
+        auto reach = (int32_t) std::ceil(settings.loadRadius / settings.cellSize);
+        std::vector<CellCoordinate> missing;
+        for (int32_t x = center.x - reach; x <= center.x + reach; ++x) {
+            for (int32_t z = center.z - reach; z <= center.z + reach; ++z) {
+                CellCoordinate coordinate{x, z};
+                if (distanceTo(coordinate) <= settings.loadRadius && cells.find(coordinate) == cells.end()) {
+                    missing.push_back(coordinate);
+                }
+            }
+        }
+        std::sort(missing.begin(), missing.end(), [this](const CellCoordinate &a, const CellCoordinate &b) {
+            return distanceTo(a) < distanceTo(b);
+        });
+        size_t loadedCells = 0;
+        for (auto &pair : cells) {
+            if (pair.second.content) {
+                loadedCells++;
+            }
+        }
+        size_t averageCellMemory = loadedCells == 0 ? 0 : statistics.memoryUsage / loadedCells;
+        for (const CellCoordinate &coordinate : missing) {
+            if (pendingLoads >= settings.maxPendingLoads ||
+                statistics.memoryUsage + averageCellMemory * (pendingLoads + 1) > settings.memoryBudget) {
+                break;
+            }
+            auto &cell = cells[coordinate];
+            cell.state = CellState::eLoading;
+            cell.wanted = true;
+            pendingLoads++;
+            auto cellSource = source;
+            worker.enqueue([this, cellSource, coordinate] {
+                CompletedLoad load{coordinate, cellSource->load(coordinate)};
+                std::lock_guard<std::mutex> lock(completedMutex);
+                completed.push_back(std::move(load));
+            });
+        }
+    }
+
+    void WorldPartition::enforceBudget() {
+        size_t usage = 0, retained = 0;
+        for (auto &pair : cells) {
+            if (pair.second.content) {
+                usage += pair.second.content->getMemoryUsage();
+                if (pair.second.state != CellState::eUnloading) {
+                    retained += pair.second.content->getMemoryUsage();
+                }
+            }
+        }
+        statistics.memoryUsage = usage;
+        if (retained <= settings.memoryBudget) {
+            return;
+        }
+        LOG_WARNING << "World partition is over its memory budget (" << retained << " / "
+                    << settings.memoryBudget << " bytes), unloading farthest cells";
+        // Unload the farthest cells until the remaining ones fit. Cells inside the load radius are kept, since
+        // requestCells would load them right back, and no new cell is requested while over budget.
+        std::vector<CellCoordinate> candidates = sortedByDistance(CellState::eResident);
+        auto instantiating = sortedByDistance(CellState::eInstantiating);
+        candidates.insert(candidates.end(), instantiating.begin(), instantiating.end());
+        std::sort(candidates.begin(), candidates.end(), [this](const CellCoordinate &a, const CellCoordinate &b) {
+            return distanceTo(a) > distanceTo(b);
+        });
+        for (const CellCoordinate &coordinate : candidates) {
+            if (retained <= settings.memoryBudget || distanceTo(coordinate) <= settings.loadRadius) {
+                // Sorted farthest first, every cell left is inside the load radius too
+                break;
+            }
+            auto &cell = cells[coordinate];
+            if (cell.content) {
+                retained -= cell.content->getMemoryUsage();
+            }
+            cell.state = CellState::eUnloading;
+            cell.wanted = false;
+        }
+    }
+
+    void WorldPartition::instantiateCells(entityx::EntityManager &entities) {
+        size_t remaining = settings.maxCreationsPerFrame;
+        for (const CellCoordinate &coordinate : sortedByDistance(CellState::eInstantiating)) {
+            auto &cell = cells[coordinate];
+            size_t count = cell.content->getEntityCount();
+            while (cell.entities.size() < count && remaining > 0) {
+                auto entity = entities.create();
+                cell.content->instantiate(cell.entities.size(), entity);
+                cell.entities.push_back(entity);
+                remaining--;
+            }
+            if (cell.entities.size() == count) {
+                cell.state = CellState::eResident;
+            }
+            if (remaining == 0) {
+                break;
+            }
+        }
+        statistics.createdEntities = settings.maxCreationsPerFrame - remaining;
+    }
+
+    void WorldPartition::destroyCells() {
+        size_t remaining = settings.maxDestructionsPerFrame;
+        auto unloading = sortedByDistance(CellState::eUnloading);
+        // Farthest cells go first
+        std::reverse(unloading.begin(), unloading.end());
+        for (const CellCoordinate &coordinate : unloading) {
+            auto &cell = cells[coordinate];
+            while (!cell.entities.empty() && remaining > 0) {
+                auto entity = cell.entities.back();
+                if (entity.valid()) {
+                    entity.destroy();
+                }
+                cell.entities.pop_back();
+                remaining--;
+            }
+            if (cell.entities.empty()) {
+                if (cell.content) {
+                    cell.content->release();
+                }
+                cells.erase(coordinate);
+            }
+            if (remaining == 0) {
+                break;
+            }
+        }
+        statistics.destroyedEntities = settings.maxDestructionsPerFrame - remaining;
+    }
+
+    void WorldPartition::update(
+            entityx::EntityManager &entities,
+            entityx::EventManager &events,
+            entityx::TimeDelta dt
+    ) {
+        collectLoads();
+        requestCells();
+        enforceBudget();
+        instantiateCells(entities);
+        destroyCells();
+        statistics.residentCells = 0;
+        statistics.loadingCells = pendingLoads;
+        for (auto &pair : cells) {
+            if (pair.second.state == CellState::eResident) {
+                statistics.residentCells++;
+            }
+        }
+    }
+
+    void WorldPartition::setSource(const std::shared_ptr<CellSource> &source) {
+        WorldPartition::source = source;
+    }
+
+    void WorldPartition::setFocus(const glm::vec3 &focus) {
+        WorldPartition::focus = focus;
+    }
+
+    bool WorldPartition::isResident(const CellCoordinate &coordinate) const {
+        auto found = cells.find(coordinate);
+        return found != cells.end() && found->second.state == CellState::eResident;
+    }
+
+    const WorldPartitionSettings &WorldPartition::getSettings() const {
+        return settings;
+    }
+
+    const WorldPartitionStatistics &WorldPartition::getStatistics() const {
+        return statistics;
+    }
+}
@@ -0,0 +1,199 @@
+#include <overeditor/editing/journal.h>
+
+namespace overeditor::editing {
+
+    TransformEntry::TransformEntry(entityx::EntityManager &entities, const Selection &selection, uint8_t fields)
+            : selection(selection), fields(fields) {
+        read(entities, oldPositions, oldRotations, oldScales);
+    }
+
+    void TransformEntry::read(
+            entityx::EntityManager &entities,
+            std::vector<glm::vec3> &positions,
+            std::vector<glm::quat> &rotations,
+            std::vector<glm::vec3> &scales
+    ) const {
+        size_t count = selection->size();
+        if (fields & eTransformPosition) {
+            positions.resize(count);
+        }
+        if (fields & eTransformRotation) {
+            rotations.resize(count);
+        }
+        if (fields & eTransformScale) {
+            scales.resize(count);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (!entities.valid((*selection)[i])) {
+                continue;
+            }
+            auto transform = entities.component<Transform>((*selection)[i]);
+            if (!transform) {
+                continue;
+            }
+            if (fields & eTransformPosition) {
+                positions[i] = transform->position;
+            }
+            if (fields & eTransformRotation) {
+                rotations[i] = transform->rotation;
+            }
+            if (fields & eTransformScale) {
+                scales[i] = transform->scale;
+            }
+        }
+    }
+
+    void TransformEntry::apply(
+            entityx::EntityManager &entities,
+            utility::EventBus &eventBus,
+            const std::vector<glm::vec3> &positions,
+            const std::vector<glm::quat> &rotations,
+            const std::vector<glm::vec3> &scales
+    ) const {
+        size_t count = selection->size();
+        for (size_t i = 0; i < count; ++i) {
+            // Entities destroyed since the edit are skipped
+            if (!entities.valid((*selection)[i])) {
+                continue;
+            }
+            auto transform = entities.component<Transform>((*selection)[i]);
+            if (!transform) {
+                continue;
+            }
+            if (fields & eTransformPosition) {
+                transform->position = positions[i];
+            }
+            if (fields & eTransformRotation) {
+                transform->rotation = rotations[i];
+            }
+            if (fields & eTransformScale) {
+                transform->scale = scales[i];
+            }
+            eventBus.publish((*selection)[i].id(), TransformChangedEvent(entities.get((*selection)[i])));
+        }
+    }
+
+    void TransformEntry::complete(entityx::EntityManager &entities) {
+        read(entities, newPositions, newRotations, newScales);
+    }
+
+    void TransformEntry::undo(entityx::EntityManager &entities, utility::EventBus &eventBus) {
+        apply(entities, eventBus, oldPositions, oldRotations, oldScales);
+    }
+
+    void TransformEntry::redo(entityx::EntityManager &entities, utility::EventBus &eventBus) {
+        apply(entities, eventBus, newPositions, newRotations, newScales);
+    }
+
+    size_t TransformEntry::getMemoryUsage() const {
+        return sizeof(*this) +
+               (oldPositions.capacity() + newPositions.capacity()) * sizeof(glm::vec3) +
+               (oldRotations.capacity() + newRotations.capacity()) * sizeof(glm::quat) +
+               (oldScales.capacity() + newScales.capacity()) * sizeof(glm::vec3) +
+               selection->capacity() * sizeof(entityx::Entity::Id) / selection.use_count();
+    }
+
+    bool TransformEntry::merge(const JournalEntry &newer) {
+        auto other = dynamic_cast<const TransformEntry *>(&newer);
+        if (other == nullptr || other->fields != fields ||
+            (other->selection != selection && *other->selection != *selection)) {
+            return false;
+        }
+        // Keep the values from before the gesture started, take the latest edited ones
+        newPositions = other->newPositions;
+        newRotations = other->newRotations;
+        newScales = other->newScales;
+        return true;
+    }
+
+    Journal::Journal(entityx::EntityManager &entities, utility::EventBus &eventBus, size_t memoryCap)
+            : entities(&entities), eventBus(&eventBus), history(), undone(), memoryUsage(0), memoryCap(memoryCap),
+              openGesture(0) {}
+
+    void Journal::record(std::unique_ptr<JournalEntry> entry, uint64_t gesture) {
+        for (Record &record : undone) {
+            memoryUsage -= record.memory;
+        }
+        undone.clear();
+        if (gesture != 0 && gesture == openGesture && !history.empty() && history.back().entry->merge(*entry)) {
+            Record &last = history.back();
+            memoryUsage -= last.memory;
+            last.memory = last.entry->getMemoryUsage();
+            memoryUsage += last.memory;
+            return;
+        }
+        openGesture = gesture;
+        size_t memory = entry->getMemoryUsage();
+        history.push_back(Record{std::move(entry), memory});
+        memoryUsage += memory;
+        trim();
+    }
+
+    void Journal::endGesture() {
+        openGesture = 0;
+    }
+
+    void Journal::trim() {
+        // The newest entry is always kept, even if it alone exceeds the cap
+        while (memoryUsage > memoryCap && history.size() > 1) {
+            memoryUsage -= history.front().memory;
+            history.pop_front();
+        }
+    }
+
+    bool Journal::undo() {
+        if (history.empty()) {
+            return false;
+        }
+        openGesture = 0;
+        Record record = std::move(history.back());
+        history.pop_back();
+        record.entry->undo(*entities, *eventBus);
+        undone.push_back(std::move(record));
+        return true;
+    }
+
+    bool Journal::redo() {
+        if (undone.empty()) {
+            return false;
+        }
+        openGesture = 0;
+        Record record = std::move(undone.back());
+        undone.pop_back();
+        record.entry->redo(*entities, *eventBus);
+        history.push_back(std::move(record));
+        return true;
+    }
+
+    bool Journal::canUndo() const {
+        return !history.empty();
+    }
+
+    bool Journal::canRedo() const {
+        return !undone.empty();
+    }
+
+    void Journal::clear() {
+        history.clear();
+        undone.clear();
+        memoryUsage = 0;
+        openGesture = 0;
+    }
+
+    size_t Journal::getMemoryUsage() const {
+        return memoryUsage;
+    }
+
+    size_t Journal::getMemoryCap() const {
+        return memoryCap;
+    }
+
+    void Journal::setMemoryCap(size_t memoryCap) {
+        Journal::memoryCap = memoryCap;
+        trim();
+    }
+
+    size_t Journal::getHistorySize() const {
+        return history.size();
+    }
+}
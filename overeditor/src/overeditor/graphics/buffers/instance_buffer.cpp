@@ -0,0 +1,133 @@
+#include <overeditor/graphics/buffers/instance_buffer.h>
+#include <overeditor/utility/vulkan_utility.h>
+
+#include <algorithm>
+
+namespace overeditor::graphics {
+
+    InstanceBuffer::InstanceBuffer(
+            const DeviceContext &context,
+            uint32_t frameCount,
+            utility::MatrixLayout layout,
+            uint32_t initialCapacity
+    ) : context(&context), layout(layout), frameCount(frameCount), capacity(0), regionSize(0), buffer(),
+        memory(), mapped(nullptr) {
+        auto &device = context.getDevice();
+        vk::DescriptorSetLayoutBinding binding(
+                0, vk::DescriptorType::eStorageBufferDynamic, 1, vk::ShaderStageFlagBits::eVertex
+        );
+        setLayout = device.createDescriptorSetLayout(
+                vk::DescriptorSetLayoutCreateInfo((vk::DescriptorSetLayoutCreateFlags) 0, 1, &binding)
+        );
+        vk::DescriptorPoolSize poolSize(vk::DescriptorType::eStorageBufferDynamic, 1);
+        descriptorPool = device.createDescriptorPool(
+                vk::DescriptorPoolCreateInfo((vk::DescriptorPoolCreateFlags) 0, 1, 1, &poolSize)
+        );
+        descriptorSet = device.allocateDescriptorSets(
+                vk::DescriptorSetAllocateInfo(descriptorPool, 1, &setLayout)
+        )[0];
+        allocate(std::max<uint32_t>(1, initialCapacity));
+    }
+
+    void InstanceBuffer::dispose() {
+        if (mapped == nullptr) {
+            return;
+        }
+        freeBuffer();
+        auto &device = context->getDevice();
+        // Frees the set along with it
+        device.destroy(descriptorPool);
+        device.destroy(setLayout);
+    }
+
+    void InstanceBuffer::freeBuffer() {
+        if (mapped == nullptr) {
+            return;
+        }
+        auto &device = context->getDevice();
+        device.unmapMemory(memory);
+        device.destroy(buffer);
+        context->freeMemory(memory);
+        mapped = nullptr;
+    }
+
+    void InstanceBuffer::allocate(uint32_t newCapacity) {
+        freeBuffer();
+        auto &device = context->getDevice();
+        auto &limits = context->getCandidate().getDeviceProperties().limits;
+        vk::DeviceSize alignment = std::max<vk::DeviceSize>(limits.minStorageBufferOffsetAlignment, 16);
+        vk::DeviceSize matrixSize = sizeof(float) * layout;
+        regionSize = (matrixSize * newCapacity + alignment - 1) / alignment * alignment;
+        buffer = device.createBuffer(
+                vk::BufferCreateInfo(
+                        (vk::BufferCreateFlags) 0,
+                        regionSize * frameCount,
+                        vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eStorageBuffer,
+                        vk::SharingMode::eExclusive
+                )
+        );
+        auto requirements = device.getBufferMemoryRequirements(buffer);
+        auto &memoryProperties = context->getCandidate().getMemoryProperties();
+        uint32_t memoryType;
+        try {
+            // Device local and host visible memory avoids the PCIe read on every draw where it exists
+            memoryType = utility::findMemoryType(
+                    memoryProperties,
+                    requirements.memoryTypeBits,
+                    vk::MemoryPropertyFlagBits::eDeviceLocal | vk::MemoryPropertyFlagBits::eHostVisible |
+                    vk::MemoryPropertyFlagBits::eHostCoherent
+            );
+        } catch (std::runtime_error &) {
+            memoryType = utility::findMemoryType(
+                    memoryProperties,
+                    requirements.memoryTypeBits,
+                    vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+            );
+        }
+        memory = context->allocateMemory(
+                vk::MemoryAllocateInfo(requirements.size, memoryType), utility::eMemoryFrameData
+        );
+        device.bindBufferMemory(buffer, memory, 0);
+        mapped = static_cast<uint8_t *>(device.mapMemory(memory, 0, regionSize * frameCount));
+        capacity = newCapacity;
+        vk::DescriptorBufferInfo bufferInfo(buffer, 0, regionSize);
+        device.updateDescriptorSets(
+                vk::WriteDescriptorSet(
+                        descriptorSet, 0, 0, 1, vk::DescriptorType::eStorageBufferDynamic, nullptr, &bufferInfo
+                ),
+                nullptr
+        );
+    }
+
+    float *InstanceBuffer::map(uint32_t frame, uint32_t count) {
+        if (count > capacity) {
+            context->getDevice().waitIdle();
+            allocate(std::max(count, capacity * 2));
+        }
+        return reinterpret_cast<float *>(mapped + getOffset(frame));
+    }
+
+    vk::DeviceSize InstanceBuffer::getOffset(uint32_t frame) const {
+        return regionSize * frame;
+    }
+
+    const vk::Buffer &InstanceBuffer::getBuffer() const {
+        return buffer;
+    }
+
+    utility::MatrixLayout InstanceBuffer::getLayout() const {
+        return layout;
+    }
+
+    const vk::DescriptorSetLayout &InstanceBuffer::getSetLayout() const {
+        return setLayout;
+    }
+
+    const vk::DescriptorSet &InstanceBuffer::getDescriptorSet() const {
+        return descriptorSet;
+    }
+
+    uint32_t InstanceBuffer::getCapacity() const {
+        return capacity;
+    }
+}
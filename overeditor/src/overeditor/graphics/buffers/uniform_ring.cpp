@@ -0,0 +1,130 @@
+#include <overeditor/graphics/buffers/uniform_ring.h>
+#include <overeditor/utility/vulkan_utility.h>
+
+#include <algorithm>
+
+namespace overeditor::graphics {
+
+    static vk::DeviceSize alignUp(vk::DeviceSize size, vk::DeviceSize alignment) {
+        return (size + alignment - 1) / alignment * alignment;
+    }
+
+    UniformRing::UniformRing(
+            const DeviceContext &context,
+            uint32_t frameCount,
+            vk::DeviceSize frameSize,
+            vk::DeviceSize bindingRange
+    ) : context(&context), frameCount(frameCount), alignment(1), regionSize(0), bindingRange(bindingRange), buffer(),
+        memory(), mapped(nullptr), frame(0), cursor(0) {
+        auto &device = context.getDevice();
+        auto &limits = context.getCandidate().getDeviceProperties().limits;
+        alignment = std::max<vk::DeviceSize>(limits.minUniformBufferOffsetAlignment, 16);
+        regionSize = alignUp(frameSize, alignment);
+        // The last allocation of the last region still has a whole binding range after its offset
+        vk::DeviceSize size = regionSize * frameCount + alignUp(bindingRange, alignment);
+        buffer = device.createBuffer(
+                vk::BufferCreateInfo(
+                        (vk::BufferCreateFlags) 0,
+                        size,
+                        vk::BufferUsageFlagBits::eUniformBuffer,
+                        vk::SharingMode::eExclusive
+                )
+        );
+        auto requirements = device.getBufferMemoryRequirements(buffer);
+        auto &memoryProperties = context.getCandidate().getMemoryProperties();
+        uint32_t memoryType;
+        try {
+            // Device local and host visible memory avoids the PCIe read on every access where it exists
+            memoryType = utility::findMemoryType(
+                    memoryProperties,
+                    requirements.memoryTypeBits,
+                    vk::MemoryPropertyFlagBits::eDeviceLocal | vk::MemoryPropertyFlagBits::eHostVisible |
+                    vk::MemoryPropertyFlagBits::eHostCoherent
+            );
+        } catch (std::runtime_error &) {
+            memoryType = utility::findMemoryType(
+                    memoryProperties,
+                    requirements.memoryTypeBits,
+                    vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+            );
+        }
+        memory = context.allocateMemory(
+                vk::MemoryAllocateInfo(requirements.size, memoryType), utility::eMemoryFrameData
+        );
+        device.bindBufferMemory(buffer, memory, 0);
+        mapped = static_cast<uint8_t *>(device.mapMemory(memory, 0, size));
+        vk::DescriptorSetLayoutBinding binding(
+                0, vk::DescriptorType::eUniformBufferDynamic, 1, vk::ShaderStageFlagBits::eAllGraphics
+        );
+        setLayout = device.createDescriptorSetLayout(
+                vk::DescriptorSetLayoutCreateInfo((vk::DescriptorSetLayoutCreateFlags) 0, 1, &binding)
+        );
+        vk::DescriptorPoolSize poolSize(vk::DescriptorType::eUniformBufferDynamic, 1);
+        descriptorPool = device.createDescriptorPool(
+                vk::DescriptorPoolCreateInfo((vk::DescriptorPoolCreateFlags) 0, 1, 1, &poolSize)
+        );
+        descriptorSet = device.allocateDescriptorSets(
+                vk::DescriptorSetAllocateInfo(descriptorPool, 1, &setLayout)
+        )[0];
+        vk::DescriptorBufferInfo bufferInfo(buffer, 0, bindingRange);
+        device.updateDescriptorSets(
+                vk::WriteDescriptorSet(
+                        descriptorSet, 0, 0, 1, vk::DescriptorType::eUniformBufferDynamic, nullptr, &bufferInfo
+                ),
+                nullptr
+        );
+    }
+
+    void UniformRing::dispose() {
+        if (mapped == nullptr) {
+            return;
+        }
+        auto &device = context->getDevice();
+        // Frees the set along with it
+        device.destroy(descriptorPool);
+        device.destroy(setLayout);
+        device.unmapMemory(memory);
+        device.destroy(buffer);
+        context->freeMemory(memory);
+        mapped = nullptr;
+    }
+
+    void UniformRing::begin(uint32_t frame) {
+        UniformRing::frame = frame;
+        cursor = 0;
+    }
+
+    uint32_t UniformRing::allocate(vk::DeviceSize size, void *&destination) {
+        if (size > bindingRange) {
+            throw std::runtime_error("Uniform allocation larger than the binding range");
+        }
+        vk::DeviceSize aligned = alignUp(size, alignment);
+        if (cursor + aligned > regionSize) {
+            throw std::runtime_error("Out of uniform space for the frame");
+        }
+        vk::DeviceSize offset = regionSize * frame + cursor;
+        cursor += aligned;
+        destination = mapped + offset;
+        return (uint32_t) offset;
+    }
+
+    const vk::Buffer &UniformRing::getBuffer() const {
+        return buffer;
+    }
+
+    const vk::DescriptorSetLayout &UniformRing::getSetLayout() const {
+        return setLayout;
+    }
+
+    const vk::DescriptorSet &UniformRing::getDescriptorSet() const {
+        return descriptorSet;
+    }
+
+    vk::DeviceSize UniformRing::getAlignment() const {
+        return alignment;
+    }
+
+    vk::DeviceSize UniformRing::getUsed() const {
+        return cursor;
+    }
+}
@@ -1,18 +1,91 @@
 #include <overeditor/graphics/buffers/vertices.h>
+#include <overeditor/utility/vulkan_utility.h>
+
+#include <cstring>
 
 namespace overeditor::graphics {
+    static void checkCount(uint8_t count) {
+        if (count < 1 || count > 4) {
+            throw std::runtime_error("Geometry elements have 1 to 4 components");
+        }
+    }
+
     template<>
     void GeometryLayout::push<float>(uint8_t count) {
-        elements.emplace_back(sizeof(float), count);
+        checkCount(count);
+        vk::Format formats[] = {
+                vk::Format::eR32Sfloat, vk::Format::eR32G32Sfloat,
+                vk::Format::eR32G32B32Sfloat, vk::Format::eR32G32B32A32Sfloat
+        };
+        elements.emplace_back(sizeof(float), count, formats[count - 1]);
     }
 
     template<>
     void GeometryLayout::push<uint8_t>(uint8_t count) {
-        elements.emplace_back(sizeof(uint8_t), count);
+        checkCount(count);
+        vk::Format formats[] = {
+                vk::Format::eR8Unorm, vk::Format::eR8G8Unorm,
+                vk::Format::eR8G8B8Unorm, vk::Format::eR8G8B8A8Unorm
+        };
+        elements.emplace_back(sizeof(uint8_t), count, formats[count - 1]);
     }
 
     template<>
     void GeometryLayout::push<uint32_t>(uint8_t count) {
-        elements.emplace_back(sizeof(uint32_t), count);
+        checkCount(count);
+        vk::Format formats[] = {
+                vk::Format::eR32Uint, vk::Format::eR32G32Uint,
+                vk::Format::eR32G32B32Uint, vk::Format::eR32G32B32A32Uint
+        };
+        elements.emplace_back(sizeof(uint32_t), count, formats[count - 1]);
+    }
+
+    vk::VertexInputBindingDescription GeometryLayout::getBinding(uint32_t binding) const {
+        return vk::VertexInputBindingDescription(binding, getStride(), vk::VertexInputRate::eVertex);
+    }
+
+    std::vector<vk::VertexInputAttributeDescription> GeometryLayout::getAttributes(uint32_t binding) const {
+        std::vector<vk::VertexInputAttributeDescription> attributes;
+        uint32_t offset = 0;
+        for (auto &element : elements) {
+            attributes.emplace_back((uint32_t) attributes.size(), binding, element.getFormat(), offset);
+            offset += element.getSize();
+        }
+        return attributes;
+    }
+
+    void GeometryBuffer::upload(
+            const DeviceContext &context,
+            ResourceRegistry &registry,
+            const void *vertices,
+            vk::DeviceSize size
+    ) {
+        auto &device = context.getDevice();
+        vk::Buffer newBuffer = device.createBuffer(
+                vk::BufferCreateInfo(
+                        (vk::BufferCreateFlags) 0,
+                        size,
+                        vk::BufferUsageFlagBits::eVertexBuffer,
+                        vk::SharingMode::eExclusive
+                )
+        );
+        auto requirements = device.getBufferMemoryRequirements(newBuffer);
+        vk::DeviceMemory memory = context.allocateMemory(
+                vk::MemoryAllocateInfo(
+                        requirements.size,
+                        utility::findMemoryType(
+                                context.getCandidate().getMemoryProperties(),
+                                requirements.memoryTypeBits,
+                                vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+                        )
+                ),
+                utility::eMemoryGeometry
+        );
+        device.bindBufferMemory(newBuffer, memory, 0);
+        std::memcpy(device.mapMemory(memory, 0, size), vertices, size);
+        device.unmapMemory(memory);
+        registry.release(buffer);
+        buffer = registry.add(BufferResource{newBuffer, memory});
+        vertexCount = layout.getStride() == 0 ? 0 : (uint32_t) (size / layout.getStride());
     }
-}
\ No newline at end of file
+}
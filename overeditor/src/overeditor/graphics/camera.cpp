@@ -0,0 +1,66 @@
+#include <overeditor/graphics/camera.h>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace overeditor::graphics {
+
+    static Camera orthographic(const glm::vec3 &center, const glm::vec3 &direction, const glm::vec3 &up, float size) {
+        Camera camera;
+        camera.projection = eOrthographic;
+        camera.orthographicSize = size;
+        // Backed off so the whole scene around center is in front of the near plane
+        camera.position = center - direction * (camera.farPlane / 2);
+        camera.rotation = glm::quatLookAt(direction, up);
+        return camera;
+    }
+
+    glm::vec3 Camera::getForward() const {
+        return rotation * glm::vec3(0, 0, -1);
+    }
+
+    glm::vec3 Camera::getUp() const {
+        return rotation * glm::vec3(0, 1, 0);
+    }
+
+    glm::mat4 Camera::getView() const {
+        return glm::lookAt(position, position + getForward(), getUp());
+    }
+
+    glm::mat4 Camera::getProjection(float aspect) const {
+        glm::mat4 result;
+        if (projection == eOrthographic) {
+            float halfWidth = orthographicSize * aspect;
+            result = glm::orthoRH_ZO(
+                    -halfWidth, halfWidth, -orthographicSize, orthographicSize, nearPlane, farPlane
+            );
+        } else {
+            result = glm::perspectiveRH_ZO(fieldOfView, aspect, nearPlane, farPlane);
+        }
+        // Vulkan's Y axis points down
+        result[1][1] *= -1;
+        return result;
+    }
+
+    glm::mat4 Camera::getViewProjection(float aspect) const {
+        return getProjection(aspect) * getView();
+    }
+
+    Camera Camera::perspective(const glm::vec3 &position, const glm::vec3 &target, float fieldOfView) {
+        Camera camera;
+        camera.position = position;
+        camera.rotation = glm::quatLookAt(glm::normalize(target - position), glm::vec3(0, 1, 0));
+        camera.fieldOfView = fieldOfView;
+        return camera;
+    }
+
+    Camera Camera::top(const glm::vec3 &center, float size) {
+        return orthographic(center, glm::vec3(0, -1, 0), glm::vec3(0, 0, -1), size);
+    }
+
+    Camera Camera::front(const glm::vec3 &center, float size) {
+        return orthographic(center, glm::vec3(0, 0, -1), glm::vec3(0, 1, 0), size);
+    }
+
+    Camera Camera::side(const glm::vec3 &center, float size) {
+        return orthographic(center, glm::vec3(-1, 0, 0), glm::vec3(0, 1, 0), size);
+    }
+}
@@ -0,0 +1,169 @@
+#include <overeditor/graphics/compute_pass.h>
+#include <overeditor/utility/vulkan_utility.h>
+
+namespace overeditor::graphics {
+
+    bool BufferHandoff::transfersOwnership() const {
+        return sourceFamily != destinationFamily;
+    }
+
+    void BufferHandoff::release(const vk::CommandBuffer &commands) const {
+        if (!transfersOwnership()) {
+            vk::BufferMemoryBarrier barrier(
+                    sourceAccess, destinationAccess,
+                    VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+                    buffer, offset, size
+            );
+            commands.pipelineBarrier(sourceStage, destinationStage, (vk::DependencyFlags) 0, nullptr, barrier, nullptr);
+            return;
+        }
+        // The destination access is ignored by the releasing family, visibility is handled by the acquire
+        vk::BufferMemoryBarrier barrier(
+                sourceAccess, (vk::AccessFlags) 0,
+                sourceFamily, destinationFamily,
+                buffer, offset, size
+        );
+        commands.pipelineBarrier(
+                sourceStage, vk::PipelineStageFlagBits::eBottomOfPipe, (vk::DependencyFlags) 0,
+                nullptr, barrier, nullptr
+        );
+    }
+
+    void BufferHandoff::acquire(const vk::CommandBuffer &commands) const {
+        if (!transfersOwnership()) {
+            return;
+        }
+        vk::BufferMemoryBarrier barrier(
+                (vk::AccessFlags) 0, destinationAccess,
+                sourceFamily, destinationFamily,
+                buffer, offset, size
+        );
+        commands.pipelineBarrier(
+                vk::PipelineStageFlagBits::eTopOfPipe, destinationStage, (vk::DependencyFlags) 0,
+                nullptr, barrier, nullptr
+        );
+    }
+
+    ComputePass::ComputePass(const DeviceContext &context, uint32_t frameCount)
+            : context(&context), pool(), buffers(), finishedSemaphores(), fences(), recording(UINT32_MAX) {
+        auto &device = context.getDevice();
+        pool = device.createCommandPool(
+                vk::CommandPoolCreateInfo(
+                        (vk::CommandPoolCreateFlags) vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+                        getFamilyIndex()
+                )
+        );
+        buffers = device.allocateCommandBuffers(
+                vk::CommandBufferAllocateInfo(pool, vk::CommandBufferLevel::ePrimary, frameCount)
+        );
+        for (uint32_t i = 0; i < frameCount; ++i) {
+            finishedSemaphores.push_back(device.createSemaphore(vk::SemaphoreCreateInfo()));
+            // Signaled so the first begin of every frame doesn't wait
+            fences.push_back(device.createFence(vk::FenceCreateInfo(vk::FenceCreateFlagBits::eSignaled)));
+        }
+    }
+
+    void ComputePass::dispose() {
+        if (!pool) {
+            return;
+        }
+        auto &device = context->getDevice();
+        device.waitForFences(fences, VK_TRUE, std::numeric_limits<uint64_t>::max());
+        for (auto &fence : fences) {
+            device.destroy(fence);
+        }
+        for (auto &semaphore : finishedSemaphores) {
+            device.destroy(semaphore);
+        }
+        device.freeCommandBuffers(pool, buffers);
+        device.destroy(pool);
+        pool = nullptr;
+        fences.clear();
+        finishedSemaphores.clear();
+        buffers.clear();
+    }
+
+    const vk::CommandBuffer &ComputePass::begin(uint32_t frame) {
+        if (recording != UINT32_MAX) {
+            throw std::runtime_error("Compute pass is already recording");
+        }
+        auto &device = context->getDevice();
+        device.waitForFences(1, &fences[frame], VK_TRUE, std::numeric_limits<uint64_t>::max());
+        device.resetFences(1, &fences[frame]);
+        recording = frame;
+        auto &buffer = buffers[frame];
+        buffer.begin(
+                vk::CommandBufferBeginInfo(
+                        (vk::CommandBufferUsageFlags) vk::CommandBufferUsageFlagBits::eOneTimeSubmit
+                )
+        );
+        return buffer;
+    }
+
+    void ComputePass::submit(
+            const std::vector<vk::Semaphore> &waitSemaphores,
+            const std::vector<vk::PipelineStageFlags> &waitStages
+    ) {
+        if (recording == UINT32_MAX) {
+            throw std::runtime_error("Compute pass isn't recording");
+        }
+        if (waitSemaphores.size() != waitStages.size()) {
+            throw std::runtime_error("Every wait semaphore needs a wait stage");
+        }
+        uint32_t frame = recording;
+        recording = UINT32_MAX;
+        auto &buffer = buffers[frame];
+        buffer.end();
+        vk::SubmitInfo info(
+                (uint32_t) waitSemaphores.size(), waitSemaphores.data(), waitStages.data(),
+                1, &buffer,
+                1, &finishedSemaphores[frame]
+        );
+        auto queueContext = context->getQueueContext();
+        auto &queue = queueContext->getComputeQueue();
+        // Without an async compute family this is the graphics queue, which the renderer submits to meanwhile
+        auto lock = queueContext->lock(queue);
+        vkAssertOk(
+                queue.submit(1, &info, fences[frame])
+        )
+    }
+
+    BufferHandoff ComputePass::toGraphics(
+            const vk::Buffer &buffer,
+            vk::DeviceSize offset,
+            vk::DeviceSize size,
+            vk::AccessFlags destinationAccess,
+            vk::PipelineStageFlags destinationStage
+    ) const {
+        return BufferHandoff{
+                buffer, offset, size,
+                getFamilyIndex(), context->getQueueContext()->getFamilyIndices().getGraphics().get(),
+                vk::AccessFlagBits::eShaderWrite, vk::PipelineStageFlagBits::eComputeShader,
+                destinationAccess, destinationStage
+        };
+    }
+
+    BufferHandoff ComputePass::fromGraphics(
+            const vk::Buffer &buffer,
+            vk::DeviceSize offset,
+            vk::DeviceSize size,
+            vk::AccessFlags sourceAccess,
+            vk::PipelineStageFlags sourceStage
+    ) const {
+        return BufferHandoff{
+                buffer, offset, size,
+                context->getQueueContext()->getFamilyIndices().getGraphics().get(), getFamilyIndex(),
+                sourceAccess, sourceStage,
+                vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite,
+                vk::PipelineStageFlagBits::eComputeShader
+        };
+    }
+
+    const vk::Semaphore &ComputePass::getFinishedSemaphore(uint32_t frame) const {
+        return finishedSemaphores[frame];
+    }
+
+    uint32_t ComputePass::getFamilyIndex() const {
+        return context->getQueueContext()->getComputeFamilyIndex();
+    }
+}
@@ -0,0 +1,82 @@
+#include <overeditor/graphics/depth_buffer.h>
+#include <overeditor/utility/vulkan_utility.h>
+
+namespace overeditor::graphics {
+
+    DepthBuffer::DepthBuffer(
+            const DeviceContext &context,
+            vk::Format format,
+            vk::Extent2D extent
+    ) : context(&context), image(), memory(), view() {
+        auto &device = context.getDevice();
+        image = device.createImage(
+                vk::ImageCreateInfo(
+                        (vk::ImageCreateFlags) 0,
+                        vk::ImageType::e2D,
+                        format,
+                        vk::Extent3D(extent.width, extent.height, 1),
+                        1, 1,
+                        vk::SampleCountFlagBits::e1,
+                        vk::ImageTiling::eOptimal,
+                        vk::ImageUsageFlagBits::eDepthStencilAttachment,
+                        vk::SharingMode::eExclusive
+                )
+        );
+        auto requirements = device.getImageMemoryRequirements(image);
+        memory = context.allocateMemory(
+                vk::MemoryAllocateInfo(
+                        requirements.size,
+                        utility::findMemoryType(
+                                context.getCandidate().getMemoryProperties(),
+                                requirements.memoryTypeBits,
+                                vk::MemoryPropertyFlagBits::eDeviceLocal
+                        )
+                ),
+                utility::eMemoryAttachments
+        );
+        device.bindImageMemory(image, memory, 0);
+        view = device.createImageView(
+                vk::ImageViewCreateInfo(
+                        (vk::ImageViewCreateFlags) 0,
+                        image,
+                        vk::ImageViewType::e2D,
+                        format,
+                        vk::ComponentMapping(),
+                        vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eDepth, 0, 1, 0, 1)
+                )
+        );
+    }
+
+    vk::Format DepthBuffer::selectFormat(const DeviceContext &context) {
+        const vk::Format candidates[] = {
+                vk::Format::eD32Sfloat,
+                vk::Format::eX8D24UnormPack32,
+                vk::Format::eD16Unorm,
+                vk::Format::eD32SfloatS8Uint,
+                vk::Format::eD24UnormS8Uint
+        };
+        const vk::PhysicalDevice &physicalDevice = context.getCandidate().getDevice();
+        for (vk::Format format : candidates) {
+            vk::FormatProperties properties = physicalDevice.getFormatProperties(format);
+            if (properties.optimalTilingFeatures & vk::FormatFeatureFlagBits::eDepthStencilAttachment) {
+                return format;
+            }
+        }
+        throw std::runtime_error("No supported depth attachment format");
+    }
+
+    void DepthBuffer::dispose() {
+        if (!image) {
+            return;
+        }
+        auto &device = context->getDevice();
+        device.destroy(view);
+        device.destroy(image);
+        context->freeMemory(memory);
+        image = nullptr;
+    }
+
+    const vk::ImageView &DepthBuffer::getView() const {
+        return view;
+    }
+}
@@ -1,12 +1,16 @@
 #include <overeditor/graphics/device_context.h>
 
+#include <algorithm>
+#include <cstring>
+
 namespace overeditor::graphics {
 
     DeviceContext::DeviceContext(
             const PhysicalDeviceCandidate &dev,
             const Requirements &requirements,
-            const vk::SurfaceKHR &surface
-    ) : candidate(dev) {
+            const vk::SurfaceKHR &surface,
+            utility::MemoryTracker &memoryTracker
+    ) : candidate(dev), memoryTracker(&memoryTracker) {
         const graphics::QueueFamilyIndices &qIndices = dev.getIndices();
 
         std::vector<vk::DeviceQueueCreateInfo> createQueueInfos;
@@ -17,11 +21,18 @@ namespace overeditor::graphics {
         if (!qIndices.getPresentation().tryGet(&presentationIndex)) {
             throw std::runtime_error("Couldn't find presentation index");
         }
+        // Compute work shares the graphics queue when there is no dedicated family
+        uint32_t computeIndex = graphicsIndex;
+        qIndices.getCompute().tryGet(&computeIndex);
         const float queuePriority = 1.0f;
         createQueueInfos.emplace_back((vk::DeviceQueueCreateFlags) 0, graphicsIndex, 1, &queuePriority);
         if (graphicsIndex != presentationIndex) {
             createQueueInfos.emplace_back((vk::DeviceQueueCreateFlags) 0, presentationIndex, 1, &queuePriority);
         }
+        if (computeIndex != graphicsIndex && computeIndex != presentationIndex) {
+            createQueueInfos.emplace_back((vk::DeviceQueueCreateFlags) 0, computeIndex, 1, &queuePriority);
+        }
+        LOG_INFO << "Async compute: " << qIndices.getCompute();
         LOG_INFO << "Creating " << createQueueInfos.size() << " queues: ";
         for (int i = 0; i < createQueueInfos.size(); ++i) {
             LOG_INFO << INDENTATION(1) << "Queue #" << i << ":";
@@ -29,8 +40,16 @@ namespace overeditor::graphics {
             LOG_INFO << INDENTATION(2) << "Count: " << q.queueCount;
             LOG_INFO << INDENTATION(2) << "Queue Family Index: " << q.queueFamilyIndex;
         }
+        std::vector<const char *> deviceExtensions = requirements.getRequiredExtensions();
+        auto available = dev.getDevice().enumerateDeviceExtensionProperties();
+        bool budgetSupported = std::any_of(available.begin(), available.end(), [](const vk::ExtensionProperties &p) {
+            return strcmp(p.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0;
+        });
+        if (budgetSupported) {
+            deviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        }
+        LOG_INFO << "Memory budget: " << (budgetSupported ? "supported" : "unsupported");
         try {
-            const auto &deviceExtensions = requirements.getRequiredExtensions();
             const auto &deviceLayers = requirements.getRequiredLayers();
 
             auto f = vk::DeviceCreateInfo(
@@ -44,7 +63,8 @@ namespace overeditor::graphics {
             LOG_FATAL << "Error while creating logical device: " << e.what();
             throw e;
         }
-        queueContext = new QueueContext(device, qIndices, graphicsIndex, presentationIndex);
+        memoryTracker.attach(dev.getDevice(), dev.getMemoryProperties(), budgetSupported);
+        queueContext = new QueueContext(device, qIndices, graphicsIndex, presentationIndex, computeIndex);
         const overeditor::graphics::SwapchainSupportDetails &scSupport = dev.getSwapchainSupportDetails();
         LOG_VECTOR_WITH("Surface formats", scSupport.getSurfaceFormats(), 1,
                         "Format: " << vk::to_string(value.format) << ", color space: "
@@ -74,4 +94,22 @@ namespace overeditor::graphics {
     const vk::Device &DeviceContext::getDevice() const {
         return device;
     }
+
+    vk::DeviceMemory DeviceContext::allocateMemory(
+            const vk::MemoryAllocateInfo &info,
+            utility::MemoryCategory category
+    ) const {
+        vk::DeviceMemory memory = device.allocateMemory(info);
+        memoryTracker->deviceAllocated(memory, info.allocationSize, info.memoryTypeIndex, category);
+        return memory;
+    }
+
+    void DeviceContext::freeMemory(const vk::DeviceMemory &memory) const {
+        memoryTracker->deviceFreed(memory);
+        device.free(memory);
+    }
+
+    utility::MemoryTracker &DeviceContext::getMemoryTracker() const {
+        return *memoryTracker;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include <overeditor/graphics/draw_keys.h>
+
+#include <algorithm>
+#include <cmath>
+
+#define DRAW_SORT_RADIX 256
+
+namespace overeditor::graphics {
+
+    static uint64_t packField(uint64_t key, uint32_t value, uint32_t bits) {
+        return (key << bits) | (value & ((1ULL << bits) - 1));
+    }
+
+    uint64_t makeDrawKey(uint32_t layer, uint32_t pipeline, uint32_t material, uint32_t mesh, uint32_t depth) {
+        uint64_t key = packField(0, std::min(layer, (1U << DRAW_KEY_LAYER_BITS) - 1), DRAW_KEY_LAYER_BITS);
+        key = packField(key, pipeline, DRAW_KEY_PIPELINE_BITS);
+        key = packField(key, material, DRAW_KEY_MATERIAL_BITS);
+        key = packField(key, mesh, DRAW_KEY_MESH_BITS);
+        return packField(key, depth, DRAW_KEY_DEPTH_BITS);
+    }
+
+    uint32_t quantizeDepth(float distance, float nearPlane, float farPlane) {
+        if (nearPlane <= 0 || farPlane <= nearPlane) {
+            return 0;
+        }
+        float clamped = std::min(std::max(distance, nearPlane), farPlane);
+        float t = std::log(clamped / nearPlane) / std::log(farPlane / nearPlane);
+        auto largest = (float) ((1U << DRAW_KEY_DEPTH_BITS) - 1);
+        return (uint32_t) (t * largest + 0.5F);
+    }
+
+    void sortDraws(utility::ThreadPool *pool, std::vector<DrawItem> &draws, std::vector<DrawItem> &scratch) {
+        size_t count = draws.size();
+        if (count < 2) {
+            return;
+        }
+        // Bits that aren't the same in every key, bytes without any are already sorted
+        uint64_t first = draws[0].key, differing = 0;
+        for (const DrawItem &draw : draws) {
+            differing |= draw.key ^ first;
+        }
+        if (differing == 0) {
+            return;
+        }
+        scratch.resize(count);
+        size_t blocks = 1;
+        if (pool != nullptr && count >= DRAW_SORT_PARALLEL_THRESHOLD) {
+            blocks = std::min(pool->getWorkerCount() + 1, count / (DRAW_SORT_PARALLEL_THRESHOLD / 4));
+        }
+        size_t blockSize = (count + blocks - 1) / blocks;
+        // Counts of every digit in every block, turned into where the block writes them
+        std::vector<size_t> offsets(blocks * DRAW_SORT_RADIX);
+        DrawItem *source = draws.data(), *destination = scratch.data();
+        auto forEachBlock = [&](const std::function<void(size_t, size_t)> &job) {
+            if (blocks == 1) {
+                job(0, 1);
+            } else {
+                pool->parallelFor(blocks, 1, job);
+            }
+        };
+        for (uint32_t shift = 0; shift < 64; shift += 8) {
+            if (((differing >> shift) & 0xFF) == 0) {
+                continue;
+            }
+            forEachBlock([&](size_t begin, size_t end) {
+                for (size_t block = begin; block < end; ++block) {
+                    size_t *counts = &offsets[block * DRAW_SORT_RADIX];
+                    std::fill(counts, counts + DRAW_SORT_RADIX, 0);
+                    size_t last = std::min(count, (block + 1) * blockSize);
+                    for (size_t i = block * blockSize; i < last; ++i) {
+                        counts[(source[i].key >> shift) & 0xFF]++;
+                    }
+                }
+            });
+            // Digit major, then block, so equal digits keep their order
+            size_t offset = 0;
+            for (size_t digit = 0; digit < DRAW_SORT_RADIX; ++digit) {
+                for (size_t block = 0; block < blocks; ++block) {
+                    size_t &slot = offsets[block * DRAW_SORT_RADIX + digit];
+                    size_t digitCount = slot;
+                    slot = offset;
+                    offset += digitCount;
+                }
+            }
+            forEachBlock([&](size_t begin, size_t end) {
+                for (size_t block = begin; block < end; ++block) {
+                    size_t *next = &offsets[block * DRAW_SORT_RADIX];
+                    size_t last = std::min(count, (block + 1) * blockSize);
+                    for (size_t i = block * blockSize; i < last; ++i) {
+                        destination[next[(source[i].key >> shift) & 0xFF]++] = source[i];
+                    }
+                }
+            });
+            std::swap(source, destination);
+        }
+        if (source != draws.data()) {
+            draws.swap(scratch);
+        }
+    }
+}
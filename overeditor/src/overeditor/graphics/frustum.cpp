@@ -0,0 +1,127 @@
+#include <overeditor/graphics/frustum.h>
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace overeditor::graphics {
+
+    static glm::vec4 getRow(const glm::mat4 &matrix, int row) {
+        return glm::vec4(matrix[0][row], matrix[1][row], matrix[2][row], matrix[3][row]);
+    }
+
+    static glm::vec4 normalizePlane(const glm::vec4 &plane) {
+        return plane / glm::length(glm::vec3(plane.x, plane.y, plane.z));
+    }
+
+    Frustum Frustum::fromMatrix(const glm::mat4 &viewProjection) {
+        glm::vec4 x = getRow(viewProjection, 0);
+        glm::vec4 y = getRow(viewProjection, 1);
+        glm::vec4 z = getRow(viewProjection, 2);
+        glm::vec4 w = getRow(viewProjection, 3);
+        Frustum frustum{};
+        frustum.planes[0] = normalizePlane(w + x);
+        frustum.planes[1] = normalizePlane(w - x);
+        frustum.planes[2] = normalizePlane(w + y);
+        frustum.planes[3] = normalizePlane(w - y);
+        // Depth is [0, 1], so the near plane is z >= 0 rather than z >= -w
+        frustum.planes[4] = normalizePlane(z);
+        frustum.planes[5] = normalizePlane(w - z);
+        return frustum;
+    }
+
+    bool Frustum::intersectsSphere(const glm::vec3 &center, float radius) const {
+        for (const glm::vec4 &plane : planes) {
+            if (plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w < -radius) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool Frustum::intersectsBox(const glm::vec3 &min, const glm::vec3 &max) const {
+        for (const glm::vec4 &plane : planes) {
+            // The corner farthest along the plane normal
+            glm::vec3 corner(
+                    plane.x >= 0 ? max.x : min.x,
+                    plane.y >= 0 ? max.y : min.y,
+                    plane.z >= 0 ? max.z : min.z
+            );
+            if (plane.x * corner.x + plane.y * corner.y + plane.z * corner.z + plane.w < 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static void expandByFrustum(const glm::mat4 &viewProjection, glm::vec3 &min, glm::vec3 &max) {
+        glm::mat4 inverse = glm::inverse(viewProjection);
+        for (int corner = 0; corner < 8; ++corner) {
+            glm::vec4 point = inverse * glm::vec4(
+                    corner & 1 ? 1.0F : -1.0F,
+                    corner & 2 ? 1.0F : -1.0F,
+                    corner & 4 ? 1.0F : 0.0F,
+                    1.0F
+            );
+            glm::vec3 world = glm::vec3(point.x, point.y, point.z) / point.w;
+            min = glm::min(min, world);
+            max = glm::max(max, world);
+        }
+    }
+
+    CullStatistics cullSpheres(
+            const glm::vec4 *spheres,
+            size_t count,
+            const std::vector<glm::mat4> &viewProjections,
+            uint32_t *masks
+    ) {
+        if (viewProjections.size() > FRUSTUM_MAX_VIEWS) {
+            throw std::runtime_error("Too many views to cull at once");
+        }
+        CullStatistics statistics;
+        statistics.tested = count;
+        std::vector<Frustum> frusta;
+        // Bits of the views sharing the matrix of each unique view
+        std::vector<uint32_t> viewBits;
+        std::vector<size_t> representatives;
+        glm::vec3 min(std::numeric_limits<float>::max());
+        glm::vec3 max(-std::numeric_limits<float>::max());
+        for (size_t i = 0; i < viewProjections.size(); ++i) {
+            bool merged = false;
+            for (size_t j = 0; j < representatives.size(); ++j) {
+                if (std::memcmp(&viewProjections[i], &viewProjections[representatives[j]], sizeof(glm::mat4)) == 0) {
+                    viewBits[j] |= 1U << i;
+                    merged = true;
+                    break;
+                }
+            }
+            if (merged) {
+                continue;
+            }
+            representatives.push_back(i);
+            frusta.push_back(Frustum::fromMatrix(viewProjections[i]));
+            viewBits.push_back(1U << i);
+            expandByFrustum(viewProjections[i], min, max);
+        }
+        statistics.uniqueViews = (uint32_t) frusta.size();
+        for (size_t i = 0; i < count; ++i) {
+            const glm::vec4 &sphere = spheres[i];
+            glm::vec3 center(sphere.x, sphere.y, sphere.z);
+            glm::vec3 closest = glm::min(glm::max(center, min), max);
+            glm::vec3 offset = center - closest;
+            if (glm::dot(offset, offset) > sphere.w * sphere.w) {
+                masks[i] = 0;
+                statistics.rejected++;
+                continue;
+            }
+            uint32_t mask = 0;
+            for (size_t j = 0; j < frusta.size(); ++j) {
+                if (frusta[j].intersectsSphere(center, sphere.w)) {
+                    mask |= viewBits[j];
+                }
+            }
+            masks[i] = mask;
+        }
+        return statistics;
+    }
+}
@@ -0,0 +1,442 @@
+#include <overeditor/graphics/mesh_bvh.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OVEREDITOR_MESH_BVH_SSE
+#include <emmintrin.h>
+#endif
+
+namespace overeditor::graphics {
+
+    // Triangles whose determinant is below this are parallel to the ray, or degenerate
+    static const float parallelEpsilon = 1e-12F;
+    // Enough for MESH_BVH_MAX_DEPTH levels of SAH splits followed by median splits of up to 2^32 triangles
+    static const uint32_t stackSize = MESH_BVH_MAX_DEPTH + 40;
+
+    struct BuildTriangle {
+        glm::vec3 min, max, centroid;
+        uint32_t index;
+    };
+
+    struct Bounds {
+        glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+        glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+
+        void grow(const glm::vec3 &pointMin, const glm::vec3 &pointMax) {
+            min = glm::min(min, pointMin);
+            max = glm::max(max, pointMax);
+        }
+
+        float area() const {
+            glm::vec3 extent = max - min;
+            if (extent.x < 0) {
+                return 0;
+            }
+            return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+        }
+    };
+
+    // Cost of a leaf, in packet tests
+    static float leafCost(size_t count) {
+        return (float) ((count + 3) / 4);
+    }
+
+    static uint32_t buildNode(
+            std::vector<MeshBvhNode> &nodes,
+            std::vector<BuildTriangle> &triangles,
+            size_t begin,
+            size_t end,
+            uint32_t depth
+    ) {
+        Bounds bounds, centroids;
+        for (size_t i = begin; i < end; ++i) {
+            bounds.grow(triangles[i].min, triangles[i].max);
+            centroids.grow(triangles[i].centroid, triangles[i].centroid);
+        }
+        auto index = (uint32_t) nodes.size();
+        nodes.emplace_back();
+        MeshBvhNode &node = nodes[index];
+        for (int axis = 0; axis < 3; ++axis) {
+            node.min[axis] = bounds.min[axis];
+            node.max[axis] = bounds.max[axis];
+        }
+        size_t count = end - begin;
+        if (count <= 1) {
+            // Leaves keep their first triangle here until the packets are laid out
+            node.offset = (uint32_t) begin;
+            node.count = (uint32_t) count;
+            return index;
+        }
+        // Binned SAH over all three axes, a traversal step costs about as much as a packet test
+        float bestCost = std::numeric_limits<float>::max();
+        int bestAxis = -1;
+        float bestSplit = 0;
+        float parentArea = bounds.area();
+        if (depth < MESH_BVH_MAX_DEPTH && parentArea > 0) {
+            for (int axis = 0; axis < 3; ++axis) {
+                float lower = centroids.min[axis];
+                float extent = centroids.max[axis] - lower;
+                if (extent <= 0) {
+                    continue;
+                }
+                Bounds bins[MESH_BVH_BINS];
+                size_t binCounts[MESH_BVH_BINS] = {};
+                float scale = MESH_BVH_BINS / extent;
+                for (size_t i = begin; i < end; ++i) {
+                    auto bin = std::min(
+                            (int) ((triangles[i].centroid[axis] - lower) * scale),
+                            MESH_BVH_BINS - 1
+                    );
+                    bins[bin].grow(triangles[i].min, triangles[i].max);
+                    binCounts[bin]++;
+                }
+                // Right hand side of every split plane, swept from the last bin
+                float rightAreas[MESH_BVH_BINS];
+                size_t rightCounts[MESH_BVH_BINS];
+                Bounds right;
+                size_t rightCount = 0;
+                for (int bin = MESH_BVH_BINS - 1; bin > 0; --bin) {
+                    right.grow(bins[bin].min, bins[bin].max);
+                    rightCount += binCounts[bin];
+                    rightAreas[bin] = right.area();
+                    rightCounts[bin] = rightCount;
+                }
+                Bounds left;
+                size_t leftCount = 0;
+                for (int bin = 0; bin < MESH_BVH_BINS - 1; ++bin) {
+                    left.grow(bins[bin].min, bins[bin].max);
+                    leftCount += binCounts[bin];
+                    if (leftCount == 0 || rightCounts[bin + 1] == 0) {
+                        continue;
+                    }
+                    float cost = 1.0F + (left.area() * (float) leftCount +
+                                         rightAreas[bin + 1] * (float) rightCounts[bin + 1]) / (4.0F * parentArea);
+                    if (cost < bestCost) {
+                        bestCost = cost;
+                        bestAxis = axis;
+                        bestSplit = lower + (float) (bin + 1) / scale;
+                    }
+                }
+            }
+        }
+        size_t middle;
+        if (bestAxis >= 0 && (bestCost < leafCost(count) || count > MESH_BVH_MAX_LEAF_TRIANGLES)) {
+            auto first = triangles.begin() + (ptrdiff_t) begin;
+            auto last = triangles.begin() + (ptrdiff_t) end;
+            middle = (size_t) (std::partition(
+                    first, last,
+                    [bestAxis, bestSplit](const BuildTriangle &triangle) {
+                        return triangle.centroid[bestAxis] < bestSplit;
+                    }
+            ) - triangles.begin());
+            // Rounding may put every centroid on the same side of the plane
+            if (middle == begin || middle == end) {
+                middle = begin + count / 2;
+            }
+        } else if (count > MESH_BVH_MAX_LEAF_TRIANGLES) {
+            // Too deep or every centroid in the same spot, halve along the longest axis
+            glm::vec3 extent = centroids.max - centroids.min;
+            int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : extent.y >= extent.z ? 1 : 2;
+            middle = begin + count / 2;
+            std::nth_element(
+                    triangles.begin() + (ptrdiff_t) begin,
+                    triangles.begin() + (ptrdiff_t) middle,
+                    triangles.begin() + (ptrdiff_t) end,
+                    [axis](const BuildTriangle &a, const BuildTriangle &b) {
+                        return a.centroid[axis] < b.centroid[axis];
+                    }
+            );
+        } else {
+            node.offset = (uint32_t) begin;
+            node.count = (uint32_t) count;
+            return index;
+        }
+        // The left child is built right after its parent, nodes may have moved by the time the right one returns
+        buildNode(nodes, triangles, begin, middle, depth + 1);
+        uint32_t rightChild = buildNode(nodes, triangles, middle, end, depth + 1);
+        nodes[index].offset = rightChild;
+        nodes[index].count = 0;
+        return index;
+    }
+
+    MeshBvh::MeshBvh(const MeshData &mesh) : nodes(), packets() {
+        if (mesh.indices.size() % 3 != 0) {
+            throw std::runtime_error("Mesh index count is not a multiple of 3");
+        }
+        size_t triangleCount = mesh.indices.size() / 3;
+        if (triangleCount == 0) {
+            return;
+        }
+        std::vector<BuildTriangle> triangles(triangleCount);
+        for (size_t i = 0; i < triangleCount; ++i) {
+            const uint32_t *indices = mesh.indices.data() + i * 3;
+            if (indices[0] >= mesh.positions.size() || indices[1] >= mesh.positions.size() ||
+                indices[2] >= mesh.positions.size()) {
+                throw std::runtime_error("Mesh index out of range");
+            }
+            const glm::vec3 &a = mesh.positions[indices[0]];
+            const glm::vec3 &b = mesh.positions[indices[1]];
+            const glm::vec3 &c = mesh.positions[indices[2]];
+            BuildTriangle &triangle = triangles[i];
+            triangle.min = glm::min(a, glm::min(b, c));
+            triangle.max = glm::max(a, glm::max(b, c));
+            triangle.centroid = (a + b + c) / 3.0F;
+            triangle.index = (uint32_t) i;
+        }
+        nodes.reserve(triangleCount / 2 + 1);
+        buildNode(nodes, triangles, 0, triangleCount, 0);
+        // Lay the triangles of every leaf out in packets, padding the last one with degenerate lanes
+        packets.reserve((triangleCount + 3) / 4 + nodes.size() / 2);
+        for (MeshBvhNode &node : nodes) {
+            if (node.count == 0) {
+                continue;
+            }
+            uint32_t first = node.offset;
+            node.offset = (uint32_t) packets.size();
+            for (uint32_t packetStart = 0; packetStart < node.count; packetStart += 4) {
+                MeshTrianglePacket packet{};
+                for (uint32_t lane = 0; lane < 4; ++lane) {
+                    if (packetStart + lane >= node.count) {
+                        packet.triangles[lane] = UINT32_MAX;
+                        continue;
+                    }
+                    uint32_t triangle = triangles[first + packetStart + lane].index;
+                    const uint32_t *indices = mesh.indices.data() + (size_t) triangle * 3;
+                    const glm::vec3 &a = mesh.positions[indices[0]];
+                    glm::vec3 e1 = mesh.positions[indices[1]] - a;
+                    glm::vec3 e2 = mesh.positions[indices[2]] - a;
+                    for (int axis = 0; axis < 3; ++axis) {
+                        packet.v0[axis][lane] = a[axis];
+                        packet.e1[axis][lane] = e1[axis];
+                        packet.e2[axis][lane] = e2[axis];
+                    }
+                    packet.triangles[lane] = triangle;
+                }
+                packets.push_back(packet);
+            }
+        }
+    }
+
+    // Distance at which the ray enters the node, or infinity if it misses it before limit
+    static float intersectNode(
+            const MeshBvhNode &node,
+            const glm::vec3 &origin,
+            const glm::vec3 &inverseDirection,
+            float limit
+    ) {
+        float entry = 0, exit = limit;
+        for (int axis = 0; axis < 3; ++axis) {
+            float t0 = (node.min[axis] - origin[axis]) * inverseDirection[axis];
+            float t1 = (node.max[axis] - origin[axis]) * inverseDirection[axis];
+            if (t0 > t1) {
+                std::swap(t0, t1);
+            }
+            entry = std::max(entry, t0);
+            exit = std::min(exit, t1);
+        }
+        return entry <= exit ? entry : std::numeric_limits<float>::infinity();
+    }
+
+    // Moller-Trumbore against the four lanes of the packet, updates best and the hit lane on a closer hit
+    static bool intersectPacket(
+            const MeshTrianglePacket &packet,
+            const glm::vec3 &origin,
+            const glm::vec3 &direction,
+            float &best,
+            int &bestLane,
+            float &bestU,
+            float &bestV
+    ) {
+        float distances[4], us[4], vs[4];
+        int hits;
+#ifdef OVEREDITOR_MESH_BVH_SSE
+        __m128 dx = _mm_set1_ps(direction.x), dy = _mm_set1_ps(direction.y), dz = _mm_set1_ps(direction.z);
+        __m128 e1x = _mm_loadu_ps(packet.e1[0]), e1y = _mm_loadu_ps(packet.e1[1]), e1z = _mm_loadu_ps(packet.e1[2]);
+        __m128 e2x = _mm_loadu_ps(packet.e2[0]), e2y = _mm_loadu_ps(packet.e2[1]), e2z = _mm_loadu_ps(packet.e2[2]);
+        __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+        __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+        __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+        __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+        __m128 absDet = _mm_andnot_ps(_mm_set1_ps(-0.0F), det);
+        __m128 mask = _mm_cmpgt_ps(absDet, _mm_set1_ps(parallelEpsilon));
+        if (_mm_movemask_ps(mask) == 0) {
+            return false;
+        }
+        __m128 inverseDet = _mm_div_ps(_mm_set1_ps(1.0F), det);
+        __m128 tx = _mm_sub_ps(_mm_set1_ps(origin.x), _mm_loadu_ps(packet.v0[0]));
+        __m128 ty = _mm_sub_ps(_mm_set1_ps(origin.y), _mm_loadu_ps(packet.v0[1]));
+        __m128 tz = _mm_sub_ps(_mm_set1_ps(origin.z), _mm_loadu_ps(packet.v0[2]));
+        __m128 u = _mm_mul_ps(
+                _mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, px), _mm_mul_ps(ty, py)), _mm_mul_ps(tz, pz)),
+                inverseDet
+        );
+        __m128 qx = _mm_sub_ps(_mm_mul_ps(ty, e1z), _mm_mul_ps(tz, e1y));
+        __m128 qy = _mm_sub_ps(_mm_mul_ps(tz, e1x), _mm_mul_ps(tx, e1z));
+        __m128 qz = _mm_sub_ps(_mm_mul_ps(tx, e1y), _mm_mul_ps(ty, e1x));
+        __m128 v = _mm_mul_ps(
+                _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)),
+                inverseDet
+        );
+        __m128 t = _mm_mul_ps(
+                _mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)),
+                inverseDet
+        );
+        __m128 zero = _mm_setzero_ps();
+        mask = _mm_and_ps(mask, _mm_cmpge_ps(u, zero));
+        mask = _mm_and_ps(mask, _mm_cmpge_ps(v, zero));
+        mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.0F)));
+        mask = _mm_and_ps(mask, _mm_cmpge_ps(t, zero));
+        mask = _mm_and_ps(mask, _mm_cmplt_ps(t, _mm_set1_ps(best)));
+        hits = _mm_movemask_ps(mask);
+        if (hits == 0) {
+            return false;
+        }
+        _mm_storeu_ps(distances, t);
+        _mm_storeu_ps(us, u);
+        _mm_storeu_ps(vs, v);
+#else
+        hits = 0;
+        for (int lane = 0; lane < 4; ++lane) {
+            glm::vec3 e1(packet.e1[0][lane], packet.e1[1][lane], packet.e1[2][lane]);
+            glm::vec3 e2(packet.e2[0][lane], packet.e2[1][lane], packet.e2[2][lane]);
+            glm::vec3 p = glm::cross(direction, e2);
+            float det = glm::dot(e1, p);
+            if (std::fabs(det) <= parallelEpsilon) {
+                continue;
+            }
+            float inverseDet = 1.0F / det;
+            glm::vec3 toOrigin = origin - glm::vec3(packet.v0[0][lane], packet.v0[1][lane], packet.v0[2][lane]);
+            glm::vec3 q = glm::cross(toOrigin, e1);
+            us[lane] = glm::dot(toOrigin, p) * inverseDet;
+            vs[lane] = glm::dot(direction, q) * inverseDet;
+            distances[lane] = glm::dot(e2, q) * inverseDet;
+            if (us[lane] >= 0 && vs[lane] >= 0 && us[lane] + vs[lane] <= 1 &&
+                distances[lane] >= 0 && distances[lane] < best) {
+                hits |= 1 << lane;
+            }
+        }
+        if (hits == 0) {
+            return false;
+        }
+#endif
+        for (int lane = 0; lane < 4; ++lane) {
+            if ((hits & (1 << lane)) && distances[lane] < best) {
+                best = distances[lane];
+                bestLane = lane;
+                bestU = us[lane];
+                bestV = vs[lane];
+            }
+        }
+        return true;
+    }
+
+    bool MeshBvh::raycast(
+            const glm::vec3 &origin,
+            const glm::vec3 &direction,
+            float maxDistance,
+            MeshHit &hit
+    ) const {
+        if (nodes.empty()) {
+            return false;
+        }
+        glm::vec3 inverseDirection(1.0F / direction.x, 1.0F / direction.y, 1.0F / direction.z);
+        float best = maxDistance;
+        const MeshTrianglePacket *bestPacket = nullptr;
+        int bestLane = 0;
+        float bestU = 0, bestV = 0;
+        // Far children waiting to be visited, with the distance at which the ray enters them
+        uint32_t stack[stackSize];
+        float stackDistances[stackSize];
+        uint32_t stackTop = 0;
+        uint32_t current = 0;
+        if (intersectNode(nodes[0], origin, inverseDirection, best) == std::numeric_limits<float>::infinity()) {
+            return false;
+        }
+        while (true) {
+            const MeshBvhNode &node = nodes[current];
+            if (node.count > 0) {
+                uint32_t end = node.offset + (node.count + 3) / 4;
+                for (uint32_t packet = node.offset; packet < end; ++packet) {
+                    if (intersectPacket(packets[packet], origin, direction, best, bestLane, bestU, bestV)) {
+                        bestPacket = &packets[packet];
+                    }
+                }
+            } else {
+                uint32_t nearChild = current + 1, farChild = node.offset;
+                float nearDistance = intersectNode(nodes[nearChild], origin, inverseDirection, best);
+                float farDistance = intersectNode(nodes[farChild], origin, inverseDirection, best);
+                if (farDistance < nearDistance) {
+                    std::swap(nearChild, farChild);
+                    std::swap(nearDistance, farDistance);
+                }
+                if (nearDistance != std::numeric_limits<float>::infinity()) {
+                    if (farDistance != std::numeric_limits<float>::infinity()) {
+                        stack[stackTop] = farChild;
+                        stackDistances[stackTop] = farDistance;
+                        stackTop++;
+                    }
+                    current = nearChild;
+                    continue;
+                }
+            }
+            // Pop the next far child the ray still reaches before the nearest hit so far
+            bool popped = false;
+            while (stackTop > 0) {
+                stackTop--;
+                if (stackDistances[stackTop] < best) {
+                    current = stack[stackTop];
+                    popped = true;
+                    break;
+                }
+            }
+            if (!popped) {
+                break;
+            }
+        }
+        if (bestPacket == nullptr) {
+            return false;
+        }
+        glm::vec3 e1(bestPacket->e1[0][bestLane], bestPacket->e1[1][bestLane], bestPacket->e1[2][bestLane]);
+        glm::vec3 e2(bestPacket->e2[0][bestLane], bestPacket->e2[1][bestLane], bestPacket->e2[2][bestLane]);
+        hit.distance = best;
+        hit.triangle = bestPacket->triangles[bestLane];
+        hit.u = bestU;
+        hit.v = bestV;
+        hit.normal = glm::normalize(glm::cross(e1, e2));
+        return true;
+    }
+
+    bool MeshBvh::raycast(
+            const glm::mat4 &world,
+            const glm::vec3 &origin,
+            const glm::vec3 &direction,
+            float maxDistance,
+            MeshHit &hit
+    ) const {
+        // Moving the ray into the space of the mesh keeps the distance along it unchanged
+        glm::mat4 inverse = glm::inverse(world);
+        glm::vec3 localOrigin(inverse * glm::vec4(origin, 1.0F));
+        glm::vec3 localDirection(inverse * glm::vec4(direction, 0.0F));
+        if (!raycast(localOrigin, localDirection, maxDistance, hit)) {
+            return false;
+        }
+        hit.normal = glm::normalize(glm::vec3(glm::transpose(inverse) * glm::vec4(hit.normal, 0.0F)));
+        return true;
+    }
+
+    const std::vector<MeshBvhNode> &MeshBvh::getNodes() const {
+        return nodes;
+    }
+
+    size_t MeshBvh::getPacketCount() const {
+        return packets.size();
+    }
+
+    size_t MeshBvh::getMemorySize() const {
+        return nodes.capacity() * sizeof(MeshBvhNode) + packets.capacity() * sizeof(MeshTrianglePacket);
+    }
+}
@@ -0,0 +1,290 @@
+#include <overeditor/graphics/occlusion.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OVEREDITOR_OCCLUSION_SSE
+#include <emmintrin.h>
+#endif
+
+namespace overeditor::graphics {
+    typedef std::chrono::high_resolution_clock Clock;
+
+    // Vertices closer than this to the eye are treated as crossing the near plane
+    static const float nearW = 1e-5F;
+
+    OccluderMesh OccluderMesh::box() {
+        OccluderMesh mesh;
+        for (int corner = 0; corner < 8; ++corner) {
+            mesh.vertices.emplace_back(
+                    corner & 1 ? 1.0F : -1.0F,
+                    corner & 2 ? 1.0F : -1.0F,
+                    corner & 4 ? 1.0F : -1.0F
+            );
+        }
+        // Two triangles per face, the rasterizer draws both windings
+        mesh.indices = {
+                0, 1, 3, 0, 3, 2,
+                4, 6, 7, 4, 7, 5,
+                0, 4, 5, 0, 5, 1,
+                2, 3, 7, 2, 7, 6,
+                0, 2, 6, 0, 6, 4,
+                1, 5, 7, 1, 7, 3
+        };
+        return mesh;
+    }
+
+    OcclusionStatistics &OcclusionStatistics::operator+=(const OcclusionStatistics &other) {
+        tested += other.tested;
+        occluded += other.occluded;
+        triangles += other.triangles;
+        rasterizeMilliseconds += other.rasterizeMilliseconds;
+        testMilliseconds += other.testMilliseconds;
+        return *this;
+    }
+
+    OcclusionBuffer::OcclusionBuffer(uint32_t width, uint32_t height)
+            : width((std::max(width, 4U) + 3) & ~3U), height(std::max(height, 1U)),
+              levels(), levelWidths(), levelHeights() {
+        uint32_t levelWidth = OcclusionBuffer::width, levelHeight = OcclusionBuffer::height;
+        while (true) {
+            levels.emplace_back((size_t) levelWidth * levelHeight, 1.0F);
+            levelWidths.push_back(levelWidth);
+            levelHeights.push_back(levelHeight);
+            if (levelWidth == 1 && levelHeight == 1) {
+                break;
+            }
+            levelWidth = (levelWidth + 1) / 2;
+            levelHeight = (levelHeight + 1) / 2;
+        }
+    }
+
+    void OcclusionBuffer::clear() {
+        std::fill(levels[0].begin(), levels[0].end(), 1.0F);
+    }
+
+    void OcclusionBuffer::rasterizeTriangle(const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c) {
+        float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+        if (std::fabs(area) < 1e-8F) {
+            return;
+        }
+        // Both windings are drawn, flip the clockwise ones so the inside of every edge is positive
+        const glm::vec3 &v1 = area > 0 ? b : c;
+        const glm::vec3 &v2 = area > 0 ? c : b;
+        area = std::fabs(area);
+        int minX = std::max(0, (int) std::floor(std::min(a.x, std::min(v1.x, v2.x))));
+        int maxX = std::min((int) width - 1, (int) std::ceil(std::max(a.x, std::max(v1.x, v2.x))));
+        int minY = std::max(0, (int) std::floor(std::min(a.y, std::min(v1.y, v2.y))));
+        int maxY = std::min((int) height - 1, (int) std::ceil(std::max(a.y, std::max(v1.y, v2.y))));
+        if (minX > maxX || minY > maxY) {
+            return;
+        }
+        // Edge functions e = A * x + B * y + C, each one the weight of the opposite vertex
+        const glm::vec3 *from[3] = {&v1, &v2, &a};
+        const glm::vec3 *to[3] = {&v2, &a, &v1};
+        float edgeA[3], edgeB[3], edgeC[3];
+        for (int i = 0; i < 3; ++i) {
+            edgeA[i] = from[i]->y - to[i]->y;
+            edgeB[i] = to[i]->x - from[i]->x;
+            edgeC[i] = from[i]->x * to[i]->y - from[i]->y * to[i]->x;
+        }
+        // Depth is linear in screen space after the perspective divide
+        float depthA = (edgeA[0] * a.z + edgeA[1] * v1.z + edgeA[2] * v2.z) / area;
+        float depthB = (edgeB[0] * a.z + edgeB[1] * v1.z + edgeB[2] * v2.z) / area;
+        float depthC = (edgeC[0] * a.z + edgeC[1] * v1.z + edgeC[2] * v2.z) / area;
+        // Rows are walked 4 aligned pixels at a time, lanes outside the triangle fail the edge tests
+        minX &= ~3;
+        std::vector<float> &depth = levels[0];
+        for (int y = minY; y <= maxY; ++y) {
+            float py = (float) y + 0.5F;
+            float *row = depth.data() + (size_t) y * width;
+#ifdef OVEREDITOR_OCCLUSION_SSE
+            __m128 zero = _mm_setzero_ps();
+            __m128 offsets = _mm_set_ps(3.5F, 2.5F, 1.5F, 0.5F);
+            for (int x = minX; x <= maxX; x += 4) {
+                __m128 px = _mm_add_ps(_mm_set1_ps((float) x), offsets);
+                __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+                for (int i = 0; i < 3; ++i) {
+                    __m128 e = _mm_add_ps(
+                            _mm_mul_ps(_mm_set1_ps(edgeA[i]), px),
+                            _mm_set1_ps(edgeB[i] * py + edgeC[i])
+                    );
+                    inside = _mm_and_ps(inside, _mm_cmpge_ps(e, zero));
+                }
+                if (_mm_movemask_ps(inside) == 0) {
+                    continue;
+                }
+                __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(depthA), px), _mm_set1_ps(depthB * py + depthC));
+                __m128 stored = _mm_loadu_ps(row + x);
+                __m128 nearest = _mm_min_ps(stored, z);
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, stored)));
+            }
+#else
+            for (int x = minX; x <= maxX; ++x) {
+                float px = (float) x + 0.5F;
+                bool inside = true;
+                for (int i = 0; i < 3; ++i) {
+                    inside &= edgeA[i] * px + edgeB[i] * py + edgeC[i] >= 0;
+                }
+                if (inside) {
+                    row[x] = std::min(row[x], depthA * px + depthB * py + depthC);
+                }
+            }
+#endif
+        }
+    }
+
+    size_t OcclusionBuffer::rasterize(const OccluderMesh &mesh, const glm::mat4 &modelViewProjection) {
+        std::vector<glm::vec4> clip;
+        clip.reserve(mesh.vertices.size());
+        for (const glm::vec3 &vertex : mesh.vertices) {
+            clip.push_back(modelViewProjection * glm::vec4(vertex, 1.0F));
+        }
+        size_t drawn = 0;
+        for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+            glm::vec3 screen[3];
+            bool crossesNear = false;
+            for (int v = 0; v < 3; ++v) {
+                const glm::vec4 &p = clip[mesh.indices[i + v]];
+                if (p.w < nearW || p.z < 0) {
+                    crossesNear = true;
+                    break;
+                }
+                screen[v] = glm::vec3(
+                        (p.x / p.w * 0.5F + 0.5F) * (float) width,
+                        (p.y / p.w * 0.5F + 0.5F) * (float) height,
+                        p.z / p.w
+                );
+            }
+            if (crossesNear) {
+                continue;
+            }
+            rasterizeTriangle(screen[0], screen[1], screen[2]);
+            drawn++;
+        }
+        return drawn;
+    }
+
+    void OcclusionBuffer::buildPyramid() {
+        for (size_t level = 1; level < levels.size(); ++level) {
+            const std::vector<float> &below = levels[level - 1];
+            std::vector<float> &above = levels[level];
+            uint32_t belowWidth = levelWidths[level - 1], belowHeight = levelHeights[level - 1];
+            for (uint32_t y = 0; y < levelHeights[level]; ++y) {
+                uint32_t y0 = y * 2, y1 = std::min(y0 + 1, belowHeight - 1);
+                for (uint32_t x = 0; x < levelWidths[level]; ++x) {
+                    uint32_t x0 = x * 2, x1 = std::min(x0 + 1, belowWidth - 1);
+                    above[(size_t) y * levelWidths[level] + x] = std::max(
+                            std::max(below[(size_t) y0 * belowWidth + x0], below[(size_t) y0 * belowWidth + x1]),
+                            std::max(below[(size_t) y1 * belowWidth + x0], below[(size_t) y1 * belowWidth + x1])
+                    );
+                }
+            }
+        }
+    }
+
+    bool OcclusionBuffer::isOccluded(
+            const glm::vec3 &min,
+            const glm::vec3 &max,
+            const glm::mat4 &viewProjection
+    ) const {
+        float left = (float) width, right = 0, top = (float) height, bottom = 0;
+        float nearest = 1.0F;
+        for (int corner = 0; corner < 8; ++corner) {
+            glm::vec4 p = viewProjection * glm::vec4(
+                    corner & 1 ? max.x : min.x,
+                    corner & 2 ? max.y : min.y,
+                    corner & 4 ? max.z : min.z,
+                    1.0F
+            );
+            if (p.w < nearW || p.z < 0) {
+                return false;
+            }
+            float x = (p.x / p.w * 0.5F + 0.5F) * (float) width;
+            float y = (p.y / p.w * 0.5F + 0.5F) * (float) height;
+            left = std::min(left, x);
+            right = std::max(right, x);
+            top = std::min(top, y);
+            bottom = std::max(bottom, y);
+            nearest = std::min(nearest, p.z / p.w);
+        }
+        int x0 = std::max(0, (int) std::floor(left));
+        int x1 = std::min((int) width - 1, (int) std::ceil(right) - 1);
+        int y0 = std::max(0, (int) std::floor(top));
+        int y1 = std::min((int) height - 1, (int) std::ceil(bottom) - 1);
+        if (x0 > x1 || y0 > y1) {
+            // Off screen, that's for frustum culling to decide
+            return false;
+        }
+        // The level where the rectangle spans at most two texels each way
+        size_t level = 0;
+        int span = std::max(x1 - x0, y1 - y0);
+        while (span > 1 && level + 1 < levels.size()) {
+            span >>= 1;
+            level++;
+        }
+        const std::vector<float> &depth = levels[level];
+        uint32_t levelWidth = levelWidths[level];
+        for (int y = y0 >> level; y <= y1 >> level; ++y) {
+            for (int x = x0 >> level; x <= x1 >> level; ++x) {
+                if (nearest <= depth[(size_t) y * levelWidth + x]) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    uint32_t OcclusionBuffer::getWidth() const {
+        return width;
+    }
+
+    uint32_t OcclusionBuffer::getHeight() const {
+        return height;
+    }
+
+    size_t OcclusionBuffer::getLevelCount() const {
+        return levels.size();
+    }
+
+    const float *OcclusionBuffer::getLevel(size_t level) const {
+        return levels[level].data();
+    }
+
+    OcclusionStatistics cullOccluded(
+            OcclusionBuffer &buffer,
+            const std::vector<Occluder> &occluders,
+            const glm::mat4 &viewProjection,
+            const glm::vec4 *spheres,
+            size_t count,
+            uint32_t *masks,
+            uint32_t bit
+    ) {
+        OcclusionStatistics statistics;
+        auto start = Clock::now();
+        buffer.clear();
+        for (const Occluder &occluder : occluders) {
+            statistics.triangles += buffer.rasterize(*occluder.mesh, viewProjection * occluder.model);
+        }
+        buffer.buildPyramid();
+        auto rasterized = Clock::now();
+        statistics.rasterizeMilliseconds = std::chrono::duration<double, std::milli>(rasterized - start).count();
+        for (size_t i = 0; i < count; ++i) {
+            if (!(masks[i] & bit)) {
+                continue;
+            }
+            statistics.tested++;
+            const glm::vec4 &sphere = spheres[i];
+            glm::vec3 center(sphere.x, sphere.y, sphere.z);
+            glm::vec3 extent(sphere.w);
+            if (buffer.isOccluded(center - extent, center + extent, viewProjection)) {
+                masks[i] &= ~bit;
+                statistics.occluded++;
+            }
+        }
+        statistics.testMilliseconds = std::chrono::duration<double, std::milli>(Clock::now() - rasterized).count();
+        return statistics;
+    }
+}
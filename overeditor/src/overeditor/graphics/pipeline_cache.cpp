@@ -0,0 +1,80 @@
+#include <overeditor/graphics/pipeline_cache.h>
+
+#include <cstring>
+#include <fstream>
+#include <plog/Log.h>
+
+/**
+ * Size of the header every pipeline cache starts with: length, version, vendor id, device id and cache uuid
+ */
+#define PIPELINE_CACHE_HEADER_SIZE (16 + VK_UUID_SIZE)
+
+namespace overeditor::graphics {
+
+    PipelineCache::PipelineCache(std::filesystem::path path) : path(std::move(path)), initialData(), cache() {}
+
+    void PipelineCache::load() {
+        std::ifstream file(path, std::ios::ate | std::ios::binary);
+        if (!file.is_open()) {
+            return;
+        }
+        auto size = (size_t) file.tellg();
+        initialData.resize(size);
+        file.seekg(0);
+        file.read(initialData.data(), size);
+        if (!file) {
+            initialData.clear();
+        }
+    }
+
+    bool PipelineCache::isCompatible(const vk::PhysicalDeviceProperties &properties) const {
+        if (initialData.size() < PIPELINE_CACHE_HEADER_SIZE) {
+            return false;
+        }
+        uint32_t header[4];
+        std::memcpy(header, initialData.data(), sizeof(header));
+        return header[1] == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+               && header[2] == properties.vendorID
+               && header[3] == properties.deviceID
+               && std::memcmp(initialData.data() + 16, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+    }
+
+    void PipelineCache::create(const vk::Device &device, const vk::PhysicalDeviceProperties &properties) {
+        bool compatible = isCompatible(properties);
+        if (!initialData.empty() && !compatible) {
+            LOG_INFO << "Discarding pipeline cache written by a different device or driver";
+        }
+        cache = device.createPipelineCache(vk::PipelineCacheCreateInfo(
+                (vk::PipelineCacheCreateFlags) 0,
+                compatible ? initialData.size() : 0,
+                compatible ? initialData.data() : nullptr
+        ));
+        initialData.clear();
+        initialData.shrink_to_fit();
+    }
+
+    void PipelineCache::save(const vk::Device &device) const {
+        if (!cache) {
+            return;
+        }
+        std::vector<uint8_t> data = device.getPipelineCacheData(cache);
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            LOG_WARNING << "Unable to write pipeline cache to " << path.string();
+            return;
+        }
+        file.write(reinterpret_cast<const char *>(data.data()), data.size());
+    }
+
+    void PipelineCache::dispose(const vk::Device &device) {
+        if (cache) {
+            device.destroy(cache);
+            cache = nullptr;
+        }
+    }
+
+    const vk::PipelineCache &PipelineCache::getCache() const {
+        return cache;
+    }
+}
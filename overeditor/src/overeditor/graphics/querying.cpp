@@ -1,5 +1,6 @@
 #include <overeditor/graphics/querying.h>
 #include <plog/Log.h>
+#include <fstream>
 
 #define DISCRETE_GPU_BONUS 1500
 namespace overeditor::graphics {
@@ -132,4 +133,33 @@ namespace overeditor::graphics {
         return presentModes;
     }
 
-}
\ No newline at end of file
+    ElectedDeviceRecord::ElectedDeviceRecord() : vendorID(0), deviceID(0), driverVersion(0) {}
+
+    ElectedDeviceRecord::ElectedDeviceRecord(const vk::PhysicalDeviceProperties &properties)
+            : vendorID(properties.vendorID), deviceID(properties.deviceID),
+              driverVersion(properties.driverVersion) {}
+
+    bool ElectedDeviceRecord::load(const std::filesystem::path &path, ElectedDeviceRecord &record) {
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            return false;
+        }
+        file >> record.vendorID >> record.deviceID >> record.driverVersion;
+        return !file.fail();
+    }
+
+    void ElectedDeviceRecord::save(const std::filesystem::path &path) const {
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream file(path, std::ios::trunc);
+        if (!file.is_open()) {
+            LOG_WARNING << "Unable to write elected device to " << path.string();
+            return;
+        }
+        file << vendorID << ' ' << deviceID << ' ' << driverVersion << '\n';
+    }
+
+    bool ElectedDeviceRecord::matches(const vk::PhysicalDeviceProperties &properties) const {
+        return properties.vendorID == vendorID && properties.deviceID == deviceID
+               && properties.driverVersion == driverVersion;
+    }
+}
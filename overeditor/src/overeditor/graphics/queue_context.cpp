@@ -6,11 +6,13 @@ namespace overeditor::graphics {
             const vk::Device &device,
             const QueueFamilyIndices &qIndices,
             uint32_t graphicsIndex,
-            uint32_t presentationIndex
-    ) {
+            uint32_t presentationIndex,
+            uint32_t computeIndex
+    ) : computeIndex(computeIndex) {
         familyIndices = qIndices;
         graphicsQueue = device.getQueue(graphicsIndex, 0);
         presentationQueue = device.getQueue(presentationIndex, 0);
+        computeQueue = device.getQueue(computeIndex, 0);
     }
 
     const QueueFamilyIndices &QueueContext::getFamilyIndices() const {
@@ -24,4 +26,29 @@ namespace overeditor::graphics {
     const vk::Queue &QueueContext::getPresentationQueue() const {
         return presentationQueue;
     }
-}
\ No newline at end of file
+
+    const vk::Queue &QueueContext::getComputeQueue() const {
+        return computeQueue;
+    }
+
+    uint32_t QueueContext::getComputeFamilyIndex() const {
+        return computeIndex;
+    }
+
+    bool QueueContext::hasAsyncCompute() const {
+        return familyIndices.getCompute().present();
+    }
+
+    std::unique_lock<std::mutex> QueueContext::lock(const vk::Queue &queue) const {
+        if (queue == graphicsQueue) {
+            return std::unique_lock<std::mutex>(graphicsMutex);
+        }
+        if (queue == presentationQueue) {
+            return std::unique_lock<std::mutex>(presentationMutex);
+        }
+        if (queue == computeQueue) {
+            return std::unique_lock<std::mutex>(computeMutex);
+        }
+        throw std::runtime_error("Queue doesn't belong to this context");
+    }
+}
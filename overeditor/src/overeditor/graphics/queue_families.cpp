@@ -29,6 +29,7 @@ namespace overeditor::graphics {
     ) {
         graphics.offer(index, properties, device, surface);
         presentation.offer(index, properties, device, surface);
+        compute.offer(index, properties, device, surface);
     }
 
     QueueFamilyIndices::QueueFamilyIndices() : graphics(vk::QueueFlagBits::eGraphics) {}
@@ -41,6 +42,10 @@ namespace overeditor::graphics {
         return presentation;
     }
 
+    const AsyncComputeQueueFamily &QueueFamilyIndices::getCompute() const {
+        return compute;
+    }
+
 
     void FlagBitQueueFamily::offer(
             uint32_t index,
@@ -84,4 +89,18 @@ namespace overeditor::graphics {
     PresentationQueueFamily::PresentationQueueFamily() : lastScore(0) {
 
     }
+
+    AsyncComputeQueueFamily::AsyncComputeQueueFamily() = default;
+
+    void AsyncComputeQueueFamily::offer(
+            uint32_t index,
+            const vk::QueueFamilyProperties &properties,
+            const vk::PhysicalDevice &device,
+            const vk::SurfaceKHR &surface
+    ) {
+        if (!QueueFamily::index && (properties.queueFlags & vk::QueueFlagBits::eCompute)
+            && !(properties.queueFlags & vk::QueueFlagBits::eGraphics)) {
+            QueueFamily::index = index;
+        }
+    }
 }
\ No newline at end of file
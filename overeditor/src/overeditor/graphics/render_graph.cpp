@@ -0,0 +1,564 @@
+#include <overeditor/graphics/render_graph.h>
+#include <overeditor/utility/vulkan_utility.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace overeditor::graphics {
+
+    static const uint32_t noPass = UINT32_MAX;
+
+    struct UsageInfo {
+        vk::PipelineStageFlags stages;
+        vk::AccessFlags access;
+        vk::ImageLayout layout;
+        vk::ImageUsageFlags imageUsage;
+    };
+
+    static UsageInfo describe(RenderGraphUsage usage, bool write) {
+        vk::PipelineStageFlags tests =
+                vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests;
+        switch (usage) {
+            case eGraphColorAttachment:
+                // Blending reads what it writes over
+                return UsageInfo{
+                        vk::PipelineStageFlagBits::eColorAttachmentOutput,
+                        write ? vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite
+                              : vk::AccessFlagBits::eColorAttachmentRead,
+                        vk::ImageLayout::eColorAttachmentOptimal,
+                        vk::ImageUsageFlagBits::eColorAttachment
+                };
+            case eGraphDepthAttachment:
+                return UsageInfo{
+                        tests,
+                        write ? vk::AccessFlagBits::eDepthStencilAttachmentRead |
+                                vk::AccessFlagBits::eDepthStencilAttachmentWrite
+                              : vk::AccessFlagBits::eDepthStencilAttachmentRead,
+                        vk::ImageLayout::eDepthStencilAttachmentOptimal,
+                        vk::ImageUsageFlagBits::eDepthStencilAttachment
+                };
+            case eGraphDepthReadOnly:
+                return UsageInfo{
+                        tests,
+                        vk::AccessFlagBits::eDepthStencilAttachmentRead,
+                        vk::ImageLayout::eDepthStencilReadOnlyOptimal,
+                        vk::ImageUsageFlagBits::eDepthStencilAttachment
+                };
+            case eGraphSampled:
+                return UsageInfo{
+                        vk::PipelineStageFlagBits::eFragmentShader,
+                        vk::AccessFlagBits::eShaderRead,
+                        vk::ImageLayout::eShaderReadOnlyOptimal,
+                        vk::ImageUsageFlagBits::eSampled
+                };
+            case eGraphTransferSource:
+                return UsageInfo{
+                        vk::PipelineStageFlagBits::eTransfer,
+                        vk::AccessFlagBits::eTransferRead,
+                        vk::ImageLayout::eTransferSrcOptimal,
+                        vk::ImageUsageFlagBits::eTransferSrc
+                };
+            case eGraphTransferDestination:
+                // Reading means keeping the parts that aren't written, nothing is accessed for it
+                return UsageInfo{
+                        vk::PipelineStageFlagBits::eTransfer,
+                        write ? vk::AccessFlagBits::eTransferWrite : (vk::AccessFlags) 0,
+                        vk::ImageLayout::eTransferDstOptimal,
+                        vk::ImageUsageFlagBits::eTransferDst
+                };
+        }
+        throw std::runtime_error("Unknown render graph usage");
+    }
+
+    static vk::ImageAspectFlags getAspect(vk::Format format) {
+        switch (format) {
+            case vk::Format::eD16Unorm:
+            case vk::Format::eX8D24UnormPack32:
+            case vk::Format::eD32Sfloat:
+                return vk::ImageAspectFlagBits::eDepth;
+            case vk::Format::eD16UnormS8Uint:
+            case vk::Format::eD24UnormS8Uint:
+            case vk::Format::eD32SfloatS8Uint:
+                return vk::ImageAspectFlagBits::eDepth | vk::ImageAspectFlagBits::eStencil;
+            case vk::Format::eS8Uint:
+                return vk::ImageAspectFlagBits::eStencil;
+            default:
+                return vk::ImageAspectFlagBits::eColor;
+        }
+    }
+
+    static vk::DeviceSize alignUp(vk::DeviceSize value, vk::DeviceSize alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    RenderGraph::RenderGraph(const DeviceContext &context)
+            : context(&context), resources(), passes(), memories(), finalBarriers(), finalSourceStages(),
+              compiled(false), statistics() {}
+
+    uint32_t RenderGraph::importImage(
+            const std::string &name,
+            const std::vector<vk::Image> &images,
+            vk::Format format,
+            vk::ImageLayout initialLayout,
+            vk::ImageLayout finalLayout,
+            const vk::Semaphore &semaphore
+    ) {
+        if (compiled) {
+            throw std::runtime_error("Render graph is already compiled");
+        }
+        if (images.empty()) {
+            throw std::runtime_error("Imported image " + name + " has no images");
+        }
+        Resource resource{};
+        resource.name = name;
+        resource.format = format;
+        resource.aspect = getAspect(format);
+        resource.transient = false;
+        resource.images = images;
+        resource.initialLayout = initialLayout;
+        resource.finalLayout = finalLayout;
+        resource.semaphore = semaphore;
+        resources.push_back(resource);
+        return (uint32_t) resources.size() - 1;
+    }
+
+    uint32_t RenderGraph::createImage(const std::string &name, vk::Format format, vk::Extent2D extent) {
+        if (compiled) {
+            throw std::runtime_error("Render graph is already compiled");
+        }
+        Resource resource{};
+        resource.name = name;
+        resource.format = format;
+        resource.extent = extent;
+        resource.aspect = getAspect(format);
+        resource.transient = true;
+        resource.initialLayout = vk::ImageLayout::eUndefined;
+        resource.finalLayout = vk::ImageLayout::eUndefined;
+        resources.push_back(resource);
+        return (uint32_t) resources.size() - 1;
+    }
+
+    uint32_t RenderGraph::addPass(const std::string &name, const Recorder &recorder) {
+        if (compiled) {
+            throw std::runtime_error("Render graph is already compiled");
+        }
+        Pass pass{};
+        pass.name = name;
+        pass.recorder = recorder;
+        passes.push_back(pass);
+        return (uint32_t) passes.size() - 1;
+    }
+
+    void RenderGraph::read(uint32_t pass, uint32_t resource, RenderGraphUsage usage) {
+        passes[pass].accesses.push_back(Access{resource, usage, false});
+    }
+
+    void RenderGraph::write(uint32_t pass, uint32_t resource, RenderGraphUsage usage) {
+        passes[pass].accesses.push_back(Access{resource, usage, true});
+    }
+
+    void RenderGraph::cull() {
+        // Walking backwards, whether the contents an image has at that point are read later on
+        std::vector<bool> needed(resources.size());
+        for (size_t i = 0; i < resources.size(); ++i) {
+            needed[i] = !resources[i].transient && resources[i].finalLayout != vk::ImageLayout::eUndefined;
+        }
+        for (size_t p = passes.size(); p-- > 0;) {
+            Pass &pass = passes[p];
+            pass.culled = true;
+            for (const Access &access : pass.accesses) {
+                if (access.write && needed[access.resource]) {
+                    pass.culled = false;
+                }
+            }
+            if (pass.culled) {
+                continue;
+            }
+            // What the pass writes over was not needed by anyone before it, unless the pass reads it too
+            for (const Access &access : pass.accesses) {
+                if (access.write) {
+                    needed[access.resource] = false;
+                }
+            }
+            for (const Access &access : pass.accesses) {
+                if (!access.write) {
+                    needed[access.resource] = true;
+                }
+            }
+        }
+    }
+
+    void RenderGraph::allocateTransients() {
+        for (Resource &resource : resources) {
+            resource.firstPass = noPass;
+            resource.lastPass = noPass;
+        }
+        for (uint32_t p = 0; p < passes.size(); ++p) {
+            if (passes[p].culled) {
+                continue;
+            }
+            for (const Access &access : passes[p].accesses) {
+                Resource &resource = resources[access.resource];
+                if (resource.firstPass == noPass) {
+                    resource.firstPass = p;
+                }
+                resource.lastPass = p;
+                resource.usage |= describe(access.usage, access.write).imageUsage;
+            }
+        }
+        struct Placement {
+            uint32_t resource;
+            uint32_t memoryType;
+            vk::MemoryRequirements requirements;
+        };
+        auto &device = context->getDevice();
+        const auto &memoryProperties = context->getCandidate().getMemoryProperties();
+        std::vector<Placement> placements;
+        for (uint32_t r = 0; r < resources.size(); ++r) {
+            Resource &resource = resources[r];
+            if (!resource.transient || resource.firstPass == noPass) {
+                continue;
+            }
+            resource.image = device.createImage(
+                    vk::ImageCreateInfo(
+                            (vk::ImageCreateFlags) 0,
+                            vk::ImageType::e2D,
+                            resource.format,
+                            vk::Extent3D(resource.extent.width, resource.extent.height, 1),
+                            1, 1,
+                            vk::SampleCountFlagBits::e1,
+                            vk::ImageTiling::eOptimal,
+                            resource.usage,
+                            vk::SharingMode::eExclusive
+                    )
+            );
+            auto requirements = device.getImageMemoryRequirements(resource.image);
+            uint32_t memoryType = utility::findMemoryType(
+                    memoryProperties, requirements.memoryTypeBits, vk::MemoryPropertyFlagBits::eDeviceLocal
+            );
+            placements.push_back(Placement{r, memoryType, requirements});
+            statistics.unaliasedBytes += requirements.size;
+            statistics.transientImages++;
+        }
+        // Largest first, each at the lowest offset not taken by an image alive at the same time.
+        // Every memory type gets its own allocation.
+        std::sort(placements.begin(), placements.end(), [](const Placement &a, const Placement &b) {
+            if (a.memoryType != b.memoryType) {
+                return a.memoryType < b.memoryType;
+            }
+            return a.requirements.size > b.requirements.size;
+        });
+        size_t groupStart = 0;
+        while (groupStart < placements.size()) {
+            uint32_t memoryType = placements[groupStart].memoryType;
+            size_t groupEnd = groupStart;
+            vk::DeviceSize heapSize = 0;
+            for (; groupEnd < placements.size() && placements[groupEnd].memoryType == memoryType; ++groupEnd) {
+                Resource &resource = resources[placements[groupEnd].resource];
+                const vk::MemoryRequirements &requirements = placements[groupEnd].requirements;
+                vk::DeviceSize offset = 0;
+                bool moved = true;
+                while (moved) {
+                    moved = false;
+                    for (size_t other = groupStart; other < groupEnd; ++other) {
+                        const Resource &placed = resources[placements[other].resource];
+                        bool livesTogether = placed.firstPass <= resource.lastPass &&
+                                             resource.firstPass <= placed.lastPass;
+                        bool overlaps = placed.offset < offset + requirements.size &&
+                                        offset < placed.offset + placed.size;
+                        if (livesTogether && overlaps) {
+                            offset = alignUp(placed.offset + placed.size, requirements.alignment);
+                            moved = true;
+                        }
+                    }
+                }
+                resource.memory = (uint32_t) memories.size();
+                resource.offset = offset;
+                resource.size = requirements.size;
+                heapSize = std::max(heapSize, offset + requirements.size);
+            }
+            vk::DeviceMemory memory = context->allocateMemory(
+                    vk::MemoryAllocateInfo(heapSize, memoryType), utility::eMemoryAttachments
+            );
+            memories.push_back(memory);
+            statistics.transientBytes += heapSize;
+            for (size_t i = groupStart; i < groupEnd; ++i) {
+                Resource &resource = resources[placements[i].resource];
+                device.bindImageMemory(resource.image, memory, resource.offset);
+                resource.view = device.createImageView(
+                        vk::ImageViewCreateInfo(
+                                (vk::ImageViewCreateFlags) 0,
+                                resource.image,
+                                vk::ImageViewType::e2D,
+                                resource.format,
+                                vk::ComponentMapping(),
+                                vk::ImageSubresourceRange(resource.aspect, 0, 1, 0, 1)
+                        )
+                );
+            }
+            groupStart = groupEnd;
+        }
+    }
+
+    void RenderGraph::computeBarriers() {
+        struct State {
+            vk::ImageLayout layout;
+            // The last write, and the reads since then
+            vk::PipelineStageFlags writeStages, readStages;
+            vk::AccessFlags writeAccess;
+            // What the last write was already made visible to
+            vk::PipelineStageFlags visibleStages;
+            vk::AccessFlags visibleAccess;
+            bool used;
+        };
+        std::vector<State> states(resources.size());
+        for (size_t r = 0; r < resources.size(); ++r) {
+            states[r] = State{resources[r].initialLayout, {}, {}, {}, {}, {}, false};
+        }
+        for (uint32_t p = 0; p < passes.size(); ++p) {
+            Pass &pass = passes[p];
+            if (pass.culled) {
+                continue;
+            }
+            // A resource used more than once by the pass counts once, with everything it's used for
+            std::vector<uint32_t> used;
+            std::vector<UsageInfo> infos;
+            std::vector<bool> writes;
+            for (const Access &access : pass.accesses) {
+                UsageInfo info = describe(access.usage, access.write);
+                auto found = std::find(used.begin(), used.end(), access.resource);
+                if (found == used.end()) {
+                    used.push_back(access.resource);
+                    infos.push_back(info);
+                    writes.push_back(access.write);
+                    continue;
+                }
+                size_t index = found - used.begin();
+                if (infos[index].layout != info.layout) {
+                    throw std::runtime_error(
+                            "Pass " + pass.name + " uses " + resources[access.resource].name + " in two layouts"
+                    );
+                }
+                infos[index].stages |= info.stages;
+                infos[index].access |= info.access;
+                writes[index] = writes[index] || access.write;
+            }
+            for (size_t i = 0; i < used.size(); ++i) {
+                Resource &resource = resources[used[i]];
+                State &state = states[used[i]];
+                const UsageInfo &info = infos[i];
+                vk::PipelineStageFlags sourceStages;
+                vk::AccessFlags sourceAccess;
+                bool hazard = false;
+                if (!state.used) {
+                    if (resource.transient) {
+                        // Wait for the images that used the same memory before
+                        for (const Resource &other : resources) {
+                            if (!other.transient || other.firstPass == noPass || &other == &resource ||
+                                other.memory != resource.memory || other.lastPass >= resource.firstPass ||
+                                other.offset >= resource.offset + resource.size ||
+                                resource.offset >= other.offset + other.size) {
+                                continue;
+                            }
+                            const State &otherState = states[&other - resources.data()];
+                            sourceStages |= otherState.writeStages | otherState.readStages;
+                            sourceAccess |= otherState.writeAccess;
+                        }
+                        hazard = (bool) sourceStages;
+                    } else if (resource.semaphore) {
+                        // Chains with the semaphore wait, which happens at the same stage
+                        resource.waitStage = info.stages;
+                        sourceStages = info.stages;
+                    }
+                } else if (writes[i]) {
+                    hazard = state.writeStages || state.readStages;
+                    sourceStages = state.writeStages | state.readStages;
+                    sourceAccess = state.writeAccess;
+                } else if (state.writeStages) {
+                    hazard = (state.visibleStages & info.stages) != info.stages ||
+                             (state.visibleAccess & info.access) != info.access;
+                    sourceStages = state.writeStages;
+                    sourceAccess = state.writeAccess;
+                }
+                // Transients start every execution with undefined contents
+                vk::ImageLayout oldLayout = state.used ? state.layout : resource.transient
+                                                                        ? vk::ImageLayout::eUndefined
+                                                                        : resource.initialLayout;
+                bool transition = oldLayout != info.layout;
+                if (transition && state.used) {
+                    // A layout transition writes the image, so it must also wait for the reads since the last write
+                    sourceStages |= state.writeStages | state.readStages;
+                    sourceAccess |= state.writeAccess;
+                }
+                bool barrier = hazard || transition;
+                if (barrier) {
+                    pass.barriers.push_back(Barrier{used[i], sourceAccess, info.access, oldLayout, info.layout});
+                    pass.sourceStages |= sourceStages;
+                    pass.destinationStages |= info.stages;
+                }
+                if (writes[i]) {
+                    state.writeStages = info.stages;
+                    state.writeAccess = info.access;
+                    state.readStages = vk::PipelineStageFlags();
+                    state.visibleStages = vk::PipelineStageFlags();
+                    state.visibleAccess = vk::AccessFlags();
+                } else if (transition) {
+                    // Later reads in other stages must wait for the transition as they would for a write
+                    state.writeStages = info.stages;
+                    state.writeAccess = vk::AccessFlags();
+                    state.readStages = info.stages;
+                    state.visibleStages = info.stages;
+                    state.visibleAccess = info.access;
+                } else {
+                    state.readStages |= info.stages;
+                    if (barrier) {
+                        state.visibleStages |= info.stages;
+                        state.visibleAccess |= info.access;
+                    }
+                }
+                state.layout = info.layout;
+                state.used = true;
+            }
+        }
+        for (uint32_t r = 0; r < resources.size(); ++r) {
+            Resource &resource = resources[r];
+            const State &state = states[r];
+            if (resource.transient || resource.finalLayout == vk::ImageLayout::eUndefined) {
+                continue;
+            }
+            if (!state.used && resource.semaphore) {
+                resource.waitStage = vk::PipelineStageFlagBits::eTopOfPipe;
+            }
+            if (state.layout == resource.finalLayout) {
+                continue;
+            }
+            finalBarriers.push_back(
+                    Barrier{r, state.writeAccess, vk::AccessFlags(), state.layout, resource.finalLayout}
+            );
+            finalSourceStages |= state.writeStages | state.readStages;
+        }
+    }
+
+    void RenderGraph::compile() {
+        if (compiled) {
+            throw std::runtime_error("Render graph is already compiled");
+        }
+        cull();
+        allocateTransients();
+        computeBarriers();
+        for (const Pass &pass : passes) {
+            if (pass.culled) {
+                statistics.culledPasses++;
+                continue;
+            }
+            statistics.passes++;
+            statistics.imageBarriers += pass.barriers.size();
+            statistics.pipelineBarriers += pass.barriers.empty() ? 0 : 1;
+        }
+        statistics.imageBarriers += finalBarriers.size();
+        statistics.pipelineBarriers += finalBarriers.empty() ? 0 : 1;
+        compiled = true;
+    }
+
+    const vk::Image &RenderGraph::getImage(uint32_t resource, uint32_t imageIndex) const {
+        const Resource &r = resources[resource];
+        if (r.transient) {
+            return r.image;
+        }
+        return r.images.size() == 1 ? r.images[0] : r.images[imageIndex];
+    }
+
+    void RenderGraph::recordBarriers(
+            const vk::CommandBuffer &commandBuffer,
+            uint32_t imageIndex,
+            const std::vector<Barrier> &barriers,
+            vk::PipelineStageFlags sourceStages,
+            vk::PipelineStageFlags destinationStages
+    ) const {
+        if (barriers.empty()) {
+            return;
+        }
+        std::vector<vk::ImageMemoryBarrier> imageBarriers;
+        imageBarriers.reserve(barriers.size());
+        for (const Barrier &barrier : barriers) {
+            imageBarriers.emplace_back(
+                    barrier.sourceAccess, barrier.destinationAccess,
+                    barrier.oldLayout, barrier.newLayout,
+                    VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+                    getImage(barrier.resource, imageIndex),
+                    vk::ImageSubresourceRange(resources[barrier.resource].aspect, 0, 1, 0, 1)
+            );
+        }
+        // Nothing to wait for when every image is used for the first time
+        if (!sourceStages) {
+            sourceStages = vk::PipelineStageFlagBits::eTopOfPipe;
+        }
+        commandBuffer.pipelineBarrier(
+                sourceStages, destinationStages,
+                (vk::DependencyFlags) 0, nullptr, nullptr, imageBarriers
+        );
+    }
+
+    void RenderGraph::record(const vk::CommandBuffer &commandBuffer, uint32_t imageIndex) const {
+        if (!compiled) {
+            throw std::runtime_error("Render graph is not compiled");
+        }
+        for (const Pass &pass : passes) {
+            if (pass.culled) {
+                continue;
+            }
+            recordBarriers(commandBuffer, imageIndex, pass.barriers, pass.sourceStages, pass.destinationStages);
+            pass.recorder(commandBuffer, imageIndex);
+        }
+        recordBarriers(
+                commandBuffer, imageIndex, finalBarriers,
+                finalSourceStages, vk::PipelineStageFlagBits::eBottomOfPipe
+        );
+    }
+
+    void RenderGraph::getWaits(
+            std::vector<vk::Semaphore> &semaphores,
+            std::vector<vk::PipelineStageFlags> &stages
+    ) const {
+        for (const Resource &resource : resources) {
+            if (resource.semaphore && resource.waitStage) {
+                semaphores.push_back(resource.semaphore);
+                stages.push_back(resource.waitStage);
+            }
+        }
+    }
+
+    const vk::ImageView &RenderGraph::getView(uint32_t resource) const {
+        return resources[resource].view;
+    }
+
+    bool RenderGraph::isCulled(uint32_t pass) const {
+        return passes[pass].culled;
+    }
+
+    const RenderGraphStatistics &RenderGraph::getStatistics() const {
+        return statistics;
+    }
+
+    void RenderGraph::dispose() {
+        auto &device = context->getDevice();
+        for (Resource &resource : resources) {
+            if (resource.view) {
+                device.destroy(resource.view);
+            }
+            if (resource.image) {
+                device.destroy(resource.image);
+            }
+        }
+        for (vk::DeviceMemory &memory : memories) {
+            context->freeMemory(memory);
+        }
+        resources.clear();
+        passes.clear();
+        memories.clear();
+        finalBarriers.clear();
+        finalSourceStages = vk::PipelineStageFlags();
+        compiled = false;
+        statistics = RenderGraphStatistics();
+    }
+}
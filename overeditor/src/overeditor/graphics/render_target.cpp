@@ -0,0 +1,91 @@
+#include <overeditor/graphics/render_target.h>
+#include <overeditor/utility/vulkan_utility.h>
+
+namespace overeditor::graphics {
+
+    RenderTarget::RenderTarget(
+            const DeviceContext &context,
+            vk::Format format,
+            vk::Extent2D extent
+    ) : context(&context), extent(extent), image(), memory(), view(), framebuffer() {
+        auto &device = context.getDevice();
+        image = device.createImage(
+                vk::ImageCreateInfo(
+                        (vk::ImageCreateFlags) 0,
+                        vk::ImageType::e2D,
+                        format,
+                        vk::Extent3D(extent.width, extent.height, 1),
+                        1, 1,
+                        vk::SampleCountFlagBits::e1,
+                        vk::ImageTiling::eOptimal,
+                        vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc,
+                        vk::SharingMode::eExclusive
+                )
+        );
+        auto requirements = device.getImageMemoryRequirements(image);
+        memory = context.allocateMemory(
+                vk::MemoryAllocateInfo(
+                        requirements.size,
+                        utility::findMemoryType(
+                                context.getCandidate().getMemoryProperties(),
+                                requirements.memoryTypeBits,
+                                vk::MemoryPropertyFlagBits::eDeviceLocal
+                        )
+                ),
+                utility::eMemoryAttachments
+        );
+        device.bindImageMemory(image, memory, 0);
+        view = device.createImageView(
+                vk::ImageViewCreateInfo(
+                        (vk::ImageViewCreateFlags) 0,
+                        image,
+                        vk::ImageViewType::e2D,
+                        format,
+                        vk::ComponentMapping(),
+                        vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1)
+                )
+        );
+    }
+
+    void RenderTarget::createFramebuffer(const vk::RenderPass &renderPass, const vk::ImageView &depthView) {
+        auto &device = context->getDevice();
+        if (framebuffer) {
+            device.destroy(framebuffer);
+        }
+        vk::ImageView attachments[] = {view, depthView};
+        framebuffer = device.createFramebuffer(
+                vk::FramebufferCreateInfo(
+                        (vk::FramebufferCreateFlags) 0,
+                        renderPass,
+                        2, attachments,
+                        extent.width, extent.height, 1
+                )
+        );
+    }
+
+    void RenderTarget::dispose() {
+        if (!image) {
+            return;
+        }
+        auto &device = context->getDevice();
+        if (framebuffer) {
+            device.destroy(framebuffer);
+        }
+        device.destroy(view);
+        device.destroy(image);
+        context->freeMemory(memory);
+        image = nullptr;
+    }
+
+    const vk::Extent2D &RenderTarget::getExtent() const {
+        return extent;
+    }
+
+    const vk::Image &RenderTarget::getImage() const {
+        return image;
+    }
+
+    const vk::Framebuffer &RenderTarget::getFramebuffer() const {
+        return framebuffer;
+    }
+}
@@ -0,0 +1,78 @@
+#include <overeditor/graphics/resource_registry.h>
+
+#include <limits>
+
+namespace overeditor::graphics {
+
+    ResourceRegistry::ResourceRegistry(const DeviceContext &context)
+            : context(&context), mutex(), pools(), frame(1), retiredFrame(0) {}
+
+    void ResourceRegistry::dispose() {
+        std::lock_guard<std::mutex> lock(mutex);
+        uint64_t last = std::numeric_limits<uint64_t>::max();
+        collect(getPool<BufferResource>(), last);
+        collect(getPool<ImageResource>(), last);
+        collect(getPool<PipelineResource>(), last);
+        // Whatever is still alive goes too, slots that were released hold null resources
+        for (auto &slot : getPool<BufferResource>().slots) {
+            destroy(slot.resource);
+        }
+        for (auto &slot : getPool<ImageResource>().slots) {
+            destroy(slot.resource);
+        }
+        for (auto &slot : getPool<PipelineResource>().slots) {
+            destroy(slot.resource);
+        }
+        pools = decltype(pools)();
+    }
+
+    void ResourceRegistry::destroy(const BufferResource &resource) {
+        auto &device = context->getDevice();
+        device.destroy(resource.buffer);
+        if (resource.memory) {
+            context->freeMemory(resource.memory);
+        }
+    }
+
+    void ResourceRegistry::destroy(const ImageResource &resource) {
+        auto &device = context->getDevice();
+        device.destroy(resource.view);
+        device.destroy(resource.image);
+        if (resource.memory) {
+            context->freeMemory(resource.memory);
+        }
+    }
+
+    void ResourceRegistry::destroy(const PipelineResource &resource) {
+        auto &device = context->getDevice();
+        device.destroy(resource.pipeline);
+        device.destroy(resource.layout);
+    }
+
+    uint64_t ResourceRegistry::getFrame() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return frame;
+    }
+
+    uint64_t ResourceRegistry::endFrame() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return frame++;
+    }
+
+    void ResourceRegistry::retire(uint64_t frame) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (frame <= retiredFrame) {
+            return;
+        }
+        retiredFrame = frame;
+        collect(getPool<BufferResource>(), frame);
+        collect(getPool<ImageResource>(), frame);
+        collect(getPool<PipelineResource>(), frame);
+    }
+
+    size_t ResourceRegistry::getPendingCount() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return getPool<BufferResource>().pending.size() + getPool<ImageResource>().pending.size() +
+               getPool<PipelineResource>().pending.size();
+    }
+}
@@ -15,13 +15,13 @@ namespace overeditor::graphics::shaders {
         file.close();
     }
 
-    vk::ShaderModule ShaderSource::createModuleFor(const vk::Device &device) {
+    vk::ShaderModule ShaderSource::createModuleFor(const vk::Device &device) const {
         VkShaderModuleCreateInfo info;
         info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
         info.pNext = nullptr;
         info.codeSize = buf.size();
         info.flags = 0;
-        info.pCode = reinterpret_cast<uint32_t *>( buf.data());
+        info.pCode = reinterpret_cast<const uint32_t *>( buf.data());
 
         vk::ShaderModule mod;
         vkAssertOk(vkCreateShaderModule(
@@ -33,7 +33,36 @@ namespace overeditor::graphics::shaders {
         return mod;
     }
 
-    Shader::Shader() : owner(nullptr), fragment(nullptr), vertex(nullptr) {
+    ShaderLibrary::ShaderLibrary() : sources() {}
+
+    void ShaderLibrary::load(const std::filesystem::path &directory) {
+        if (!std::filesystem::is_directory(directory)) {
+            return;
+        }
+        for (auto &entry : std::filesystem::directory_iterator(directory)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".spv") {
+                sources.emplace(entry.path().filename().string(), ShaderSource(entry.path()));
+            }
+        }
+    }
+
+    bool ShaderLibrary::contains(const std::string &name) const {
+        return sources.find(name) != sources.end();
+    }
+
+    const ShaderSource &ShaderLibrary::get(const std::string &name) const {
+        auto found = sources.find(name);
+        if (found == sources.end()) {
+            throw std::runtime_error(std::string("Shader not loaded: ") + name);
+        }
+        return found->second;
+    }
+
+    size_t ShaderLibrary::size() const {
+        return sources.size();
+    }
+
+    Shader::Shader() : owner(nullptr), fragment(nullptr), vertex(nullptr), ownsLayout(false), handle() {
 
     }
 
@@ -41,12 +70,34 @@ namespace overeditor::graphics::shaders {
             const DeviceContext &deviceCtx,
             const vk::RenderPass &renderPass,
             const std::filesystem::path &fragmentPath,
-            const std::filesystem::path &vertexPath
+            const std::filesystem::path &vertexPath,
+            const vk::PipelineCache &cache,
+            DepthUsage depthUsage,
+            uint32_t subpass,
+            const vk::PipelineLayout &pipelineLayout,
+            const GeometryLayout *geometryLayout
+    ) {
+        initialize(
+                deviceCtx, renderPass, ShaderSource(fragmentPath), ShaderSource(vertexPath), cache, depthUsage, subpass,
+                pipelineLayout, geometryLayout
+        );
+    }
+
+    void Shader::initialize(
+            const DeviceContext &deviceCtx,
+            const vk::RenderPass &renderPass,
+            const ShaderSource &fragmentSource,
+            const ShaderSource &vertexSource,
+            const vk::PipelineCache &cache,
+            DepthUsage depthUsage,
+            uint32_t subpass,
+            const vk::PipelineLayout &pipelineLayout,
+            const GeometryLayout *geometryLayout
     ) {
-        auto device = deviceCtx.getDevice();
+        const vk::Device &device = deviceCtx.getDevice();
         owner = &device;
-        fragment = new ShaderSource(fragmentPath);
-        vertex = new ShaderSource(vertexPath);
+        fragment = new ShaderSource(fragmentSource);
+        vertex = new ShaderSource(vertexSource);
         fragModule = fragment->createModuleFor(device);
         vertModule = vertex->createModuleFor(device);
         vk::PipelineShaderStageCreateInfo fragmentInfo(
@@ -64,8 +115,16 @@ namespace overeditor::graphics::shaders {
         vk::PipelineShaderStageCreateInfo shaderStages[2] = {
                 vertexInfo, fragmentInfo
         };
+        vk::VertexInputBindingDescription binding;
+        std::vector<vk::VertexInputAttributeDescription> attributes;
+        if (geometryLayout != nullptr) {
+            binding = geometryLayout->getBinding(0);
+            attributes = geometryLayout->getAttributes(0);
+        }
         auto vertexInputInfo = vk::PipelineVertexInputStateCreateInfo(
-                (vk::PipelineVertexInputStateCreateFlags) 0
+                (vk::PipelineVertexInputStateCreateFlags) 0,
+                geometryLayout != nullptr ? 1 : 0, &binding,
+                (uint32_t) attributes.size(), attributes.data()
         );
         vk::PipelineInputAssemblyStateCreateInfo inputAssembly(
                 (vk::PipelineInputAssemblyStateCreateFlags) 0,
@@ -109,10 +168,22 @@ namespace overeditor::graphics::shaders {
                 vk::ColorComponentFlagBits::eA | vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG |
                 vk::ColorComponentFlagBits::eB
         );
+        // The prepass subpass has no color attachment to blend into
+        bool depthOnly = depthUsage == eDepthPrepass;
         vk::PipelineColorBlendStateCreateInfo colorBlending(
                 (vk::PipelineColorBlendStateCreateFlags) 0,
                 VK_FALSE, vk::LogicOp::eCopy,
-                1, &colorBlend
+                depthOnly ? 0 : 1, &colorBlend
+        );
+        // After a prepass the depth buffer already holds the closest surface, so only fragments equal to it pass and
+        // nothing needs writing. Drawables without a prepass use eDepthTestWrite pipelines to sort among themselves.
+        vk::PipelineDepthStencilStateCreateInfo depthStencil(
+                (vk::PipelineDepthStencilStateCreateFlags) 0,
+                VK_TRUE,
+                depthUsage == eDepthAfterPrepass ? VK_FALSE : VK_TRUE,
+                depthUsage == eDepthAfterPrepass ? vk::CompareOp::eEqual : vk::CompareOp::eLess,
+                VK_FALSE,
+                VK_FALSE
         );
         vk::DynamicState dynamicStates[] = {
                 vk::DynamicState::eViewport,
@@ -124,16 +195,17 @@ namespace overeditor::graphics::shaders {
                 dynamicStates
         );
 
-        layout = device.createPipelineLayout(
+        ownsLayout = !pipelineLayout;
+        layout = ownsLayout ? device.createPipelineLayout(
                 vk::PipelineLayoutCreateInfo(
                         (vk::PipelineLayoutCreateFlags) 0
                 )
-        );
+        ) : pipelineLayout;
 
 
         vk::GraphicsPipelineCreateInfo graphicsInfo(
                 (vk::PipelineCreateFlags) 0,
-                2,// Stage count
+                depthOnly ? 1 : 2,// Stage count, the vertex stage comes first
                 shaderStages, //
                 &vertexInputInfo,
                 &inputAssembly,
@@ -141,22 +213,63 @@ namespace overeditor::graphics::shaders {
                 &viewportInfo,
                 &rasterizer,
                 &multisampler,
-                nullptr,
+                &depthStencil,
                 &colorBlending,
-                nullptr, layout, renderPass, 0, nullptr, -1
+                nullptr, layout, renderPass, subpass, nullptr, -1
         );
-        pipeline = device.createGraphicsPipeline(nullptr, graphicsInfo);
+        pipeline = device.createGraphicsPipeline(cache, graphicsInfo);
     }
 
     const vk::Pipeline &Shader::getPipeline() const {
         return pipeline;
     }
 
+    const vk::PipelineLayout &Shader::getLayout() const {
+        return layout;
+    }
+
+    const PipelineHandle &Shader::getHandle() const {
+        return handle;
+    }
+
+    const PipelineHandle &Shader::registerPipeline(ResourceRegistry &registry) {
+        if (handle.isNull()) {
+            handle = registry.add(PipelineResource{pipeline, ownsLayout ? layout : vk::PipelineLayout()});
+        }
+        return handle;
+    }
+
     Shader::~Shader() {
-        owner->destroy(pipeline);
-        owner->destroy(layout);
+        if (owner == nullptr) {
+            // Never initialized
+            return;
+        }
+        // A registered pipeline belongs to the registry
+        if (handle.isNull()) {
+            owner->destroy(pipeline);
+            if (ownsLayout) {
+                owner->destroy(layout);
+            }
+        }
+        owner->destroy(fragModule);
+        owner->destroy(vertModule);
+    }
+
+    void Shader::dispose(ResourceRegistry &registry) {
+        if (owner == nullptr) {
+            return;
+        }
+        if (handle.isNull()) {
+            registry.defer(PipelineResource{pipeline, ownsLayout ? layout : vk::PipelineLayout()});
+        } else {
+            registry.release(handle);
+            handle = PipelineHandle();
+        }
+        // Only read while creating the pipeline
         owner->destroy(fragModule);
         owner->destroy(vertModule);
+        pipeline = nullptr;
+        owner = nullptr;
     }
 
     ShaderSource *Shader::getFragment() const {
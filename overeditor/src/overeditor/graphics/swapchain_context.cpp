@@ -12,6 +12,11 @@ namespace overeditor::graphics {
         vk::Extent2D extent = scSupport.selectSwapExtent();
         const auto &surfaceCapabilities = scSupport.getSurfaceCapabilities();
         uint32_t imageCount = surfaceCapabilities.minImageCount + 1;
+        // Transfer destination lets offscreen render targets be copied in
+        imageUsage = vk::ImageUsageFlagBits::eColorAttachment;
+        if (surfaceCapabilities.supportedUsageFlags & vk::ImageUsageFlagBits::eTransferDst) {
+            imageUsage |= vk::ImageUsageFlagBits::eTransferDst;
+        }
         auto info = vk::SwapchainCreateInfoKHR(
                 (vk::SwapchainCreateFlagsKHR) 0, // Flags
                 surface, // Surface
@@ -20,7 +25,7 @@ namespace overeditor::graphics {
                 surfaceFormat.colorSpace, // imageColorSpace
                 extent, // imageExtent
                 1, // imageArrayLayers
-                vk::ImageUsageFlagBits::eColorAttachment // imageUsage
+                imageUsage // imageUsage
         );
         uint32_t graphicsIndex, presentIndex;
         if (!qIndices.getGraphics().tryGet(&graphicsIndex)) {
@@ -110,6 +115,10 @@ namespace overeditor::graphics {
         return swapchainExtent;
     }
 
+    vk::ImageUsageFlags SwapChainContext::getImageUsage() const {
+        return imageUsage;
+    }
+
     const vk::Device *SwapChainContext::getDevicePtr() const {
         return devicePtr;
     }
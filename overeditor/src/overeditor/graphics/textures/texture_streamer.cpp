@@ -0,0 +1,492 @@
+#include <overeditor/graphics/textures/texture_streamer.h>
+#include <overeditor/utility/vulkan_utility.h>
+#include <plog/Log.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <limits>
+
+namespace overeditor::graphics::textures {
+
+    TextureDescription::TextureDescription(
+            vk::Format format,
+            uint32_t width,
+            uint32_t height,
+            uint32_t mipCount,
+            uint32_t blockSize,
+            uint32_t blockExtent
+    ) : format(format), width(width), height(height), mipCount(mipCount),
+        blockSize(blockSize), blockExtent(blockExtent) {}
+
+    vk::Format TextureDescription::getFormat() const {
+        return format;
+    }
+
+    uint32_t TextureDescription::getWidth() const {
+        return width;
+    }
+
+    uint32_t TextureDescription::getHeight() const {
+        return height;
+    }
+
+    uint32_t TextureDescription::getMipCount() const {
+        return mipCount;
+    }
+
+    vk::Extent3D TextureDescription::getMipExtent(uint32_t level) const {
+        return vk::Extent3D(
+                std::max(width >> level, 1U),
+                std::max(height >> level, 1U),
+                1
+        );
+    }
+
+    vk::DeviceSize TextureDescription::getMipSize(uint32_t level) const {
+        auto extent = getMipExtent(level);
+        vk::DeviceSize blocksX = (extent.width + blockExtent - 1) / blockExtent;
+        vk::DeviceSize blocksY = (extent.height + blockExtent - 1) / blockExtent;
+        return blocksX * blocksY * blockSize;
+    }
+
+    TextureStreamer::TextureStreamer(
+            const DeviceContext &context,
+            ResourceRegistry &resources,
+            const TextureStreamingSettings &settings
+    ) : context(&context), resources(&resources), settings(settings), statistics(), textures(), frame(0),
+        uploadInFlight(false), stagingCapacity(0), stagingData(nullptr),
+        completedMutex(), completed(), worker() {
+        auto &device = context.getDevice();
+        uploadPool = device.createCommandPool(
+                vk::CommandPoolCreateInfo(
+                        (vk::CommandPoolCreateFlags) vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+                        context.getQueueContext()->getFamilyIndices().getGraphics().get()
+                )
+        );
+        uploadBuffer = device.allocateCommandBuffers(
+                vk::CommandBufferAllocateInfo(
+                        uploadPool,
+                        vk::CommandBufferLevel::ePrimary,
+                        1
+                )
+        )[0];
+        uploadFence = device.createFence(vk::FenceCreateInfo());
+        ensureStagingCapacity(settings.uploadBytesPerFrame);
+    }
+
+    TextureStreamer::~TextureStreamer() {
+        auto &device = context->getDevice();
+        if (uploadInFlight) {
+            device.waitForFences(1, &uploadFence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+        }
+        for (StreamedTexture &texture : textures) {
+            resources->release(texture.resource);
+        }
+        if (stagingData != nullptr) {
+            device.unmapMemory(stagingMemory);
+        }
+        device.destroy(staging);
+        context->freeMemory(stagingMemory);
+        device.destroy(uploadFence);
+        device.destroy(uploadPool);
+    }
+
+    TextureHandle TextureStreamer::add(const std::shared_ptr<TextureSource> &source) {
+        const auto &description = source->getDescription();
+        uint32_t mipCount = description.getMipCount();
+        if (mipCount == 0) {
+            throw std::runtime_error("Textures must have at least one mip level");
+        }
+        uint32_t minimumBase = mipCount - 1;
+        for (uint32_t level = 0; level < mipCount; ++level) {
+            auto extent = description.getMipExtent(level);
+            if (std::max(extent.width, extent.height) <= settings.residentMipExtent) {
+                minimumBase = level;
+                break;
+            }
+        }
+        auto handle = (TextureHandle) textures.size();
+        StreamedTexture texture;
+        texture.source = source;
+        texture.residentBytes = 0;
+        texture.residentBase = mipCount;
+        texture.minimumBase = minimumBase;
+        texture.texelDensity = 0;
+        texture.lastUsedFrame = frame;
+        texture.loading = false;
+        textures.push_back(texture);
+        requestLoad(handle, minimumBase);
+        return handle;
+    }
+
+    void TextureStreamer::recordTexelDensity(TextureHandle handle, float texelsPerPixel) {
+        auto &texture = textures[handle];
+        texture.texelDensity = std::max(texture.texelDensity, texelsPerPixel);
+        texture.lastUsedFrame = frame;
+    }
+
+    void TextureStreamer::requestLoad(TextureHandle handle, uint32_t base) {
+        auto &texture = textures[handle];
+        texture.loading = true;
+        auto source = texture.source;
+        uint32_t end = texture.residentBase;
+        worker.enqueue([this, source, handle, base, end] {
+            MipLoad load;
+            load.handle = handle;
+            load.base = base;
+            load.mips.reserve(end - base);
+            for (uint32_t level = base; level < end; ++level) {
+                load.mips.push_back(source->loadMip(level));
+            }
+            std::lock_guard<std::mutex> lock(completedMutex);
+            completed.push_back(std::move(load));
+        });
+    }
+
+    void TextureStreamer::retireFinishedUpload() {
+        if (!uploadInFlight) {
+            return;
+        }
+        auto &device = context->getDevice();
+        if (device.getFenceStatus(uploadFence) != vk::Result::eSuccess) {
+            return;
+        }
+        device.resetFences(1, &uploadFence);
+        uploadInFlight = false;
+    }
+
+    void TextureStreamer::ensureStagingCapacity(vk::DeviceSize capacity) {
+        if (capacity <= stagingCapacity) {
+            return;
+        }
+        auto &device = context->getDevice();
+        if (stagingData != nullptr) {
+            device.unmapMemory(stagingMemory);
+            device.destroy(staging);
+            context->freeMemory(stagingMemory);
+        }
+        staging = device.createBuffer(
+                vk::BufferCreateInfo(
+                        (vk::BufferCreateFlags) 0,
+                        capacity,
+                        vk::BufferUsageFlagBits::eTransferSrc,
+                        vk::SharingMode::eExclusive
+                )
+        );
+        auto requirements = device.getBufferMemoryRequirements(staging);
+        stagingMemory = context->allocateMemory(
+                vk::MemoryAllocateInfo(
+                        requirements.size,
+                        utility::findMemoryType(
+                                context->getCandidate().getMemoryProperties(),
+                                requirements.memoryTypeBits,
+                                vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+                        )
+                ),
+                utility::eMemoryStaging
+        );
+        device.bindBufferMemory(staging, stagingMemory, 0);
+        stagingData = static_cast<uint8_t *>(device.mapMemory(stagingMemory, 0, capacity));
+        stagingCapacity = capacity;
+    }
+
+    bool TextureStreamer::makeRoom(vk::DeviceSize bytes, TextureHandle requester) {
+        while (statistics.residentBytes + bytes > settings.budget) {
+            // Least recently used texture that still has streamed mips and wasn't drawn in the frame that was just
+            // rendered, whose densities were recorded with the frame number before update incremented it
+            StreamedTexture *victim = nullptr;
+            for (TextureHandle i = 0; i < textures.size(); ++i) {
+                auto &candidate = textures[i];
+                if (i == requester || candidate.loading || candidate.lastUsedFrame + 1 >= frame ||
+                    candidate.residentBase >= candidate.minimumBase) {
+                    continue;
+                }
+                if (victim == nullptr || candidate.lastUsedFrame < victim->lastUsedFrame) {
+                    victim = &candidate;
+                }
+            }
+            if (victim == nullptr) {
+                return false;
+            }
+            vk::DeviceSize before = victim->residentBytes;
+            relocate(*victim, victim->minimumBase, nullptr, 0);
+            statistics.evictedBytes += before - victim->residentBytes;
+        }
+        return true;
+    }
+
+    void TextureStreamer::relocate(
+            StreamedTexture &texture,
+            uint32_t newBase,
+            const MipLoad *load,
+            vk::DeviceSize stagingOffset
+    ) {
+        auto &device = context->getDevice();
+        const auto &description = texture.source->getDescription();
+        uint32_t mipCount = description.getMipCount();
+        uint32_t oldBase = texture.residentBase;
+        uint32_t levels = mipCount - newBase;
+
+        vk::Image image = device.createImage(
+                vk::ImageCreateInfo(
+                        (vk::ImageCreateFlags) 0,
+                        vk::ImageType::e2D,
+                        description.getFormat(),
+                        description.getMipExtent(newBase),
+                        levels, 1,
+                        vk::SampleCountFlagBits::e1,
+                        vk::ImageTiling::eOptimal,
+                        vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc |
+                        vk::ImageUsageFlagBits::eSampled,
+                        vk::SharingMode::eExclusive,
+                        0, nullptr,
+                        vk::ImageLayout::eUndefined
+                )
+        );
+        auto requirements = device.getImageMemoryRequirements(image);
+        vk::DeviceMemory memory = context->allocateMemory(
+                vk::MemoryAllocateInfo(
+                        requirements.size,
+                        utility::findMemoryType(
+                                context->getCandidate().getMemoryProperties(),
+                                requirements.memoryTypeBits,
+                                vk::MemoryPropertyFlagBits::eDeviceLocal
+                        )
+                ),
+                utility::eMemoryTextures
+        );
+        device.bindImageMemory(image, memory, 0);
+        vk::ImageView view = device.createImageView(
+                vk::ImageViewCreateInfo(
+                        (vk::ImageViewCreateFlags) 0,
+                        image,
+                        vk::ImageViewType::e2D,
+                        description.getFormat(),
+                        vk::ComponentMapping(),
+                        vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, levels, 0, 1)
+                )
+        );
+
+        std::vector<vk::ImageMemoryBarrier> toTransfer;
+        toTransfer.emplace_back(
+                (vk::AccessFlags) 0, vk::AccessFlagBits::eTransferWrite,
+                vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal,
+                VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+                image,
+                vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, levels, 0, 1)
+        );
+        bool hasOld = oldBase < mipCount;
+        if (hasOld) {
+            toTransfer.emplace_back(
+                    vk::AccessFlagBits::eShaderRead, vk::AccessFlagBits::eTransferRead,
+                    vk::ImageLayout::eShaderReadOnlyOptimal, vk::ImageLayout::eTransferSrcOptimal,
+                    VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+                    texture.image,
+                    vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, mipCount - oldBase, 0, 1)
+            );
+        }
+        uploadBuffer.pipelineBarrier(
+                vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eTopOfPipe,
+                vk::PipelineStageFlagBits::eTransfer,
+                (vk::DependencyFlags) 0,
+                nullptr, nullptr, toTransfer
+        );
+        // Keep the mips both images have in common
+        if (hasOld) {
+            std::vector<vk::ImageCopy> copies;
+            for (uint32_t level = std::max(newBase, oldBase); level < mipCount; ++level) {
+                copies.emplace_back(
+                        vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, level - oldBase, 0, 1),
+                        vk::Offset3D(),
+                        vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, level - newBase, 0, 1),
+                        vk::Offset3D(),
+                        description.getMipExtent(level)
+                );
+            }
+            uploadBuffer.copyImage(
+                    texture.image, vk::ImageLayout::eTransferSrcOptimal,
+                    image, vk::ImageLayout::eTransferDstOptimal,
+                    copies
+            );
+        }
+        // Upload the newly loaded mips
+        if (load != nullptr) {
+            std::vector<vk::BufferImageCopy> copies;
+            vk::DeviceSize offset = stagingOffset;
+            for (uint32_t i = 0; i < load->mips.size(); ++i) {
+                uint32_t level = load->base + i;
+                auto &data = load->mips[i];
+                std::memcpy(stagingData + offset, data.data(), data.size());
+                copies.emplace_back(
+                        offset, 0, 0,
+                        vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, level - newBase, 0, 1),
+                        vk::Offset3D(),
+                        description.getMipExtent(level)
+                );
+                offset += data.size();
+            }
+            uploadBuffer.copyBufferToImage(staging, image, vk::ImageLayout::eTransferDstOptimal, copies);
+        }
+        vk::ImageMemoryBarrier toShader(
+                vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead,
+                vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal,
+                VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+                image,
+                vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, levels, 0, 1)
+        );
+        uploadBuffer.pipelineBarrier(
+                vk::PipelineStageFlagBits::eTransfer,
+                vk::PipelineStageFlagBits::eFragmentShader,
+                (vk::DependencyFlags) 0,
+                nullptr, nullptr, toShader
+        );
+        if (hasOld) {
+            // Copied from by the upload and possibly still sampled by frames in flight
+            resources->release(texture.resource);
+        }
+        statistics.residentBytes -= texture.residentBytes;
+        texture.resource = resources->add(ImageResource{image, view, memory});
+        texture.image = image;
+        texture.view = view;
+        texture.residentBase = newBase;
+        texture.residentBytes = requirements.size;
+        statistics.residentBytes += texture.residentBytes;
+    }
+
+    void TextureStreamer::update() {
+        frame++;
+        retireFinishedUpload();
+        // Turn last frame's density feedback into mip requests
+        for (TextureHandle i = 0; i < textures.size(); ++i) {
+            auto &texture = textures[i];
+            float density = texture.texelDensity;
+            texture.texelDensity = 0;
+            if (texture.loading || density <= 0) {
+                continue;
+            }
+            auto wanted = (uint32_t) std::max(0.0F, std::floor(std::log2(density)));
+            wanted = std::min(wanted, texture.minimumBase);
+            if (wanted < texture.residentBase) {
+                requestLoad(i, wanted);
+            }
+        }
+        statistics.uploadedBytes = 0;
+        statistics.textureCount = textures.size();
+        {
+            std::lock_guard<std::mutex> lock(completedMutex);
+            statistics.pendingLoads = completed.size() + worker.getPendingCount();
+        }
+        if (uploadInFlight) {
+            return;
+        }
+        ensureStagingCapacity(settings.uploadBytesPerFrame);
+        uploadBuffer.begin(
+                vk::CommandBufferBeginInfo(
+                        (vk::CommandBufferUsageFlags) vk::CommandBufferUsageFlagBits::eOneTimeSubmit
+                )
+        );
+        vk::DeviceSize offset = 0;
+        bool recorded = false;
+        // Loads that didn't fit in the budget, retried first next frame
+        std::vector<MipLoad> waiting;
+        while (true) {
+            MipLoad load;
+            {
+                std::lock_guard<std::mutex> lock(completedMutex);
+                if (completed.empty()) {
+                    break;
+                }
+                vk::DeviceSize bytes = 0;
+                for (auto &mip : completed.front().mips) {
+                    bytes += mip.size();
+                }
+                if (offset > 0 && offset + bytes > settings.uploadBytesPerFrame) {
+                    // Per-frame cap reached, the rest waits for the next frame
+                    break;
+                }
+                load = std::move(completed.front());
+                completed.pop_front();
+            }
+            auto &texture = textures[load.handle];
+            vk::DeviceSize bytes = 0;
+            for (auto &mip : load.mips) {
+                bytes += mip.size();
+            }
+            if (!makeRoom(bytes, load.handle)) {
+                // The texture stays loading so it isn't requested again, and is uploaded once room was freed
+                if (!load.waitingForRoom) {
+                    LOG_WARNING << "Texture streaming budget exhausted, holding " << load.mips.size()
+                                << " mip(s) of texture #" << load.handle << " until there is room";
+                    load.waitingForRoom = true;
+                }
+                waiting.push_back(std::move(load));
+                continue;
+            }
+            texture.loading = false;
+            if (offset == 0) {
+                ensureStagingCapacity(bytes);
+            }
+            relocate(texture, load.base, &load, offset);
+            texture.lastUsedFrame = frame;
+            offset += bytes;
+            statistics.uploadedBytes += bytes;
+            recorded = true;
+        }
+        if (!waiting.empty()) {
+            std::lock_guard<std::mutex> lock(completedMutex);
+            completed.insert(
+                    completed.begin(), std::make_move_iterator(waiting.begin()), std::make_move_iterator(waiting.end())
+            );
+        }
+        uploadBuffer.end();
+        if (!recorded) {
+            return;
+        }
+        vk::SubmitInfo info(
+                0, nullptr, nullptr,
+                1, &uploadBuffer,
+                0, nullptr
+        );
+        auto queueContext = context->getQueueContext();
+        auto lock = queueContext->lock(queueContext->getGraphicsQueue());
+        vkAssertOk(
+                queueContext->getGraphicsQueue().submit(1, &info, uploadFence)
+        )
+        uploadInFlight = true;
+    }
+
+    size_t TextureStreamer::getTextureCount() const {
+        return textures.size();
+    }
+
+    const TextureDescription &TextureStreamer::getDescription(TextureHandle handle) const {
+        return textures[handle].source->getDescription();
+    }
+
+    bool TextureStreamer::isResident(TextureHandle handle) const {
+        const auto &texture = textures[handle];
+        return texture.residentBase < texture.source->getDescription().getMipCount();
+    }
+
+    const vk::ImageView &TextureStreamer::getView(TextureHandle handle) const {
+        return textures[handle].view;
+    }
+
+    uint32_t TextureStreamer::getResidentBase(TextureHandle handle) const {
+        return textures[handle].residentBase;
+    }
+
+    const TextureStreamingSettings &TextureStreamer::getSettings() const {
+        return settings;
+    }
+
+    void TextureStreamer::setSettings(const TextureStreamingSettings &settings) {
+        TextureStreamer::settings = settings;
+    }
+
+    const TextureStreamingStatistics &TextureStreamer::getStatistics() const {
+        return statistics;
+    }
+}
@@ -0,0 +1,211 @@
+#include <overeditor/graphics/textures/texture_table.h>
+#include <overeditor/utility/vulkan_utility.h>
+
+#include <algorithm>
+
+namespace overeditor::graphics::textures {
+
+    TextureTable::TextureTable(const DeviceContext &context) : context(&context), views(), version(0) {
+        auto &device = context.getDevice();
+        sampler = device.createSampler(
+                vk::SamplerCreateInfo(
+                        (vk::SamplerCreateFlags) 0,
+                        vk::Filter::eLinear, vk::Filter::eLinear,
+                        vk::SamplerMipmapMode::eLinear,
+                        vk::SamplerAddressMode::eRepeat, vk::SamplerAddressMode::eRepeat,
+                        vk::SamplerAddressMode::eRepeat,
+                        0.0F,
+                        VK_FALSE, 1.0F,
+                        VK_FALSE, vk::CompareOp::eNever,
+                        // Views only ever cover the resident mips, so every level they have may be sampled
+                        0.0F, VK_LOD_CLAMP_NONE
+                )
+        );
+        createFallback();
+        uint32_t slots = TEXTURE_TABLE_CAPACITY + 1;
+        vk::DescriptorSetLayoutBinding binding(
+                0, vk::DescriptorType::eCombinedImageSampler, slots, vk::ShaderStageFlagBits::eFragment
+        );
+        setLayout = device.createDescriptorSetLayout(
+                vk::DescriptorSetLayoutCreateInfo((vk::DescriptorSetLayoutCreateFlags) 0, 1, &binding)
+        );
+        vk::DescriptorPoolSize poolSize(vk::DescriptorType::eCombinedImageSampler, slots);
+        descriptorPool = device.createDescriptorPool(
+                vk::DescriptorPoolCreateInfo((vk::DescriptorPoolCreateFlags) 0, 1, 1, &poolSize)
+        );
+        descriptorSet = device.allocateDescriptorSets(
+                vk::DescriptorSetAllocateInfo(descriptorPool, 1, &setLayout)
+        )[0];
+        // Every slot starts with the fallback
+        views.assign(slots, fallbackView);
+        std::vector<vk::DescriptorImageInfo> images(
+                slots, vk::DescriptorImageInfo(sampler, fallbackView, vk::ImageLayout::eShaderReadOnlyOptimal)
+        );
+        device.updateDescriptorSets(
+                vk::WriteDescriptorSet(
+                        descriptorSet, 0, 0, slots, vk::DescriptorType::eCombinedImageSampler, images.data()
+                ),
+                nullptr
+        );
+    }
+
+    void TextureTable::createFallback() {
+        auto &device = context->getDevice();
+        vk::Format format = vk::Format::eR8G8B8A8Unorm;
+        fallbackImage = device.createImage(
+                vk::ImageCreateInfo(
+                        (vk::ImageCreateFlags) 0,
+                        vk::ImageType::e2D,
+                        format,
+                        vk::Extent3D(1, 1, 1),
+                        1, 1,
+                        vk::SampleCountFlagBits::e1,
+                        vk::ImageTiling::eOptimal,
+                        vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
+                        vk::SharingMode::eExclusive,
+                        0, nullptr,
+                        vk::ImageLayout::eUndefined
+                )
+        );
+        auto requirements = device.getImageMemoryRequirements(fallbackImage);
+        fallbackMemory = context->allocateMemory(
+                vk::MemoryAllocateInfo(
+                        requirements.size,
+                        utility::findMemoryType(
+                                context->getCandidate().getMemoryProperties(),
+                                requirements.memoryTypeBits,
+                                vk::MemoryPropertyFlagBits::eDeviceLocal
+                        )
+                ),
+                utility::eMemoryTextures
+        );
+        device.bindImageMemory(fallbackImage, fallbackMemory, 0);
+        vk::ImageSubresourceRange range(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1);
+        fallbackView = device.createImageView(
+                vk::ImageViewCreateInfo(
+                        (vk::ImageViewCreateFlags) 0,
+                        fallbackImage,
+                        vk::ImageViewType::e2D,
+                        format,
+                        vk::ComponentMapping(),
+                        range
+                )
+        );
+        // Cleared to white once, on a throwaway command buffer
+        auto queueContext = context->getQueueContext();
+        auto &queue = queueContext->getGraphicsQueue();
+        vk::CommandPool pool = device.createCommandPool(
+                vk::CommandPoolCreateInfo(
+                        (vk::CommandPoolCreateFlags) vk::CommandPoolCreateFlagBits::eTransient,
+                        queueContext->getFamilyIndices().getGraphics().get()
+                )
+        );
+        vk::CommandBuffer buffer = device.allocateCommandBuffers(
+                vk::CommandBufferAllocateInfo(pool, vk::CommandBufferLevel::ePrimary, 1)
+        )[0];
+        buffer.begin(
+                vk::CommandBufferBeginInfo(
+                        (vk::CommandBufferUsageFlags) vk::CommandBufferUsageFlagBits::eOneTimeSubmit
+                )
+        );
+        buffer.pipelineBarrier(
+                vk::PipelineStageFlagBits::eTopOfPipe,
+                vk::PipelineStageFlagBits::eTransfer,
+                (vk::DependencyFlags) 0,
+                nullptr, nullptr,
+                vk::ImageMemoryBarrier(
+                        (vk::AccessFlags) 0, vk::AccessFlagBits::eTransferWrite,
+                        vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal,
+                        VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+                        fallbackImage, range
+                )
+        );
+        buffer.clearColorImage(
+                fallbackImage, vk::ImageLayout::eTransferDstOptimal,
+                vk::ClearColorValue((std::array<float, 4>) {1.0F, 1.0F, 1.0F, 1.0F}), range
+        );
+        buffer.pipelineBarrier(
+                vk::PipelineStageFlagBits::eTransfer,
+                vk::PipelineStageFlagBits::eFragmentShader,
+                (vk::DependencyFlags) 0,
+                nullptr, nullptr,
+                vk::ImageMemoryBarrier(
+                        vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead,
+                        vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal,
+                        VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+                        fallbackImage, range
+                )
+        );
+        buffer.end();
+        {
+            vk::SubmitInfo info(0, nullptr, nullptr, 1, &buffer, 0, nullptr);
+            auto lock = queueContext->lock(queue);
+            vkAssertOk(
+                    queue.submit(1, &info, nullptr)
+            )
+            queue.waitIdle();
+        }
+        // Frees the buffer along with it
+        device.destroy(pool);
+    }
+
+    void TextureTable::dispose() {
+        auto &device = context->getDevice();
+        // Frees the set along with it
+        device.destroy(descriptorPool);
+        device.destroy(setLayout);
+        device.destroy(fallbackView);
+        device.destroy(fallbackImage);
+        context->freeMemory(fallbackMemory);
+        device.destroy(sampler);
+    }
+
+    void TextureTable::update(const TextureStreamer *streamer) {
+        std::vector<vk::DescriptorImageInfo> images;
+        std::vector<uint32_t> slots;
+        size_t count = 0;
+        if (streamer != nullptr) {
+            count = std::min<size_t>(streamer->getTextureCount(), TEXTURE_TABLE_CAPACITY);
+        }
+        for (uint32_t slot = 0; slot < TEXTURE_TABLE_CAPACITY; ++slot) {
+            vk::ImageView view = fallbackView;
+            if (slot < count && streamer->isResident(slot)) {
+                view = streamer->getView(slot);
+            }
+            if (view != views[slot]) {
+                views[slot] = view;
+                images.emplace_back(sampler, view, vk::ImageLayout::eShaderReadOnlyOptimal);
+                slots.push_back(slot);
+            }
+        }
+        if (slots.empty()) {
+            return;
+        }
+        // Filled in once images stopped growing, so the pointers stay valid
+        std::vector<vk::WriteDescriptorSet> writes;
+        writes.reserve(slots.size());
+        for (size_t i = 0; i < slots.size(); ++i) {
+            writes.emplace_back(
+                    descriptorSet, 0, slots[i], 1, vk::DescriptorType::eCombinedImageSampler, &images[i]
+            );
+        }
+        context->getDevice().updateDescriptorSets(writes, nullptr);
+        version++;
+    }
+
+    uint32_t TextureTable::getSlot(TextureHandle handle) {
+        return handle < TEXTURE_TABLE_CAPACITY ? handle : TEXTURE_TABLE_CAPACITY;
+    }
+
+    const vk::DescriptorSetLayout &TextureTable::getSetLayout() const {
+        return setLayout;
+    }
+
+    const vk::DescriptorSet &TextureTable::getDescriptorSet() const {
+        return descriptorSet;
+    }
+
+    uint64_t TextureTable::getVersion() const {
+        return version;
+    }
+}
@@ -0,0 +1,199 @@
+#include <overeditor/graphics/vertex_kd_tree.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace overeditor::graphics {
+
+    struct VertexKdTree::Search {
+        // The query point in the space of the mesh, and in the space of the query
+        glm::vec3 point;
+        glm::vec3 queryPoint;
+        const glm::mat4 *world;
+        // How much world may shrink a distance at most, squared
+        float boundScale;
+        // 0 for radius searches
+        size_t k;
+        // Squared, shrinks to the kth distance once k vertices were found
+        float limit;
+        // A max heap on the squared distance while searching for the k nearest
+        std::vector<VertexHit> hits;
+    };
+
+    static bool isNearer(const VertexHit &a, const VertexHit &b) {
+        return a.distance < b.distance;
+    }
+
+    VertexKdTree::VertexKdTree(const MeshData &mesh)
+            : points(mesh.positions), vertices(mesh.positions.size()), axes(mesh.positions.size()) {
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            vertices[i] = (uint32_t) i;
+        }
+        build(0, vertices.size());
+        // vertices is now the order of the tree, lay the points out in it
+        std::vector<glm::vec3> sorted(points.size());
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            sorted[i] = points[vertices[i]];
+        }
+        points.swap(sorted);
+    }
+
+    void VertexKdTree::build(size_t begin, size_t end) {
+        if (end - begin <= VERTEX_KD_TREE_LEAF_SIZE) {
+            return;
+        }
+        glm::vec3 min = points[vertices[begin]], max = min;
+        for (size_t i = begin + 1; i < end; ++i) {
+            min = glm::min(min, points[vertices[i]]);
+            max = glm::max(max, points[vertices[i]]);
+        }
+        glm::vec3 extent = max - min;
+        uint8_t axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : extent.y >= extent.z ? 1 : 2;
+        size_t middle = begin + (end - begin) / 2;
+        std::nth_element(
+                vertices.begin() + (ptrdiff_t) begin,
+                vertices.begin() + (ptrdiff_t) middle,
+                vertices.begin() + (ptrdiff_t) end,
+                [this, axis](uint32_t a, uint32_t b) {
+                    return points[a][axis] < points[b][axis];
+                }
+        );
+        axes[middle] = axis;
+        build(begin, middle);
+        build(middle + 1, end);
+    }
+
+    static void consider(
+            const glm::vec3 &point,
+            uint32_t vertex,
+            const glm::mat4 *world,
+            const glm::vec3 &queryPoint,
+            size_t k,
+            float &limit,
+            std::vector<VertexHit> &hits
+    ) {
+        glm::vec3 position = world == nullptr ? point : glm::vec3(*world * glm::vec4(point, 1.0F));
+        glm::vec3 delta = position - queryPoint;
+        float distance = glm::dot(delta, delta);
+        if (distance > limit) {
+            return;
+        }
+        hits.push_back(VertexHit{vertex, distance, position});
+        if (k == 0) {
+            return;
+        }
+        std::push_heap(hits.begin(), hits.end(), isNearer);
+        if (hits.size() > k) {
+            std::pop_heap(hits.begin(), hits.end(), isNearer);
+            hits.pop_back();
+        }
+        if (hits.size() == k) {
+            limit = hits.front().distance;
+        }
+    }
+
+    void VertexKdTree::search(size_t begin, size_t end, Search &search) const {
+        if (end - begin <= VERTEX_KD_TREE_LEAF_SIZE) {
+            for (size_t i = begin; i < end; ++i) {
+                consider(points[i], vertices[i], search.world, search.queryPoint, search.k, search.limit, search.hits);
+            }
+            return;
+        }
+        size_t middle = begin + (end - begin) / 2;
+        uint8_t axis = axes[middle];
+        consider(
+                points[middle], vertices[middle], search.world, search.queryPoint, search.k, search.limit, search.hits
+        );
+        float difference = search.point[axis] - points[middle][axis];
+        bool lowerFirst = difference < 0;
+        this->search(lowerFirst ? begin : middle + 1, lowerFirst ? middle : end, search);
+        // The other side is at least the distance to the split plane away
+        if (difference * difference * search.boundScale <= search.limit) {
+            this->search(lowerFirst ? middle + 1 : begin, lowerFirst ? end : middle, search);
+        }
+    }
+
+    void VertexKdTree::query(Search &search, std::vector<VertexHit> &result) const {
+        if (!points.empty()) {
+            this->search(0, points.size(), search);
+        }
+        if (search.k > 0) {
+            std::sort_heap(search.hits.begin(), search.hits.end(), isNearer);
+        } else {
+            std::sort(search.hits.begin(), search.hits.end(), isNearer);
+        }
+        for (VertexHit &hit : search.hits) {
+            hit.distance = std::sqrt(hit.distance);
+        }
+        result.swap(search.hits);
+    }
+
+    void VertexKdTree::nearest(
+            const glm::vec3 &point,
+            size_t k,
+            float maxDistance,
+            std::vector<VertexHit> &result
+    ) const {
+        if (k == 0) {
+            result.clear();
+            return;
+        }
+        Search search{point, point, nullptr, 1.0F, k, maxDistance * maxDistance, {}};
+        query(search, result);
+    }
+
+    // A world distance is at least the distance in the mesh times the smallest singular value of the linear part
+    // of world, which the Frobenius norm of its inverse bounds from below. Returns that bound squared.
+    static float computeBoundScale(const glm::mat4 &world, const glm::vec3 &point, glm::vec3 &meshPoint) {
+        glm::mat4 inverse = glm::inverse(world);
+        meshPoint = glm::vec3(inverse * glm::vec4(point, 1.0F));
+        float norm = 0;
+        for (int column = 0; column < 3; ++column) {
+            glm::vec3 axis(inverse[column]);
+            norm += glm::dot(axis, axis);
+        }
+        return 1.0F / norm;
+    }
+
+    void VertexKdTree::nearest(
+            const glm::mat4 &world,
+            const glm::vec3 &point,
+            size_t k,
+            float maxDistance,
+            std::vector<VertexHit> &result
+    ) const {
+        if (k == 0) {
+            result.clear();
+            return;
+        }
+        glm::vec3 meshPoint;
+        float boundScale = computeBoundScale(world, point, meshPoint);
+        Search search{meshPoint, point, &world, boundScale, k, maxDistance * maxDistance, {}};
+        query(search, result);
+    }
+
+    void VertexKdTree::withinRadius(const glm::vec3 &point, float radius, std::vector<VertexHit> &result) const {
+        Search search{point, point, nullptr, 1.0F, 0, radius * radius, {}};
+        query(search, result);
+    }
+
+    void VertexKdTree::withinRadius(
+            const glm::mat4 &world,
+            const glm::vec3 &point,
+            float radius,
+            std::vector<VertexHit> &result
+    ) const {
+        glm::vec3 meshPoint;
+        float boundScale = computeBoundScale(world, point, meshPoint);
+        Search search{meshPoint, point, &world, boundScale, 0, radius * radius, {}};
+        query(search, result);
+    }
+
+    size_t VertexKdTree::size() const {
+        return points.size();
+    }
+
+    size_t VertexKdTree::getMemorySize() const {
+        return points.capacity() * sizeof(glm::vec3) + vertices.capacity() * sizeof(uint32_t) + axes.capacity();
+    }
+}
@@ -7,25 +7,43 @@
 int main() {
     auto app = overeditor::Application();
     auto cube = app.entities.create();
+    // Drawn without a viewport, so the pass has no camera and the transform places it straight in clip space
     cube.assign<Transform>(
-            glm::vec3(10, 0, 20) //Position
+            glm::vec3(0, 0, 0.5F), //Position
+            glm::quat(1, 0, 0, 0), //Rotation
+            glm::vec3(1) //Scale
     );
-    overeditor::graphics::GeometryBuffer b((overeditor::graphics::GeometryLayout()));
+    overeditor::graphics::GeometryLayout layout;
+    layout.push<float>(3);
+    overeditor::graphics::GeometryBuffer b(layout);
     auto ctx = app.getDeviceContext();
-    overeditor::graphics::shaders::Shader shader;
-    std::filesystem::path resDirectory = std::filesystem::current_path() / "res";
-    LOG_INFO << "Using resources located at \"" << resDirectory.string() << "\"";
+    glm::vec3 vertices[] = {glm::vec3(0, -0.5F, 0), glm::vec3(0.5F, 0.5F, 0), glm::vec3(-0.5F, 0.5F, 0)};
+    b.upload(*ctx, *app.getResourceRegistry(), vertices, sizeof(vertices));
+    overeditor::graphics::shaders::Shader shader, depthShader;
     auto &system = app.getRenderingSystem();
     auto &renderPass = system.get()->renderPass;
-    shader.initialize(*ctx, renderPass, resDirectory / "frag.spv", resDirectory / "vert.spv");
-    vk::CommandPool secondaryPool = ctx->getDevice().createCommandPool(
-            vk::CommandPoolCreateInfo(
-                    vk::CommandPoolCreateFlagBits::eProtected,
-                    ctx->getQueueContext()->getFamilyIndices().getGraphics().get()
-            )
+    auto &shaders = app.getShaderLibrary();
+    bool prepass = system->getDepthMode() == overeditor::systems::graphics::eDepthPrepass;
+    auto &cache = app.getPipelineCache().getCache();
+    auto &fragment = shaders.get("frag.spv");
+    auto &vertex = shaders.get("vert.spv");
+    if (prepass) {
+        depthShader.initialize(
+                *ctx, renderPass, fragment, vertex, cache, overeditor::graphics::shaders::eDepthPrepass, 0,
+                system->getPipelineLayout(), &layout
+        );
+    }
+    shader.initialize(
+            *ctx, renderPass, fragment, vertex, cache,
+            prepass ? overeditor::graphics::shaders::eDepthAfterPrepass
+                    : overeditor::graphics::shaders::eDepthTestWrite,
+            system->getColorSubpass(), system->getPipelineLayout(), &layout
     );
+    auto &registry = *app.getResourceRegistry();
+    auto &pipeline = shader.registerPipeline(registry);
     cube.assign_from_copy(
-            Drawable::forGeometry(*ctx, shader.getPipeline(), secondaryPool, renderPass, 0, b)
+            prepass ? Drawable::forGeometryWithPrepass(depthShader.registerPipeline(registry), pipeline, b)
+                    : Drawable::forGeometry(pipeline, b)
     );
     app.run();
 }
\ No newline at end of file
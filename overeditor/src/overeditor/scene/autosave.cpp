@@ -0,0 +1,70 @@
+#include <overeditor/scene/autosave.h>
+#include <plog/Log.h>
+
+#include <chrono>
+
+namespace overeditor::scene {
+
+    Autosave::Autosave(
+            const SceneFormat &format,
+            const std::filesystem::path &path,
+            float interval
+    ) : format(&format), path(path), interval(interval), elapsed(0), previous(), cache(), saving(false),
+        statisticsMutex(), statistics(), worker() {}
+
+    void Autosave::update(entityx::EntityManager &entities, float dt) {
+        elapsed += dt;
+        if (elapsed < interval) {
+            return;
+        }
+        if (saveNow(entities)) {
+            elapsed = 0;
+        }
+    }
+
+    bool Autosave::saveNow(entityx::EntityManager &entities) {
+        if (saving.exchange(true)) {
+            return false;
+        }
+        auto start = std::chrono::high_resolution_clock::now();
+        size_t copiedBytes;
+        SceneData snapshot = format->gather(entities, &previous, &copiedBytes);
+        double snapshotMilliseconds = std::chrono::duration<double, std::milli>(
+                std::chrono::high_resolution_clock::now() - start
+        ).count();
+        // Chunks are immutable and reference counted, the worker and the next snapshot can share them
+        previous = snapshot;
+        {
+            std::lock_guard<std::mutex> lock(statisticsMutex);
+            statistics.snapshotMilliseconds = snapshotMilliseconds;
+            statistics.snapshotCopiedBytes = copiedBytes;
+        }
+        LOG_DEBUG << "Autosave snapshot took " << snapshotMilliseconds << " ms and copied " << copiedBytes
+                  << " bytes";
+        worker.enqueue([this, snapshot] {
+            try {
+                auto written = format->write(path, snapshot, &cache);
+                std::lock_guard<std::mutex> lock(statisticsMutex);
+                statistics.writeMilliseconds = written.milliseconds;
+                statistics.completedSaves++;
+            } catch (std::exception &e) {
+                LOG_ERROR << "Autosave to \"" << path.string() << "\" failed: " << e.what();
+            }
+            saving = false;
+        });
+        return true;
+    }
+
+    bool Autosave::isSaving() const {
+        return saving;
+    }
+
+    const std::filesystem::path &Autosave::getPath() const {
+        return path;
+    }
+
+    AutosaveStatistics Autosave::getStatistics() {
+        std::lock_guard<std::mutex> lock(statisticsMutex);
+        return statistics;
+    }
+}
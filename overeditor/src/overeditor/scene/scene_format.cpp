@@ -0,0 +1,452 @@
+#include <overeditor/scene/scene_format.h>
+#include <overeditor/ecs/components/common.h>
+#include <overeditor/ecs/components/hierarchy.h>
+#include <overeditor/ecs/storage/chunk_storage.h>
+#include <overeditor/utility/compression.h>
+#include <overeditor/utility/mapped_file.h>
+#include <plog/Log.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <unordered_map>
+
+namespace overeditor::scene {
+
+    typedef std::chrono::high_resolution_clock Clock;
+
+    static double millisecondsSince(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    static bool sameChunk(const ColumnChunk &a, const ColumnChunk &b) {
+        return a.rows.size() == b.rows.size() &&
+               std::memcmp(a.rows.data(), b.rows.data(), a.rows.size() * sizeof(uint32_t)) == 0 &&
+               a.data.size() == b.data.size() &&
+               std::memcmp(a.data.data(), b.data.data(), a.data.size()) == 0;
+    }
+
+    void ColumnSerializer::snapshot(
+            entityx::EntityManager &entities,
+            const ColumnData *previous,
+            ColumnData &column,
+            size_t &copiedBytes
+    ) const {
+        uint32_t elementSize = getElementSize();
+        size_t rowsPerChunk = std::max<size_t>(1, SCENE_CHUNK_SIZE / (elementSize + sizeof(uint32_t)));
+        // Rows are gathered into a scratch chunk, which is only kept if it differs from the previous one
+        ColumnChunk scratch;
+        scratch.rows.reserve(rowsPerChunk);
+        scratch.data.reserve(rowsPerChunk * elementSize);
+        auto flush = [&] {
+            size_t position = column.chunks.size();
+            if (previous != nullptr && position < previous->chunks.size() &&
+                sameChunk(*previous->chunks[position], scratch)) {
+                column.chunks.push_back(previous->chunks[position]);
+            } else {
+                copiedBytes += scratch.rows.size() * sizeof(uint32_t) + scratch.data.size();
+                column.chunks.push_back(std::make_shared<const ColumnChunk>(scratch));
+            }
+            scratch.rows.clear();
+            scratch.data.clear();
+        };
+        gather(entities, [&](entityx::Entity entity, const uint8_t *element) {
+            scratch.rows.push_back(entity.id().index());
+            scratch.data.insert(scratch.data.end(), element, element + elementSize);
+            if (scratch.rows.size() == rowsPerChunk) {
+                flush();
+            }
+        });
+        if (!scratch.rows.empty()) {
+            flush();
+        }
+    }
+
+    /**
+     * Copies transforms out of the storage chunks rather than the components, one column chunk per storage chunk,
+     * so a storage chunk whose version didn't change since the previous snapshot is shared without being read.
+     * The chunks are updated at the start of the frame, so the snapshot sees the transforms as they were rendered.
+     */
+    class StoredTransformColumnSerializer : public PodColumnSerializer<Transform> {
+    private:
+        const storage::ChunkStorage *storage;
+    public:
+        StoredTransformColumnSerializer(uint32_t id, const storage::ChunkStorage &storage)
+                : PodColumnSerializer<Transform>(id), storage(&storage) {}
+
+        void snapshot(
+                entityx::EntityManager &entities,
+                const ColumnData *previous,
+                ColumnData &column,
+                size_t &copiedBytes
+        ) const override {
+            std::unordered_map<const storage::StorageChunk *, const std::shared_ptr<const ColumnChunk> *> copies;
+            if (previous != nullptr) {
+                for (auto &chunk : previous->chunks) {
+                    if (chunk->source != nullptr) {
+                        copies.emplace(chunk->source, &chunk);
+                    }
+                }
+            }
+            storage->forEachChunk(storage::eStorageTransform, [&](const storage::StorageChunk &source) {
+                auto found = copies.find(&source);
+                if (found != copies.end() && (*found->second)->sourceVersion == source.getVersion()) {
+                    column.chunks.push_back(*found->second);
+                    return;
+                }
+                auto chunk = std::make_shared<ColumnChunk>();
+                chunk->source = &source;
+                chunk->sourceVersion = source.getVersion();
+                uint32_t count = source.getCount();
+                chunk->rows.resize(count);
+                chunk->data.resize((size_t) count * sizeof(Transform));
+                for (uint32_t row = 0; row < count; ++row) {
+                    chunk->rows[row] = source.getEntities()[row].index();
+                    Transform transform(
+                            source.getPositions()[row], source.getRotations()[row], source.getScales()[row]
+                    );
+                    std::memcpy(chunk->data.data() + (size_t) row * sizeof(Transform), &transform, sizeof(Transform));
+                }
+                copiedBytes += chunk->rows.size() * sizeof(uint32_t) + chunk->data.size();
+                column.chunks.push_back(std::move(chunk));
+            });
+        }
+    };
+
+    /**
+     * Stores the scene id of the parent, or UINT32_MAX for an invalid parent
+     */
+    class ParentColumnSerializer : public ColumnSerializer {
+    public:
+        uint32_t getId() const override {
+            return SCENE_FOURCC('P', 'R', 'N', 'T');
+        }
+
+        uint32_t getElementSize() const override {
+            return sizeof(uint32_t);
+        }
+
+        void gather(entityx::EntityManager &entities, const Visitor &visitor) const override {
+            entityx::ComponentHandle<Parent> component;
+            for (entityx::Entity e : entities.entities_with_components(component)) {
+                uint32_t id = component->entity.valid() ? component->entity.id().index() : UINT32_MAX;
+                visitor(e, reinterpret_cast<const uint8_t *>(&id));
+            }
+        }
+
+        void scatter(entityx::Entity entity, const uint8_t *element, const Resolver &resolve) const override {
+            uint32_t id;
+            std::memcpy(&id, element, sizeof(uint32_t));
+            entity.assign<Parent>(id == UINT32_MAX ? entityx::Entity() : resolve(id));
+        }
+    };
+
+    SceneFormat::SceneFormat(utility::ThreadPool *pool) : serializers(), pool(pool) {}
+
+    SceneFormat SceneFormat::createOverEditorFormat(
+            utility::ThreadPool *pool,
+            const storage::ChunkStorage *storage
+    ) {
+        SceneFormat format(pool);
+        uint32_t transformId = SCENE_FOURCC('T', 'R', 'F', 'M');
+        if (storage != nullptr) {
+            format.add(std::make_shared<StoredTransformColumnSerializer>(transformId, *storage));
+        } else {
+            format.add(std::make_shared<PodColumnSerializer<Transform>>(transformId));
+        }
+        format.add(std::make_shared<ParentColumnSerializer>());
+        return format;
+    }
+
+    void SceneFormat::forEachChunk(size_t count, const std::function<void(size_t)> &task) const {
+        if (pool == nullptr) {
+            for (size_t i = 0; i < count; ++i) {
+                task(i);
+            }
+            return;
+        }
+        // Exceptions thrown by the tasks are rethrown here by the pool
+        pool->parallelFor(count, 1, [&task](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                task(i);
+            }
+        });
+    }
+
+    void SceneFormat::add(const std::shared_ptr<ColumnSerializer> &serializer) {
+        if (findSerializer(serializer->getId()) != nullptr) {
+            throw std::runtime_error("A column serializer with the same id is already registered");
+        }
+        serializers.push_back(serializer);
+    }
+
+    const ColumnSerializer *SceneFormat::findSerializer(uint32_t id) const {
+        for (auto &serializer : serializers) {
+            if (serializer->getId() == id) {
+                return serializer.get();
+            }
+        }
+        return nullptr;
+    }
+
+    SceneData SceneFormat::gather(
+            entityx::EntityManager &entities,
+            const SceneData *previous,
+            size_t *copiedBytes
+    ) const {
+        SceneData data;
+        size_t copied = 0;
+        for (auto &serializer : serializers) {
+            ColumnData column{serializer->getId(), serializer->getElementSize(), {}};
+            const ColumnData *previousColumn = nullptr;
+            if (previous != nullptr) {
+                for (auto &candidate : previous->columns) {
+                    if (candidate.id == column.id && candidate.elementSize == column.elementSize) {
+                        previousColumn = &candidate;
+                    }
+                }
+            }
+            serializer->snapshot(entities, previousColumn, column, copied);
+            data.columns.push_back(std::move(column));
+        }
+        if (copiedBytes != nullptr) {
+            *copiedBytes = copied;
+        }
+        return data;
+    }
+
+    SceneStatistics SceneFormat::write(
+            const std::filesystem::path &path,
+            const SceneData &data,
+            SceneChunkCache *cache
+    ) const {
+        auto start = Clock::now();
+        struct PendingChunk {
+            const ColumnData *column;
+            std::shared_ptr<const ColumnChunk> chunk;
+            bool encoded;
+            std::vector<uint8_t> stored;
+            SceneChunkEntry entry;
+        };
+        // Taken out of the cache up front, so a failed write leaves it empty rather than half moved
+        std::unordered_map<const ColumnChunk *, SceneChunkCache::Entry> cached;
+        if (cache != nullptr) {
+            cached.swap(cache->entries);
+        }
+        std::vector<PendingChunk> pending;
+        uint32_t maxRow = 0;
+        for (auto &column : data.columns) {
+            for (auto &chunk : column.chunks) {
+                PendingChunk p{&column, chunk, false, {}, {}};
+                auto found = cached.find(chunk.get());
+                if (found != cached.end() && found->second.entry.columnId == column.id) {
+                    p.encoded = true;
+                    p.stored = std::move(found->second.stored);
+                    p.entry = found->second.entry;
+                }
+                for (uint32_t row : chunk->rows) {
+                    maxRow = std::max(maxRow, row);
+                }
+                pending.push_back(std::move(p));
+            }
+        }
+        cached.clear();
+        // Chunks are independent, compress them in parallel
+        forEachChunk(pending.size(), [&](size_t i) {
+            auto &p = pending[i];
+            if (p.encoded) {
+                return;
+            }
+            auto rowBytes = p.chunk->rows.size() * sizeof(uint32_t);
+            std::vector<uint8_t> raw(rowBytes + p.chunk->data.size());
+            std::memcpy(raw.data(), p.chunk->rows.data(), rowBytes);
+            std::memcpy(raw.data() + rowBytes, p.chunk->data.data(), p.chunk->data.size());
+            auto compressed = utility::compression::compress(raw.data(), raw.size());
+            p.entry = SceneChunkEntry();
+            p.entry.columnId = p.column->id;
+            p.entry.elementSize = p.column->elementSize;
+            p.entry.rowCount = (uint32_t) p.chunk->rows.size();
+            p.entry.rawSize = raw.size();
+            if (compressed.size() < raw.size()) {
+                p.entry.compression = eSceneChunkLZ;
+                p.stored = std::move(compressed);
+            } else {
+                p.entry.compression = eSceneChunkRaw;
+                p.stored = std::move(raw);
+            }
+            p.entry.storedSize = p.stored.size();
+            p.entry.checksum = utility::compression::crc32(p.stored.data(), p.stored.size());
+        });
+
+        SceneStatistics statistics;
+        // Entities are stored under their index, count the distinct ones
+        std::vector<bool> seen(pending.empty() ? 0 : (size_t) maxRow + 1, false);
+        for (auto &p : pending) {
+            for (uint32_t row : p.chunk->rows) {
+                if (!seen[row]) {
+                    seen[row] = true;
+                    statistics.entityCount++;
+                }
+            }
+        }
+        statistics.chunkCount = pending.size();
+        // Write next to the destination first so a failed save never leaves a truncated scene behind
+        std::filesystem::path temporary = path;
+        temporary += ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                throw std::runtime_error(std::string("Unable to open file: ") + temporary.string());
+            }
+            SceneFileHeader header{};
+            file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            uint64_t offset = sizeof(header);
+            std::vector<SceneChunkEntry> toc;
+            toc.reserve(pending.size());
+            for (auto &p : pending) {
+                p.entry.offset = offset;
+                file.write(reinterpret_cast<const char *>(p.stored.data()), p.stored.size());
+                offset += p.stored.size();
+                statistics.rawBytes += p.entry.rawSize;
+                statistics.storedBytes += p.entry.storedSize;
+                toc.push_back(p.entry);
+            }
+            auto tocBytes = reinterpret_cast<const uint8_t *>(toc.data());
+            file.write(reinterpret_cast<const char *>(tocBytes), toc.size() * sizeof(SceneChunkEntry));
+            header.magic = SCENE_MAGIC;
+            header.version = SCENE_VERSION;
+            header.entityCount = statistics.entityCount;
+            header.tocOffset = offset;
+            header.chunkCount = (uint32_t) toc.size();
+            header.tocChecksum = utility::compression::crc32(tocBytes, toc.size() * sizeof(SceneChunkEntry));
+            file.seekp(0);
+            file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            if (!file.good()) {
+                throw std::runtime_error(std::string("Unable to write file: ") + temporary.string());
+            }
+        }
+        std::filesystem::rename(temporary, path);
+        if (cache != nullptr) {
+            for (auto &p : pending) {
+                const ColumnChunk *key = p.chunk.get();
+                cache->entries[key] = SceneChunkCache::Entry{std::move(p.chunk), std::move(p.stored), p.entry};
+            }
+        }
+        statistics.milliseconds = millisecondsSince(start);
+        return statistics;
+    }
+
+    SceneStatistics SceneFormat::save(const std::filesystem::path &path, entityx::EntityManager &entities) const {
+        auto start = Clock::now();
+        auto statistics = write(path, gather(entities));
+        statistics.milliseconds = millisecondsSince(start);
+        LOG_INFO << "Saved " << statistics.entityCount << " entities to \"" << path.string() << "\" in "
+                 << statistics.milliseconds << " ms";
+        return statistics;
+    }
+
+    SceneStatistics SceneFormat::load(
+            const std::filesystem::path &path,
+            entityx::EntityManager &entities,
+            std::vector<entityx::Entity> *created
+    ) const {
+        auto start = Clock::now();
+        utility::MappedFile file(path);
+        const uint8_t *base = file.getData();
+        size_t size = file.getSize();
+        if (size < sizeof(SceneFileHeader)) {
+            throw std::runtime_error(std::string("Not a scene file: ") + path.string());
+        }
+        SceneFileHeader header;
+        std::memcpy(&header, base, sizeof(header));
+        if (header.magic != SCENE_MAGIC) {
+            throw std::runtime_error(std::string("Not a scene file: ") + path.string());
+        }
+        if (header.version > SCENE_VERSION) {
+            throw std::runtime_error(
+                    std::string("Scene file version ") + std::to_string(header.version) + " is newer than supported");
+        }
+        uint64_t tocSize = (uint64_t) header.chunkCount * sizeof(SceneChunkEntry);
+        if (header.tocOffset > size || tocSize > size - header.tocOffset) {
+            throw std::runtime_error("Scene table of contents is out of bounds");
+        }
+        if (utility::compression::crc32(base + header.tocOffset, tocSize) != header.tocChecksum) {
+            throw std::runtime_error("Scene table of contents is corrupted");
+        }
+        std::vector<SceneChunkEntry> toc(header.chunkCount);
+        std::memcpy(toc.data(), base + header.tocOffset, tocSize);
+        // The header isn't covered by a checksum, only trust its entity count as far as the rows back it
+        uint64_t rowCount = 0;
+        for (const SceneChunkEntry &entry : toc) {
+            rowCount += entry.rowCount;
+        }
+        if (header.entityCount > rowCount) {
+            throw std::runtime_error("Scene entity count doesn't match its chunks");
+        }
+
+        // Verify and decode every chunk in parallel
+        std::vector<std::vector<uint8_t>> decoded(toc.size());
+        forEachChunk(toc.size(), [&](size_t i) {
+            const SceneChunkEntry &entry = toc[i];
+            if (entry.offset > header.tocOffset || entry.storedSize > header.tocOffset - entry.offset) {
+                throw std::runtime_error("Scene chunk is out of bounds");
+            }
+            if (entry.rawSize != (uint64_t) entry.rowCount * (sizeof(uint32_t) + entry.elementSize)) {
+                throw std::runtime_error("Scene chunk has an invalid size");
+            }
+            const uint8_t *stored = base + entry.offset;
+            if (utility::compression::crc32(stored, entry.storedSize) != entry.checksum) {
+                throw std::runtime_error("Scene chunk checksum mismatch");
+            }
+            auto &raw = decoded[i];
+            raw.resize(entry.rawSize);
+            if (entry.compression == eSceneChunkLZ) {
+                utility::compression::decompress(stored, entry.storedSize, raw.data(), raw.size());
+            } else if (entry.compression == eSceneChunkRaw && entry.storedSize == entry.rawSize) {
+                std::memcpy(raw.data(), stored, raw.size());
+            } else {
+                throw std::runtime_error("Scene chunk has an unknown compression");
+            }
+        });
+
+        std::vector<entityx::Entity> sceneEntities;
+        sceneEntities.reserve(header.entityCount);
+        std::unordered_map<uint32_t, size_t> byId;
+        byId.reserve(header.entityCount);
+        ColumnSerializer::Resolver resolve = [&](uint32_t id) {
+            auto found = byId.emplace(id, sceneEntities.size());
+            if (found.second) {
+                sceneEntities.push_back(entities.create());
+            }
+            return sceneEntities[found.first->second];
+        };
+        SceneStatistics statistics;
+        statistics.chunkCount = toc.size();
+        for (size_t i = 0; i < toc.size(); ++i) {
+            const SceneChunkEntry &entry = toc[i];
+            statistics.rawBytes += entry.rawSize;
+            statistics.storedBytes += entry.storedSize;
+            const ColumnSerializer *serializer = findSerializer(entry.columnId);
+            if (serializer == nullptr || serializer->getElementSize() != entry.elementSize) {
+                LOG_WARNING << "Skipping scene chunk #" << i << " with unknown column " << entry.columnId;
+                continue;
+            }
+            const uint8_t *raw = decoded[i].data();
+            const uint8_t *elements = raw + entry.rowCount * sizeof(uint32_t);
+            for (uint32_t row = 0; row < entry.rowCount; ++row) {
+                uint32_t id;
+                std::memcpy(&id, raw + row * sizeof(uint32_t), sizeof(uint32_t));
+                serializer->scatter(resolve(id), elements + (size_t) row * entry.elementSize, resolve);
+            }
+            std::vector<uint8_t>().swap(decoded[i]);
+        }
+        statistics.entityCount = sceneEntities.size();
+        if (created != nullptr) {
+            *created = std::move(sceneEntities);
+        }
+        statistics.milliseconds = millisecondsSince(start);
+        LOG_INFO << "Loaded " << statistics.entityCount << " entities from \"" << path.string() << "\" in "
+                 << statistics.milliseconds << " ms";
+        return statistics;
+    }
+}
@@ -0,0 +1,225 @@
+#include <overeditor/utility/async_log_appender.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+namespace overeditor::utility {
+
+    static_assert((ASYNC_LOG_CAPACITY & (ASYNC_LOG_CAPACITY - 1)) == 0, "ASYNC_LOG_CAPACITY must be a power of two");
+
+#ifdef _WIN32
+    static std::wostream &output = std::wcout;
+#else
+    static std::ostream &output = std::cout;
+#endif
+
+    static const char *getColor(plog::Severity severity) {
+#ifdef _WIN32
+        return "";
+#else
+        switch (severity) {
+            case plog::fatal:
+                return "\x1B[97m\x1B[41m";
+            case plog::error:
+                return "\x1B[91m";
+            case plog::warning:
+                return "\x1B[93m";
+            case plog::debug:
+            case plog::verbose:
+                return "\x1B[96m";
+            default:
+                return "";
+        }
+#endif
+    }
+
+    static const char *getResetColor(plog::Severity severity) {
+#ifdef _WIN32
+        return "";
+#else
+        return severity == plog::fatal || severity == plog::error || severity == plog::warning
+               || severity == plog::debug || severity == plog::verbose ? "\x1B[0m" : "";
+#endif
+    }
+
+    static const char *getFileName(const char *file) {
+        const char *name = file;
+        for (const char *c = file; *c != '\0'; ++c) {
+            if (*c == '/' || *c == '\\') {
+                name = c + 1;
+            }
+        }
+        return name;
+    }
+
+    AsyncLogAppender::AsyncLogAppender()
+            : head(0), tail(0), consumed(0), dropped(0), suppressed(0), stopping(false), sleepMutex(), wake(),
+              thread() {
+        for (size_t i = 0; i < ASYNC_LOG_CAPACITY; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        for (auto &site : sites) {
+            site.second.store(0, std::memory_order_relaxed);
+            site.count.store(0, std::memory_order_relaxed);
+        }
+        thread = std::thread(&AsyncLogAppender::loop, this);
+    }
+
+    AsyncLogAppender::~AsyncLogAppender() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        thread.join();
+    }
+
+    bool AsyncLogAppender::admit(const plog::Record &record) {
+        if (record.getSeverity() == plog::fatal) {
+            return true;
+        }
+        // Call sites are told apart by the address of their file name literal and their line
+        size_t hash = reinterpret_cast<uintptr_t>(record.getFile()) * 31 + record.getLine();
+        Site &site = sites[(hash ^ (hash >> 16)) % ASYNC_LOG_SITE_COUNT];
+        auto second = (uint32_t) std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::steady_clock::now().time_since_epoch()
+        ).count();
+        // Racing threads may both reset the window, which only lets a few extra records through
+        if (site.second.load(std::memory_order_relaxed) != second) {
+            site.second.store(second, std::memory_order_relaxed);
+            site.count.store(0, std::memory_order_relaxed);
+        }
+        return site.count.fetch_add(1, std::memory_order_relaxed) < ASYNC_LOG_SITE_RATE;
+    }
+
+    void AsyncLogAppender::write(const plog::Record &record) {
+        if (!admit(record)) {
+            suppressed.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        size_t position = head.load(std::memory_order_relaxed);
+        Slot *slot;
+        while (true) {
+            slot = &slots[position & (ASYNC_LOG_CAPACITY - 1)];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            auto difference = (intptr_t) sequence - (intptr_t) position;
+            if (difference == 0) {
+                if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                // The background thread hasn't caught up yet, don't block the caller
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            } else {
+                position = head.load(std::memory_order_relaxed);
+            }
+        }
+        slot->time = record.getTime().time;
+        slot->milliseconds = record.getTime().millitm;
+        slot->severity = record.getSeverity();
+        slot->tid = record.getTid();
+        slot->line = record.getLine();
+        slot->file = record.getFile();
+        const plog::util::nchar *message = record.getMessage();
+        size_t length = 0;
+        while (length < ASYNC_LOG_MESSAGE_LENGTH - 1 && message[length] != 0) {
+            slot->message[length] = message[length];
+            ++length;
+        }
+        slot->message[length] = 0;
+        slot->sequence.store(position + 1, std::memory_order_release);
+        if (slot->severity == plog::fatal) {
+            flush();
+        }
+    }
+
+    void AsyncLogAppender::flush() {
+        size_t target = head.load(std::memory_order_acquire);
+        wake.notify_one();
+        while (consumed.load(std::memory_order_acquire) < target) {
+            std::this_thread::yield();
+        }
+    }
+
+    uint64_t AsyncLogAppender::getDroppedCount() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+    uint64_t AsyncLogAppender::getSuppressedCount() const {
+        return suppressed.load(std::memory_order_relaxed);
+    }
+
+    void AsyncLogAppender::print(const Slot &slot) {
+        tm local{};
+#ifdef _WIN32
+        localtime_s(&local, &slot.time);
+#else
+        localtime_r(&slot.time, &local);
+#endif
+        output << getColor(slot.severity)
+               << std::put_time(&local, "%Y-%m-%d %H:%M:%S") << '.'
+               << std::setfill(output.widen('0')) << std::setw(3) << slot.milliseconds
+               << std::setfill(output.widen(' '))
+               << ' ' << std::setw(5) << std::left << plog::severityToString(slot.severity) << std::right
+               << " [" << slot.tid << "] [" << getFileName(slot.file) << '@' << slot.line << "] "
+               << slot.message << getResetColor(slot.severity) << '\n';
+    }
+
+    size_t AsyncLogAppender::drain() {
+        size_t count = 0;
+        while (true) {
+            Slot &slot = slots[tail & (ASYNC_LOG_CAPACITY - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != tail + 1) {
+                break;
+            }
+            print(slot);
+            slot.sequence.store(tail + ASYNC_LOG_CAPACITY, std::memory_order_release);
+            ++tail;
+            ++count;
+        }
+        if (count > 0) {
+            output.flush();
+            consumed.store(tail, std::memory_order_release);
+        }
+        return count;
+    }
+
+    void AsyncLogAppender::loop() {
+        uint64_t reportedDropped = 0, reportedSuppressed = 0;
+        auto lastReport = std::chrono::steady_clock::now();
+        auto report = [&](bool force) {
+            uint64_t currentDropped = getDroppedCount(), currentSuppressed = getSuppressedCount();
+            if (currentDropped == reportedDropped && currentSuppressed == reportedSuppressed) {
+                return;
+            }
+            auto now = std::chrono::steady_clock::now();
+            // At most once a second, or the report would be as noisy as what was suppressed
+            if (!force && now - lastReport < std::chrono::seconds(1)) {
+                return;
+            }
+            lastReport = now;
+            output << getColor(plog::warning) << "Logging lost " << currentDropped - reportedDropped
+                   << " records to a full queue and suppressed " << currentSuppressed - reportedSuppressed
+                   << " over the per call site rate" << getResetColor(plog::warning) << std::endl;
+            reportedDropped = currentDropped;
+            reportedSuppressed = currentSuppressed;
+        };
+        while (true) {
+            size_t count = drain();
+            report(false);
+            if (count > 0) {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            if (stopping) {
+                break;
+            }
+            // Producers don't notify to stay off the mutex, so poll at a short interval instead
+            wake.wait_for(lock, std::chrono::milliseconds(5));
+        }
+        drain();
+        report(true);
+    }
+}
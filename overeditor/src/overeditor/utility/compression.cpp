@@ -0,0 +1,159 @@
+#include <overeditor/utility/compression.h>
+
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+#define MIN_MATCH 4
+#define MAX_OFFSET 65535
+#define HASH_BITS 14
+// The last bytes of a block are always emitted as literals
+#define TAIL_LITERALS 5
+
+namespace overeditor::utility::compression {
+
+    static uint32_t read32(const uint8_t *ptr) {
+        uint32_t value;
+        std::memcpy(&value, ptr, sizeof(value));
+        return value;
+    }
+
+    static uint32_t hash(uint32_t sequence) {
+        return (sequence * 2654435761U) >> (32 - HASH_BITS);
+    }
+
+    static void writeLength(std::vector<uint8_t> &out, size_t length) {
+        while (length >= 255) {
+            out.push_back(255);
+            length -= 255;
+        }
+        out.push_back((uint8_t) length);
+    }
+
+    static void emitSequence(
+            std::vector<uint8_t> &out,
+            const uint8_t *literals, size_t literalCount,
+            size_t offset, size_t matchLength
+    ) {
+        size_t matchCode = matchLength == 0 ? 0 : matchLength - MIN_MATCH;
+        auto token = (uint8_t) ((std::min<size_t>(literalCount, 15) << 4) | std::min<size_t>(matchCode, 15));
+        out.push_back(token);
+        if (literalCount >= 15) {
+            writeLength(out, literalCount - 15);
+        }
+        out.insert(out.end(), literals, literals + literalCount);
+        if (matchLength == 0) {
+            return;
+        }
+        out.push_back((uint8_t) (offset & 0xFF));
+        out.push_back((uint8_t) (offset >> 8));
+        if (matchCode >= 15) {
+            writeLength(out, matchCode - 15);
+        }
+    }
+
+    std::vector<uint8_t> compress(const uint8_t *data, size_t size) {
+        std::vector<uint8_t> out;
+        out.reserve(size / 2 + 16);
+        std::vector<int64_t> table(1U << HASH_BITS, -1);
+        size_t anchor = 0;
+        size_t i = 0;
+        while (size > TAIL_LITERALS && i + MIN_MATCH <= size - TAIL_LITERALS) {
+            uint32_t sequence = read32(data + i);
+            uint32_t h = hash(sequence);
+            int64_t candidate = table[h];
+            table[h] = (int64_t) i;
+            if (candidate < 0 || i - candidate > MAX_OFFSET || read32(data + candidate) != sequence) {
+                i++;
+                continue;
+            }
+            size_t length = MIN_MATCH;
+            while (i + length < size - TAIL_LITERALS && data[candidate + length] == data[i + length]) {
+                length++;
+            }
+            emitSequence(out, data + anchor, i - anchor, i - candidate, length);
+            i += length;
+            anchor = i;
+        }
+        emitSequence(out, data + anchor, size - anchor, 0, 0);
+        return out;
+    }
+
+    static size_t readLength(const uint8_t *&ip, const uint8_t *end) {
+        size_t length = 0;
+        uint8_t value;
+        do {
+            if (ip >= end) {
+                throw std::runtime_error("Compressed block is truncated");
+            }
+            value = *ip++;
+            length += value;
+        } while (value == 255);
+        return length;
+    }
+
+    void decompress(const uint8_t *data, size_t size, uint8_t *output, size_t outputSize) {
+        const uint8_t *ip = data;
+        const uint8_t *end = data + size;
+        size_t op = 0;
+        while (ip < end) {
+            uint8_t token = *ip++;
+            size_t literalCount = token >> 4;
+            if (literalCount == 15) {
+                literalCount += readLength(ip, end);
+            }
+            if (literalCount > (size_t) (end - ip) || literalCount > outputSize - op) {
+                throw std::runtime_error("Compressed block literals are out of bounds");
+            }
+            std::memcpy(output + op, ip, literalCount);
+            ip += literalCount;
+            op += literalCount;
+            if (ip == end) {
+                break;
+            }
+            if (end - ip < 2) {
+                throw std::runtime_error("Compressed block is truncated");
+            }
+            size_t offset = ip[0] | ((size_t) ip[1] << 8);
+            ip += 2;
+            size_t matchLength = token & 15;
+            if (matchLength == 15) {
+                matchLength += readLength(ip, end);
+            }
+            matchLength += MIN_MATCH;
+            if (offset == 0 || offset > op || matchLength > outputSize - op) {
+                throw std::runtime_error("Compressed block match is out of bounds");
+            }
+            // Byte by byte, matches may overlap their own output
+            size_t from = op - offset;
+            for (size_t k = 0; k < matchLength; ++k) {
+                output[op + k] = output[from + k];
+            }
+            op += matchLength;
+        }
+        if (op != outputSize) {
+            throw std::runtime_error("Compressed block has an unexpected size");
+        }
+    }
+
+    static std::array<uint32_t, 256> createCrcTable() {
+        std::array<uint32_t, 256> table{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320U ^ (c >> 1) : c >> 1;
+            }
+            table[i] = c;
+        }
+        return table;
+    }
+
+    uint32_t crc32(const uint8_t *data, size_t size) {
+        static const std::array<uint32_t, 256> table = createCrcTable();
+        uint32_t crc = 0xFFFFFFFFU;
+        for (size_t i = 0; i < size; ++i) {
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return crc ^ 0xFFFFFFFFU;
+    }
+}
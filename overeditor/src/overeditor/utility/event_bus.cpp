@@ -0,0 +1,47 @@
+#include <overeditor/utility/event_bus.h>
+
+#include <stdexcept>
+
+namespace overeditor::utility {
+
+    uint32_t EventBus::nextTypeIndex() {
+        static std::atomic<uint32_t> next(0);
+        uint32_t index = next++;
+        if (index >= EVENT_BUS_MAX_TYPES) {
+            throw std::runtime_error("Too many event types, increase EVENT_BUS_MAX_TYPES");
+        }
+        return index;
+    }
+
+    uint32_t EventBus::getThreadSlot() {
+        static std::atomic<uint32_t> next(0);
+        static thread_local uint32_t slot = next++;
+        return slot;
+    }
+
+    EventBus::EventBus() : channelMutex(), statistics() {
+        for (auto &channel : channels) {
+            channel.store(nullptr);
+        }
+    }
+
+    EventBus::~EventBus() {
+        for (auto &channel : channels) {
+            delete channel.load();
+        }
+    }
+
+    void EventBus::dispatch() {
+        statistics = EventBusStatistics();
+        for (auto &channel : channels) {
+            BaseChannel *existing = channel.load(std::memory_order_acquire);
+            if (existing != nullptr) {
+                existing->dispatch(statistics);
+            }
+        }
+    }
+
+    const EventBusStatistics &EventBus::getStatistics() const {
+        return statistics;
+    }
+}
@@ -0,0 +1,101 @@
+#include <overeditor/utility/mapped_file.h>
+
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+
+#include <windows.h>
+
+#else
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#endif
+
+namespace overeditor::utility {
+#ifdef _WIN32
+
+    MappedFile::MappedFile(const std::filesystem::path &path)
+            : data(nullptr), size(0), fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr) {
+        fileHandle = CreateFileW(
+                path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr
+        );
+        if (fileHandle == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error(std::string("Unable to open file: ") + path.string());
+        }
+        LARGE_INTEGER fileSize;
+        GetFileSizeEx(fileHandle, &fileSize);
+        size = (size_t) fileSize.QuadPart;
+        if (size == 0) {
+            return;
+        }
+        mappingHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mappingHandle == nullptr) {
+            CloseHandle(fileHandle);
+            throw std::runtime_error(std::string("Unable to map file: ") + path.string());
+        }
+        data = static_cast<const uint8_t *>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+        if (data == nullptr) {
+            CloseHandle(mappingHandle);
+            CloseHandle(fileHandle);
+            throw std::runtime_error(std::string("Unable to map file: ") + path.string());
+        }
+    }
+
+    MappedFile::~MappedFile() {
+        if (data != nullptr) {
+            UnmapViewOfFile(data);
+        }
+        if (mappingHandle != nullptr) {
+            CloseHandle(mappingHandle);
+        }
+        CloseHandle(fileHandle);
+    }
+
+#else
+
+    MappedFile::MappedFile(const std::filesystem::path &path) : data(nullptr), size(0), descriptor(-1) {
+        descriptor = open(path.c_str(), O_RDONLY);
+        if (descriptor < 0) {
+            throw std::runtime_error(std::string("Unable to open file: ") + path.string());
+        }
+        struct stat status{};
+        if (fstat(descriptor, &status) != 0) {
+            close(descriptor);
+            throw std::runtime_error(std::string("Unable to stat file: ") + path.string());
+        }
+        size = (size_t) status.st_size;
+        if (size == 0) {
+            return;
+        }
+        void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (mapping == MAP_FAILED) {
+            close(descriptor);
+            throw std::runtime_error(std::string("Unable to map file: ") + path.string());
+        }
+        madvise(mapping, size, MADV_SEQUENTIAL);
+        data = static_cast<const uint8_t *>(mapping);
+    }
+
+    MappedFile::~MappedFile() {
+        if (data != nullptr) {
+            munmap(const_cast<uint8_t *>(data), size);
+        }
+        close(descriptor);
+    }
+
+#endif
+
+    const uint8_t *MappedFile::getData() const {
+        return data;
+    }
+
+    size_t MappedFile::getSize() const {
+        return size;
+    }
+}
@@ -0,0 +1,182 @@
+#include <overeditor/utility/memory_tracker.h>
+#include <overeditor/utility/memory_utility.h>
+#include <overeditor/utility/string_utility.h>
+#include <plog/Log.h>
+
+namespace overeditor::utility {
+
+    const char *getMemoryCategoryName(MemoryCategory category) {
+        switch (category) {
+            case eMemoryGeometry:
+                return "Geometry";
+            case eMemoryTextures:
+                return "Textures";
+            case eMemoryStaging:
+                return "Staging";
+            case eMemoryAttachments:
+                return "Attachments";
+            case eMemoryFrameData:
+                return "Frame data";
+            case eMemoryEcs:
+                return "ECS";
+            case eMemoryAssetCache:
+                return "Asset cache";
+            default:
+                return "Unknown";
+        }
+    }
+
+    MemoryTracker::Counter::Counter() : current(0), peak(0), allocations(0) {}
+
+    void MemoryTracker::Counter::add(uint64_t size) {
+        uint64_t now = current.fetch_add(size) + size;
+        allocations++;
+        uint64_t previous = peak.load();
+        while (now > previous && !peak.compare_exchange_weak(previous, now)) {}
+    }
+
+    void MemoryTracker::Counter::remove(uint64_t size) {
+        current -= size;
+        allocations--;
+    }
+
+    MemoryUsage MemoryTracker::Counter::get() const {
+        MemoryUsage usage;
+        usage.current = current.load();
+        usage.peak = peak.load();
+        usage.allocations = allocations.load();
+        return usage;
+    }
+
+    MemoryTracker::MemoryTracker()
+            : mutex(), allocations(), physicalDevice(), memoryProperties(), budgetSupported(false), budgets(),
+              warned() {}
+
+    void MemoryTracker::attach(
+            const vk::PhysicalDevice &physicalDevice,
+            const vk::PhysicalDeviceMemoryProperties &memoryProperties,
+            bool budgetSupported
+    ) {
+        MemoryTracker::physicalDevice = physicalDevice;
+        MemoryTracker::memoryProperties = memoryProperties;
+        MemoryTracker::budgetSupported = budgetSupported;
+        budgets.assign(memoryProperties.memoryHeapCount, MemoryHeapBudget());
+        warned.assign(memoryProperties.memoryHeapCount, false);
+        update();
+    }
+
+    void MemoryTracker::deviceAllocated(
+            const vk::DeviceMemory &memory,
+            vk::DeviceSize size,
+            uint32_t memoryType,
+            MemoryCategory category
+    ) {
+        uint32_t heap = memoryProperties.memoryTypes[memoryType].heapIndex;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            allocations[(VkDeviceMemory) memory] = Allocation{size, heap, category};
+        }
+        device[category].add(size);
+        heaps[heap].add(size);
+    }
+
+    void MemoryTracker::deviceFreed(const vk::DeviceMemory &memory) {
+        Allocation allocation;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto found = allocations.find((VkDeviceMemory) memory);
+            if (found == allocations.end()) {
+                return;
+            }
+            allocation = found->second;
+            allocations.erase(found);
+        }
+        device[allocation.category].remove(allocation.size);
+        heaps[allocation.heap].remove(allocation.size);
+    }
+
+    void MemoryTracker::hostAllocated(MemoryCategory category, uint64_t size) {
+        host[category].add(size);
+    }
+
+    void MemoryTracker::hostFreed(MemoryCategory category, uint64_t size) {
+        host[category].remove(size);
+    }
+
+    void MemoryTracker::update() {
+        vk::PhysicalDeviceMemoryBudgetPropertiesEXT driverBudget;
+        if (budgetSupported) {
+            vk::PhysicalDeviceMemoryProperties2 properties;
+            properties.pNext = &driverBudget;
+            physicalDevice.getMemoryProperties2(&properties);
+        }
+        for (uint32_t i = 0; i < budgets.size(); ++i) {
+            MemoryHeapBudget &budget = budgets[i];
+            const vk::MemoryHeap &heap = memoryProperties.memoryHeaps[i];
+            budget.size = heap.size;
+            budget.deviceLocal = (bool) (heap.flags & vk::MemoryHeapFlagBits::eDeviceLocal);
+            budget.tracked = heaps[i].current.load();
+            budget.usage = budgetSupported ? driverBudget.heapUsage[i] : budget.tracked;
+            budget.budget = budgetSupported ? driverBudget.heapBudget[i] : heap.size;
+            if (budget.budget == 0) {
+                continue;
+            }
+            double ratio = (double) budget.usage / (double) budget.budget;
+            if (!warned[i] && ratio >= MEMORY_BUDGET_WARNING_RATIO) {
+                LOG_WARNING << "Memory heap #" << i << " is at " << (int) (ratio * 100) << "% of its budget ("
+                            << FORMAT_BYTES_AS_GIB(budget.usage) << " of " << FORMAT_BYTES_AS_GIB(budget.budget)
+                            << "), the driver may start paging it out";
+                warned[i] = true;
+            } else if (warned[i] && ratio < MEMORY_BUDGET_CLEAR_RATIO) {
+                warned[i] = false;
+            }
+        }
+    }
+
+    MemoryUsage MemoryTracker::getDeviceUsage(MemoryCategory category) const {
+        return device[category].get();
+    }
+
+    MemoryUsage MemoryTracker::getHostUsage(MemoryCategory category) const {
+        return host[category].get();
+    }
+
+    const std::vector<MemoryHeapBudget> &MemoryTracker::getHeapBudgets() const {
+        return budgets;
+    }
+
+    uint64_t MemoryTracker::getDeviceHeadroom() const {
+        uint64_t headroom = 0;
+        for (const MemoryHeapBudget &budget : budgets) {
+            auto limit = (uint64_t) ((double) budget.budget * MEMORY_BUDGET_WARNING_RATIO);
+            if (budget.deviceLocal && budget.usage < limit) {
+                headroom += limit - budget.usage;
+            }
+        }
+        return headroom;
+    }
+
+    bool MemoryTracker::isBudgetSupported() const {
+        return budgetSupported;
+    }
+
+    void MemoryTracker::log() const {
+        LOG_INFO << "Memory usage" << (budgetSupported ? "" : " (no VK_EXT_memory_budget, budgets are heap sizes)")
+                 << ":";
+        for (uint8_t c = 0; c < eMemoryCategoryCount; ++c) {
+            auto category = (MemoryCategory) c;
+            MemoryUsage deviceUsage = getDeviceUsage(category);
+            MemoryUsage hostUsage = getHostUsage(category);
+            LOG_INFO << INDENTATION(1) << getMemoryCategoryName(category) << ": device "
+                     << FORMAT_BYTES_AS_GIB(deviceUsage.current) << " (peak " << FORMAT_BYTES_AS_GIB(deviceUsage.peak)
+                     << "), host " << FORMAT_BYTES_AS_GIB(hostUsage.current) << " (peak "
+                     << FORMAT_BYTES_AS_GIB(hostUsage.peak) << ")";
+        }
+        for (size_t i = 0; i < budgets.size(); ++i) {
+            const MemoryHeapBudget &budget = budgets[i];
+            LOG_INFO << INDENTATION(1) << "Heap #" << i << (budget.deviceLocal ? " (device local)" : "") << ": "
+                     << FORMAT_BYTES_AS_GIB(budget.usage) << " used of " << FORMAT_BYTES_AS_GIB(budget.budget)
+                     << ", " << FORMAT_BYTES_AS_GIB(budget.tracked) << " tracked";
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#include <overeditor/utility/phase_profiler.h>
+#include <overeditor/utility/string_utility.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <plog/Log.h>
+
+namespace overeditor::utility {
+
+    PhaseProfiler::Scope::Scope(PhaseProfiler &profiler, std::string name)
+            : profiler(&profiler), name(std::move(name)), start(std::chrono::steady_clock::now()) {}
+
+    PhaseProfiler::Scope::~Scope() {
+        profiler->record(name, start);
+    }
+
+    PhaseProfiler::PhaseProfiler() : origin(std::chrono::steady_clock::now()), mutex(), phases() {}
+
+    double PhaseProfiler::since(std::chrono::steady_clock::time_point time) const {
+        return std::chrono::duration<double, std::milli>(time - origin).count();
+    }
+
+    void PhaseProfiler::record(const std::string &name, std::chrono::steady_clock::time_point start) {
+        auto end = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(mutex);
+        phases.push_back(PhaseTiming{
+                name, since(start), std::chrono::duration<double, std::milli>(end - start).count(),
+                std::this_thread::get_id()
+        });
+    }
+
+    double PhaseProfiler::getElapsed() const {
+        return since(std::chrono::steady_clock::now());
+    }
+
+    std::vector<PhaseTiming> PhaseProfiler::getPhases() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return phases;
+    }
+
+    void PhaseProfiler::log(const std::string &title) const {
+        std::vector<PhaseTiming> sorted = getPhases();
+        std::sort(sorted.begin(), sorted.end(), [](const PhaseTiming &a, const PhaseTiming &b) {
+            return a.start < b.start;
+        });
+        std::thread::id main = std::this_thread::get_id();
+        LOG_INFO << title << " (" << std::fixed << std::setprecision(1) << getElapsed() << " ms):";
+        for (const PhaseTiming &phase : sorted) {
+            LOG_INFO << INDENTATION(1) << phase.name << ": " << std::fixed << std::setprecision(1)
+                     << phase.milliseconds << " ms, started at " << phase.start << " ms"
+                     << (phase.thread == main ? "" : " (background)");
+        }
+    }
+}
@@ -0,0 +1,163 @@
+#include <overeditor/utility/thread_pool.h>
+
+#include <algorithm>
+
+namespace overeditor::utility {
+
+    /**
+     * The pool and queue the current thread works for, if it is a worker
+     */
+    static thread_local ThreadPool *currentPool = nullptr;
+    static thread_local size_t currentQueue = 0;
+
+    ThreadPool::ThreadPool(size_t workerCount)
+            : queues(), pending(0), nextQueue(0), stopping(false), sleepMutex(), wake(), threads() {
+        if (workerCount == 0) {
+            size_t hardware = std::thread::hardware_concurrency();
+            workerCount = std::max<size_t>(1, hardware > 1 ? hardware - 1 : 1);
+        }
+        queues.reserve(workerCount);
+        for (size_t i = 0; i < workerCount; ++i) {
+            queues.emplace_back(new WorkQueue());
+        }
+        threads.reserve(workerCount);
+        for (size_t i = 0; i < workerCount; ++i) {
+            threads.emplace_back(&ThreadPool::loop, this, i);
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+    }
+
+    void ThreadPool::submit(Task task) {
+        size_t queue = currentPool == this ? currentQueue : nextQueue++ % queues.size();
+        pending++;
+        {
+            std::lock_guard<std::mutex> lock(queues[queue]->mutex);
+            queues[queue]->tasks.push_back(std::move(task));
+        }
+        {
+            // Pairs with the predicate check of sleeping workers, so the notification can't be missed
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        wake.notify_one();
+    }
+
+    bool ThreadPool::pop(size_t queue, Task &task) {
+        std::lock_guard<std::mutex> lock(queues[queue]->mutex);
+        if (queues[queue]->tasks.empty()) {
+            return false;
+        }
+        task = std::move(queues[queue]->tasks.back());
+        queues[queue]->tasks.pop_back();
+        pending--;
+        return true;
+    }
+
+    bool ThreadPool::steal(size_t thief, Task &task) {
+        for (size_t offset = 1; offset <= queues.size(); ++offset) {
+            size_t victim = (thief + offset) % queues.size();
+            std::lock_guard<std::mutex> lock(queues[victim]->mutex);
+            if (!queues[victim]->tasks.empty()) {
+                task = std::move(queues[victim]->tasks.front());
+                queues[victim]->tasks.pop_front();
+                pending--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool ThreadPool::runPending() {
+        Task task;
+        size_t queue = currentPool == this ? currentQueue : 0;
+        if ((currentPool == this && pop(queue, task)) || steal(queue, task)) {
+            task();
+            return true;
+        }
+        return false;
+    }
+
+    void ThreadPool::loop(size_t index) {
+        currentPool = this;
+        currentQueue = index;
+        while (true) {
+            if (runPending()) {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wake.wait(lock, [this] {
+                return stopping || pending > 0;
+            });
+            if (stopping) {
+                return;
+            }
+        }
+    }
+
+    size_t ThreadPool::getWorkerCount() const {
+        return threads.size();
+    }
+
+    void ThreadPool::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)> &job) {
+        grain = std::max<size_t>(1, grain);
+        if (count <= grain) {
+            if (count > 0) {
+                job(0, count);
+            }
+            return;
+        }
+        TaskGroup group(*this);
+        for (size_t begin = 0; begin < count; begin += grain) {
+            size_t end = std::min(count, begin + grain);
+            group.run([&job, begin, end] {
+                job(begin, end);
+            });
+        }
+        group.wait();
+    }
+
+    TaskGroup::TaskGroup(ThreadPool &pool) : pool(&pool), remaining(0), errorMutex(), error() {}
+
+    TaskGroup::~TaskGroup() {
+        while (remaining > 0) {
+            if (!pool->runPending()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void TaskGroup::run(ThreadPool::Task task) {
+        remaining++;
+        pool->submit([this, task = std::move(task)] {
+            try {
+                task();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+            remaining--;
+        });
+    }
+
+    void TaskGroup::wait() {
+        while (remaining > 0) {
+            if (!pool->runPending()) {
+                std::this_thread::yield();
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
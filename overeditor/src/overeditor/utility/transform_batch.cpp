@@ -0,0 +1,253 @@
+#include <overeditor/utility/transform_batch.h>
+
+#include <cstddef>
+#include <cstring>
+
+#if defined(__AVX2__)
+#define OVEREDITOR_COMPOSE_AVX2
+#define OVEREDITOR_COMPOSE_SSE
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OVEREDITOR_COMPOSE_SSE
+#include <emmintrin.h>
+#endif
+
+namespace overeditor::utility {
+    // The kernels read the glm arrays as plain floats
+    static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "glm::vec3 must be tightly packed");
+    static_assert(sizeof(glm::quat) == 4 * sizeof(float), "glm::quat must be tightly packed");
+    static_assert(offsetof(glm::quat, x) == 0 && offsetof(glm::quat, w) == 3 * sizeof(float),
+                  "glm::quat must be stored as x, y, z, w");
+
+    static inline void composeOne(const float *p, const float *q, const float *s, float *out, MatrixLayout layout) {
+        float x2 = q[0] * 2, y2 = q[1] * 2, z2 = q[2] * 2;
+        float xx = q[0] * x2, yy = q[1] * y2, zz = q[2] * z2;
+        float xy = q[0] * y2, xz = q[0] * z2, yz = q[1] * z2;
+        float wx = q[3] * x2, wy = q[3] * y2, wz = q[3] * z2;
+        float m[16] = {
+                (1 - (yy + zz)) * s[0], (xy + wz) * s[0], (xz - wy) * s[0], 0,
+                (xy - wz) * s[1], (1 - (xx + zz)) * s[1], (yz + wx) * s[1], 0,
+                (xz + wy) * s[2], (yz - wx) * s[2], (1 - (xx + yy)) * s[2], 0,
+                p[0], p[1], p[2], 1
+        };
+        if (layout == eMatrix4x4) {
+            std::memcpy(out, m, sizeof(float) * 16);
+        } else {
+            for (int column = 0; column < 4; ++column) {
+                std::memcpy(out + column * 3, m + column * 4, sizeof(float) * 3);
+            }
+        }
+    }
+
+    void composeMatricesScalar(
+            const glm::vec3 *positions,
+            const glm::quat *rotations,
+            const glm::vec3 *scales,
+            size_t count,
+            float *destination,
+            MatrixLayout layout
+    ) {
+        auto p = reinterpret_cast<const float *>(positions);
+        auto q = reinterpret_cast<const float *>(rotations);
+        auto s = reinterpret_cast<const float *>(scales);
+        for (size_t i = 0; i < count; ++i) {
+            composeOne(p + i * 3, q + i * 4, s + i * 3, destination + i * layout, layout);
+        }
+    }
+
+#ifdef OVEREDITOR_COMPOSE_SSE
+
+    /**
+     * Loads 4 consecutive vec3 and transposes them into x, y and z lanes
+     */
+    static inline void loadVec3x4(const float *v, __m128 &x, __m128 &y, __m128 &z) {
+        // a = x0 y0 z0 x1, b = y1 z1 x2 y2, c = z2 x3 y3 z3
+        __m128 a = _mm_loadu_ps(v);
+        __m128 b = _mm_loadu_ps(v + 4);
+        __m128 c = _mm_loadu_ps(v + 8);
+        x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+        y = _mm_shuffle_ps(
+                _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)),
+                _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)),
+                _MM_SHUFFLE(2, 0, 2, 0)
+        );
+        z = _mm_shuffle_ps(
+                _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)),
+                _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)),
+                _MM_SHUFFLE(2, 0, 2, 0)
+        );
+    }
+
+    static inline void loadQuatx4(const float *q, __m128 &x, __m128 &y, __m128 &z, __m128 &w) {
+        x = _mm_loadu_ps(q);
+        y = _mm_loadu_ps(q + 4);
+        z = _mm_loadu_ps(q + 8);
+        w = _mm_loadu_ps(q + 12);
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+    }
+
+    /**
+     * Transposes the 12 column component lanes of 4 matrices back and writes the matrices
+     */
+    static inline void storeMatrices4(const __m128 *lanes, float *out, MatrixLayout layout) {
+        __m128 columns[4][4];
+        for (int column = 0; column < 4; ++column) {
+            __m128 r0 = lanes[column * 3];
+            __m128 r1 = lanes[column * 3 + 1];
+            __m128 r2 = lanes[column * 3 + 2];
+            __m128 r3 = column == 3 ? _mm_set1_ps(1) : _mm_setzero_ps();
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            columns[column][0] = r0;
+            columns[column][1] = r1;
+            columns[column][2] = r2;
+            columns[column][3] = r3;
+        }
+        for (int matrix = 0; matrix < 4; ++matrix) {
+            if (layout == eMatrix4x4) {
+                float *m = out + matrix * 16;
+                for (int column = 0; column < 4; ++column) {
+                    _mm_storeu_ps(m + column * 4, columns[column][matrix]);
+                }
+            } else {
+                // Each store spills one float into the next column, which the next store overwrites
+                float *m = out + matrix * 12;
+                _mm_storeu_ps(m, columns[0][matrix]);
+                _mm_storeu_ps(m + 3, columns[1][matrix]);
+                _mm_storeu_ps(m + 6, columns[2][matrix]);
+                __m128 last = columns[3][matrix];
+                _mm_storel_pi(reinterpret_cast<__m64 *>(m + 9), last);
+                _mm_store_ss(m + 11, _mm_movehl_ps(last, last));
+            }
+        }
+    }
+
+    static inline void composeLanes4(
+            __m128 px, __m128 py, __m128 pz,
+            __m128 qx, __m128 qy, __m128 qz, __m128 qw,
+            __m128 sx, __m128 sy, __m128 sz,
+            __m128 *lanes
+    ) {
+        __m128 one = _mm_set1_ps(1);
+        __m128 x2 = _mm_add_ps(qx, qx), y2 = _mm_add_ps(qy, qy), z2 = _mm_add_ps(qz, qz);
+        __m128 xx = _mm_mul_ps(qx, x2), yy = _mm_mul_ps(qy, y2), zz = _mm_mul_ps(qz, z2);
+        __m128 xy = _mm_mul_ps(qx, y2), xz = _mm_mul_ps(qx, z2), yz = _mm_mul_ps(qy, z2);
+        __m128 wx = _mm_mul_ps(qw, x2), wy = _mm_mul_ps(qw, y2), wz = _mm_mul_ps(qw, z2);
+        lanes[0] = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), sx);
+        lanes[1] = _mm_mul_ps(_mm_add_ps(xy, wz), sx);
+        lanes[2] = _mm_mul_ps(_mm_sub_ps(xz, wy), sx);
+        lanes[3] = _mm_mul_ps(_mm_sub_ps(xy, wz), sy);
+        lanes[4] = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), sy);
+        lanes[5] = _mm_mul_ps(_mm_add_ps(yz, wx), sy);
+        lanes[6] = _mm_mul_ps(_mm_add_ps(xz, wy), sz);
+        lanes[7] = _mm_mul_ps(_mm_sub_ps(yz, wx), sz);
+        lanes[8] = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), sz);
+        lanes[9] = px;
+        lanes[10] = py;
+        lanes[11] = pz;
+    }
+
+#endif
+
+#ifdef OVEREDITOR_COMPOSE_AVX2
+
+    static inline __m256 combine(__m128 low, __m128 high) {
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(low), high, 1);
+    }
+
+    /**
+     * Composes 8 matrices. Loads and stores go through the SSE transposes, the arithmetic is 8 wide.
+     */
+    static inline void compose8(const float *p, const float *q, const float *s, float *out, MatrixLayout layout) {
+        __m128 lo[10], hi[10];
+        loadVec3x4(p, lo[0], lo[1], lo[2]);
+        loadVec3x4(p + 12, hi[0], hi[1], hi[2]);
+        loadQuatx4(q, lo[3], lo[4], lo[5], lo[6]);
+        loadQuatx4(q + 16, hi[3], hi[4], hi[5], hi[6]);
+        loadVec3x4(s, lo[7], lo[8], lo[9]);
+        loadVec3x4(s + 12, hi[7], hi[8], hi[9]);
+        __m256 qx = combine(lo[3], hi[3]), qy = combine(lo[4], hi[4]);
+        __m256 qz = combine(lo[5], hi[5]), qw = combine(lo[6], hi[6]);
+        __m256 sx = combine(lo[7], hi[7]), sy = combine(lo[8], hi[8]), sz = combine(lo[9], hi[9]);
+        __m256 one = _mm256_set1_ps(1);
+        __m256 x2 = _mm256_add_ps(qx, qx), y2 = _mm256_add_ps(qy, qy), z2 = _mm256_add_ps(qz, qz);
+        __m256 xx = _mm256_mul_ps(qx, x2), yy = _mm256_mul_ps(qy, y2), zz = _mm256_mul_ps(qz, z2);
+        __m256 xy = _mm256_mul_ps(qx, y2), xz = _mm256_mul_ps(qx, z2), yz = _mm256_mul_ps(qy, z2);
+        __m256 wx = _mm256_mul_ps(qw, x2), wy = _mm256_mul_ps(qw, y2), wz = _mm256_mul_ps(qw, z2);
+        __m256 lanes[9] = {
+                _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), sx),
+                _mm256_mul_ps(_mm256_add_ps(xy, wz), sx),
+                _mm256_mul_ps(_mm256_sub_ps(xz, wy), sx),
+                _mm256_mul_ps(_mm256_sub_ps(xy, wz), sy),
+                _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), sy),
+                _mm256_mul_ps(_mm256_add_ps(yz, wx), sy),
+                _mm256_mul_ps(_mm256_add_ps(xz, wy), sz),
+                _mm256_mul_ps(_mm256_sub_ps(yz, wx), sz),
+                _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), sz)
+        };
+        __m128 low[12], high[12];
+        for (int i = 0; i < 9; ++i) {
+            low[i] = _mm256_castps256_ps128(lanes[i]);
+            high[i] = _mm256_extractf128_ps(lanes[i], 1);
+        }
+        for (int i = 0; i < 3; ++i) {
+            low[9 + i] = lo[i];
+            high[9 + i] = hi[i];
+        }
+        storeMatrices4(low, out, layout);
+        storeMatrices4(high, out + 4 * layout, layout);
+    }
+
+#endif
+
+    void composeMatrices(
+            const glm::vec3 *positions,
+            const glm::quat *rotations,
+            const glm::vec3 *scales,
+            size_t count,
+            float *destination,
+            MatrixLayout layout
+    ) {
+        auto p = reinterpret_cast<const float *>(positions);
+        auto q = reinterpret_cast<const float *>(rotations);
+        auto s = reinterpret_cast<const float *>(scales);
+        size_t i = 0;
+#ifdef OVEREDITOR_COMPOSE_AVX2
+        for (; i + 8 <= count; i += 8) {
+            compose8(p + i * 3, q + i * 4, s + i * 3, destination + i * layout, layout);
+        }
+#endif
+#ifdef OVEREDITOR_COMPOSE_SSE
+        for (; i + 4 <= count; i += 4) {
+            __m128 px, py, pz, qx, qy, qz, qw, sx, sy, sz;
+            loadVec3x4(p + i * 3, px, py, pz);
+            loadQuatx4(q + i * 4, qx, qy, qz, qw);
+            loadVec3x4(s + i * 3, sx, sy, sz);
+            __m128 lanes[12];
+            composeLanes4(px, py, pz, qx, qy, qz, qw, sx, sy, sz, lanes);
+            storeMatrices4(lanes, destination + i * layout, layout);
+        }
+#endif
+        // Remainder
+        for (; i < count; ++i) {
+            composeOne(p + i * 3, q + i * 4, s + i * 3, destination + i * layout, layout);
+        }
+    }
+
+    void storeMatrix(const glm::mat4 &matrix, float *destination, MatrixLayout layout) {
+        for (int column = 0; column < 4; ++column) {
+            for (int row = 0; row < layout / 4; ++row) {
+                destination[column * (layout / 4) + row] = matrix[column][row];
+            }
+        }
+    }
+
+    const char *getComposeImplementation() {
+#if defined(OVEREDITOR_COMPOSE_AVX2)
+        return "AVX2";
+#elif defined(OVEREDITOR_COMPOSE_SSE)
+        return "SSE2";
+#else
+        return "Scalar";
+#endif
+    }
+}
@@ -5,3 +5,17 @@
     vec.resize(total);\
     func(device, surface, &total,reinterpret_cast<type *> (vec.data()));\
 
+namespace overeditor::utility {
+    uint32_t findMemoryType(
+            const vk::PhysicalDeviceMemoryProperties &properties,
+            uint32_t typeBits,
+            vk::MemoryPropertyFlags flags
+    ) {
+        for (uint32_t i = 0; i < properties.memoryTypeCount; ++i) {
+            if ((typeBits & (1U << i)) && (properties.memoryTypes[i].propertyFlags & flags) == flags) {
+                return i;
+            }
+        }
+        throw std::runtime_error("Unable to find a suitable memory type");
+    }
+}